@@ -7,13 +7,37 @@
 #define EVENT_BATCH_HPP
 
 // All include files
+#include "event_batch/adaptive_segmenter.hpp"
 #include "event_batch/assert.hpp"
 #include "event_batch/batch.hpp"
+#include "event_batch/batch_index.hpp"
+#include "event_batch/batch_pool.hpp"
+#include "event_batch/batch_profile.hpp"
+#include "event_batch/checkpoint.hpp"
+#include "event_batch/decay_kernel.hpp"
+#include "event_batch/event_block.hpp"
+#include "event_batch/event_source.hpp"
+#include "event_batch/event_stream.hpp"
 #include "event_batch/event_stream_statistics.hpp"
+#include "event_batch/fixed_point.hpp"
 #include "event_batch/global_decay.hpp"
+#include "event_batch/histogram.hpp"
+#include "event_batch/index_batch.hpp"
+#include "event_batch/keyed_segmenter.hpp"
+#include "event_batch/latency_statistics.hpp"
+#include "event_batch/little_endian.hpp"
+#include "event_batch/parallel_segmentation.hpp"
+#include "event_batch/pipeline.hpp"
+#include "event_batch/polarity_segmenter.hpp"
+#include "event_batch/region_segmenter.hpp"
+#include "event_batch/seek_index.hpp"
+#include "event_batch/spsc_ring.hpp"
 #include "event_batch/stream_statistics.hpp"
+#include "event_batch/synthetic_stream.hpp"
 #include "event_batch/tictoc.hpp"
+#include "event_batch/tiled_decay.hpp"
 #include "event_batch/types.hpp"
 #include "event_batch/utils.hpp"
+#include "event_batch/work_stealing_pool.hpp"
 
 #endif  // EVENT_BATCH_HPP
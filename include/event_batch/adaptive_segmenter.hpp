@@ -0,0 +1,602 @@
+/**
+ * @file
+ * @brief Fused global decay and batch estimator implementation.
+ */
+
+#ifndef EVENT_BATCH_ADAPTIVE_SEGMENTER_HPP
+#define EVENT_BATCH_ADAPTIVE_SEGMENTER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "event_batch/batch_pool.hpp"
+#include "event_batch/checkpoint.hpp"
+#include "event_batch/decay_kernel.hpp"
+#include "event_batch/event_block.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Checks whether an event closes the current batch.
+ *
+ * @param t Timestamp of the event \f$[\text{microseconds}]\f$.
+ * @param t_first Timestamp of the first event of the batch
+ * \f$[\text{microseconds}]\f$.
+ * @param n_decay Count of the incoming number of events after the event.
+ * @param inverse_weight_thresh Inverse of the weight threshold that splits the
+ * batches.
+ *
+ * @return True if the weight of the batch drops below the threshold, false
+ * otherwise.
+ */
+inline bool
+closes_batch(const uint64_t t, const uint64_t t_first, const float n_decay,
+             const float inverse_weight_thresh)
+{
+  const float t_diff = (t > t_first) ? static_cast<float>(t - t_first) : 0;
+  return static_cast<float>(1e-6) * t_diff * n_decay + static_cast<float>(1) >
+         inverse_weight_thresh;
+}
+
+/**
+ * @brief Fused global decay and batch estimator.
+ *
+ * This class estimates the global decay and the ideal batch of a stream of
+ * events in a single step.
+ * It owns the decay state, so there is no reference between two estimators to
+ * keep valid, and the batch boundary test reads the decay straight from the
+ * state just updated.
+ * The boundary test \f$w<\epsilon\f$, with
+ * \f$w=1/(10^{-6}\Delta t\,n_\text{decay}+1)\f$ and \f$\Delta t\f$ the time
+ * elapsed since the first event of the batch, is evaluated as
+ * \f$10^{-6}\Delta t\,n_\text{decay}+1>1/\epsilon\f$, which saves a division
+ * per event.
+ * Batches are emitted and bounded in the same way as event_batch::Batch.
+ *
+ * @tparam Event Type of event.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch.
+ * @tparam Scalar Type of the decay arithmetic \sa event_batch::BasicDecay.
+ * The block overloads only use the vectorized kernel with \p float, and the
+ * boundary test runs in single precision whatever the decay arithmetic.
+ */
+template <typename Event, typename HandleBatch, typename Scalar = float>
+class AdaptiveSegmenter
+{
+ public:
+  /**
+   * @brief Constructs an instance to estimate the ideal batch of a stream of
+   * events.
+   *
+   * @param t_decay_first @copybrief t_decay_first_
+   * @param weight_thresh @copybrief weight_thresh_
+   * @param handle_batch @copybrief handle_batch_
+   * @param capacity Number of events reserved by each pooled buffer, raised to
+   * the maximum number of events of a batch if bounded.
+   * @param limits @copybrief limits_
+   */
+  AdaptiveSegmenter(const uint64_t t_decay_first, const float weight_thresh,
+                    HandleBatch&& handle_batch, const std::size_t capacity = 0,
+                    const BatchLimits& limits = BatchLimits())
+      : t_decay_first_(t_decay_first),
+        weight_thresh_(weight_thresh),
+        inverse_weight_thresh_(static_cast<float>(1) / weight_thresh),
+        limits_(limits),
+        kernel_(best_decay_kernel()),
+        pool_(std::max(capacity, limits.max_events)),
+        batch_(pool_.acquire()),
+        handle_batch_(std::forward<HandleBatch>(handle_batch))
+  {
+    reset();
+  }
+  /**
+   * @brief Deleted copy constructor.
+   */
+  AdaptiveSegmenter(const AdaptiveSegmenter&) = delete;
+  /**
+   * @brief Default move constructor.
+   */
+  AdaptiveSegmenter(AdaptiveSegmenter&&) = default;
+  /**
+   * @brief Deleted copy assignment operator.
+   */
+  AdaptiveSegmenter&
+  operator=(const AdaptiveSegmenter&) = delete;
+  /**
+   * @brief Default move assignment operator.
+   */
+  AdaptiveSegmenter&
+  operator=(AdaptiveSegmenter&&) = default;
+  /**
+   * @brief Default destructor.
+   */
+  ~AdaptiveSegmenter() = default;
+
+  /**
+   * @brief Returns the current decay.
+   *
+   * @return Current decay.
+   */
+  const BasicDecay<Scalar>&
+  decay() const
+  {
+    return decay_;
+  }
+
+  /**
+   * @brief Returns the decay after the last event of the batch passed to the
+   * handle.
+   *
+   * Unlike \ref decay, which the block overloads move to the end of a block
+   * before its batches are emitted, this decay is the one of the event that
+   * closed the batch, and is meant to be read during the handle call.
+   *
+   * @return Decay after the last event of the emitted batch.
+   */
+  const BasicDecay<Scalar>&
+  batch_decay() const
+  {
+    return batch_decay_;
+  }
+
+  /**
+   * @brief Returns a reference to the event batch.
+   *
+   * @return Event batch.
+   */
+  const StdVector<Event>&
+  batch() const
+  {
+    return batch_;
+  }
+
+  /**
+   * @brief Estimates the global decay and the ideal batch one event at a time.
+   *
+   * @param event Incoming event.
+   */
+  void
+  operator()(Event event)
+  {
+    const BasicDecay<Scalar> decay_previous = decay_;
+    decay_.update(event.t);
+    push(event, static_cast<float>(decay_.n_decay),
+         [&](const bool after) -> const BasicDecay<Scalar>& {
+           return after ? decay_ : decay_previous;
+         });
+  }
+
+  /**
+   * @brief Estimates the global decay and the ideal batch of a block of
+   * events.
+   *
+   * This method estimates the decays of the events in [\p first, \p last)
+   * with the vectorized event_batch::decay_timestamps kernel, then tests the
+   * batch boundaries in a single loop, and only calls the handle at batch
+   * boundaries.
+   *
+   * @param first Pointer to the first event of the block.
+   * @param last Pointer to one past the last event of the block.
+   */
+  void
+  operator()(const Event* first, const Event* last)
+  {
+    uint64_t t[DecayLanes::capacity];
+    DecayLanes lanes;
+    while (first != last)
+    {
+      const std::size_t size = std::min(static_cast<std::size_t>(last - first),
+                                        DecayLanes::capacity);
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        t[i] = first[i].t;
+      }
+      push_block([&](const std::size_t i) -> const Event& { return first[i]; },
+                 t, size, lanes);
+      first += size;
+    }
+  }
+
+  /**
+   * @brief Estimates the global decay and the ideal batch of a
+   * structure-of-arrays block of events.
+   *
+   * The decays and the batch boundaries are computed from the timestamp
+   * column in place, the other columns are only read to fill the batch.
+   *
+   * @param block Block of events.
+   */
+  void
+  operator()(const EventBlock& block)
+  {
+    DecayLanes lanes;
+    for (std::size_t first = 0; first < block.size();)
+    {
+      const std::size_t size =
+          std::min(block.size() - first, DecayLanes::capacity);
+      push_block([&](const std::size_t i) { return block[first + i]; },
+                 block.t.data() + first, size, lanes);
+      first += size;
+    }
+  }
+
+  /**
+   * @brief Returns the earliest time at which an incoming event would close
+   * the pending batch.
+   *
+   * A timer armed at this time bounds the latency of the pending batch
+   * during scene silence.
+   * With a maximum duration, the batch is also complete once no later event
+   * can join it.
+   * \sa event_batch::batch_closing_time.
+   *
+   * @return Closing time of the pending batch \f$[\text{microseconds}]\f$, or
+   * the largest timestamp if it is empty.
+   */
+  uint64_t
+  closing_time() const
+  {
+    if (batch_.empty())
+    {
+      return ~static_cast<uint64_t>(0);
+    }
+    const uint64_t t_first = batch_[0].t;
+    const uint64_t t_close =
+        batch_closing_time(decay_, t_first, weight_thresh_);
+    if (limits_.max_duration > 0 &&
+        t_first + limits_.max_duration < ~static_cast<uint64_t>(0))
+    {
+      return std::min(t_close, t_first + limits_.max_duration + 1);
+    }
+    return t_close;
+  }
+
+  /**
+   * @brief Closes the pending batch if an event arriving at a later time would
+   * close it.
+   *
+   * @param t_now Current stream time \f$[\text{microseconds}]\f$.
+   *
+   * @return True if a batch was passed to the handle, false otherwise.
+   */
+  bool
+  flush_until(const uint64_t t_now)
+  {
+    if (batch_.empty() || t_now < closing_time())
+    {
+      return false;
+    }
+    emit(decay_);
+    return true;
+  }
+
+  /**
+   * @brief Passes the pending batch to the handle, if any, regardless of its
+   * weight.
+   */
+  void
+  flush()
+  {
+    if (!batch_.empty())
+    {
+      emit(decay_);
+    }
+  }
+
+  /**
+   * @brief Releases a batch previously retained by the handle.
+   *
+   * The underlying buffer is recycled and the view must not be used anymore.
+   *
+   * @param batch View of the retained batch.
+   */
+  void
+  release(const Span<const Event> batch)
+  {
+    pool_.release(batch);
+  }
+
+  /**
+   * @brief Resets the context.
+   */
+  void
+  reset()
+  {
+    decay_.reset(t_decay_first_);
+    batch_decay_ = decay_;
+    batch_.clear();
+  }
+
+  /**
+   * @brief Resets the context to a decay checkpoint, so that the estimation
+   * resumes after the event the checkpoint was taken at, with an empty batch.
+   *
+   * @param decay Decay checkpoint.
+   */
+  void
+  reset(const BasicDecay<Scalar>& decay)
+  {
+    decay_ = decay;
+    batch_decay_ = decay;
+    batch_.clear();
+  }
+
+  /**
+   * @brief Serializes the decay and the pending batch.
+   *
+   * @return Checkpoint.
+   * \sa event_batch::write_checkpoint.
+   */
+  StdVector<uint8_t>
+  checkpoint() const
+  {
+    return write_checkpoint(decay_,
+                            Span<const Event>(batch_.data(), batch_.size()));
+  }
+
+  /**
+   * @brief Restores the decay and the pending batch from a checkpoint, so
+   * that the estimation resumes as if it had not stopped.
+   *
+   * @param bytes Checkpoint.
+   */
+  void
+  restore(const StdVector<uint8_t>& bytes)
+  {
+    decay_ = read_checkpoint<Scalar>(bytes, batch_);
+  }
+
+ protected:
+  /**
+   * @brief Estimates the decays of a block of timestamps with the vectorized
+   * kernel, in single precision only.
+   *
+   * @param t Pointer to the first timestamp.
+   * @param size Number of timestamps, at most
+   * event_batch::DecayLanes::capacity.
+   * @param lanes Output lanes.
+   *
+   * @return Whether the kernel estimated the block, otherwise the decay must
+   * be updated one timestamp at a time.
+   */
+  bool
+  decay_block(const uint64_t* t, const std::size_t size, DecayLanes& lanes)
+  {
+    if constexpr (std::is_same<Scalar, float>::value)
+    {
+      return decay_timestamps(decay_, t, size, lanes, kernel_);
+    }
+    else
+    {
+      static_cast<void>(t);
+      static_cast<void>(size);
+      static_cast<void>(lanes);
+      return false;
+    }
+  }
+
+  /**
+   * @brief Estimates the decays of a block of at most
+   * event_batch::DecayLanes::capacity events and adds the events to the
+   * batch.
+   *
+   * @tparam EventAt Type of the function that returns an event of the block
+   * from its index.
+   *
+   * @param event_at Function that returns an event of the block from its
+   * index.
+   * @param t Timestamps of the block.
+   * @param size Number of events.
+   * @param lanes Lanes of the decay kernel.
+   */
+  template <typename EventAt>
+  void
+  push_block(EventAt&& event_at, const uint64_t* t, const std::size_t size,
+             DecayLanes& lanes)
+  {
+    const BasicDecay<Scalar> decay_first = decay_;
+    if (decay_block(t, size, lanes))
+    {
+      // The decay after an event is only rebuilt from its lane if the event
+      // closes a batch
+      auto lane_decay = [&](const std::size_t i) {
+        BasicDecay<Scalar> decay;
+        decay.t = t[i];
+        decay.decay = static_cast<Scalar>(lanes.decay[i]);
+        decay.n_decay = static_cast<Scalar>(lanes.n_decay[i]);
+        decay.t_decay = static_cast<Scalar>(lanes.t_decay[i]);
+        decay.rate = static_cast<Scalar>(lanes.rate[i]);
+        return decay;
+      };
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        push(event_at(i), lanes.n_decay[i], [&](const bool after) {
+          return after ? lane_decay(i)
+                       : (i > 0 ? lane_decay(i - 1) : decay_first);
+        });
+      }
+    }
+    else
+    {
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        operator()(event_at(i));
+      }
+    }
+  }
+
+  /**
+   * @brief Adds an event to the current batch and closes the batch if its
+   * weight drops below the threshold or if it reaches a limit.
+   *
+   * An event that would stretch the batch past its maximum duration starts
+   * the next batch instead.
+   *
+   * @tparam DecayAt Type of the function that returns the decay after
+   * (\p true) or before (\p false) the event.
+   *
+   * @param event Incoming event.
+   * @param n_decay Count of the incoming number of events after the event.
+   * @param decay_at Function that returns the decay after or before the
+   * event, only called when a batch closes.
+   */
+  template <typename DecayAt>
+  void
+  push(const Event& event, const float n_decay, DecayAt&& decay_at)
+  {
+    if (limits_.max_duration > 0 && !batch_.empty() &&
+        event.t > batch_[0].t + limits_.max_duration)
+    {
+      emit(decay_at(false));
+    }
+
+    batch_.push_back(event);
+
+    if (closes_batch(event.t, batch_[0].t, n_decay, inverse_weight_thresh_) ||
+        batch_.size() == limits_.max_events)
+    {
+      emit(decay_at(true));
+    }
+  }
+
+  /**
+   * @brief Passes the current batch to the handle and recycles its buffer.
+   *
+   * @param decay Decay after the last event of the batch.
+   */
+  void
+  emit(const BasicDecay<Scalar>& decay)
+  {
+    batch_decay_ = decay;
+    const Span<const Event> batch(batch_.data(), batch_.size());
+    if constexpr (std::is_same<std::invoke_result_t<HandleBatch&,
+                                                    Span<const Event>>,
+                               bool>::value)
+    {
+      if (handle_batch_(batch))
+      {
+        batch_ = pool_.retain(std::move(batch_));
+        return;
+      }
+    }
+    else
+    {
+      handle_batch_(batch);
+    }
+    batch_.clear();
+  }
+
+  /**
+   * @brief Initial time rate assumption to bootstrap the rate estimator
+   * \f$[\text{microseconds}]\f$.
+   */
+  const uint64_t t_decay_first_;
+  /**
+   * @brief Weight threshold that splits the batches.
+   */
+  const float weight_thresh_;
+  /**
+   * @brief Inverse of the weight threshold.
+   */
+  const float inverse_weight_thresh_;
+  /**
+   * @brief Upper bounds on the batches, on top of the weight threshold.
+   */
+  const BatchLimits limits_;
+  /**
+   * @brief Implementation of the block kernel.
+   */
+  DecayKernel kernel_;
+
+  /**
+   * @brief Decay stucture.
+   * \sa event_batch::BasicDecay.
+   */
+  BasicDecay<Scalar> decay_;
+  /**
+   * @brief Decay after the last event of the emitted batch.
+   */
+  BasicDecay<Scalar> batch_decay_;
+
+  /**
+   * @brief Pool of recycled buffers.
+   */
+  BatchPool<Event> pool_;
+  /**
+   * @brief Event batch.
+   */
+  StdVector<Event> batch_;
+
+  /**
+   * @brief Handle to further process the estimated batch.
+   */
+  HandleBatch handle_batch_;
+};
+
+/**
+ * @brief Make function that creates an instance of
+ * event_batch::AdaptiveSegmenter.
+ *
+ * @tparam Event Type of event.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch.
+ *
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param handle_batch Handle to further process the estimated batch.
+ * @param capacity Number of events reserved by each pooled buffer.
+ * @param limits Upper bounds on the batches.
+ *
+ * @return Instance of event_batch::AdaptiveSegmenter.
+ */
+template <typename Event, typename HandleBatch>
+inline AdaptiveSegmenter<Event, HandleBatch>
+make_adaptive_segmenter(const uint64_t t_decay_first, const float weight_thresh,
+                        HandleBatch&& handle_batch,
+                        const std::size_t capacity = 0,
+                        const BatchLimits& limits = BatchLimits())
+{
+  return AdaptiveSegmenter<Event, HandleBatch>(
+      t_decay_first, weight_thresh, std::forward<HandleBatch>(handle_batch),
+      capacity, limits);
+}
+
+/**
+ * @brief Make function that creates an instance of
+ * event_batch::AdaptiveSegmenter with a given decay arithmetic.
+ *
+ * @tparam Scalar Type of the decay arithmetic, e.g. \p double or
+ * event_batch::FixedPoint.
+ * @tparam Event Type of event.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch.
+ *
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param handle_batch Handle to further process the estimated batch.
+ * @param capacity Number of events reserved by each pooled buffer.
+ * @param limits Upper bounds on the batches.
+ *
+ * @return Instance of event_batch::AdaptiveSegmenter.
+ */
+template <typename Scalar, typename Event, typename HandleBatch>
+inline AdaptiveSegmenter<Event, HandleBatch, Scalar>
+make_basic_adaptive_segmenter(const uint64_t t_decay_first,
+                              const float weight_thresh,
+                              HandleBatch&& handle_batch,
+                              const std::size_t capacity = 0,
+                              const BatchLimits& limits = BatchLimits())
+{
+  return AdaptiveSegmenter<Event, HandleBatch, Scalar>(
+      t_decay_first, weight_thresh, std::forward<HandleBatch>(handle_batch),
+      capacity, limits);
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_ADAPTIVE_SEGMENTER_HPP
@@ -6,8 +6,15 @@
 #ifndef EVENT_BATCH_BATCH_HPP
 #define EVENT_BATCH_BATCH_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
 #include <utility>
 
+#include "event_batch/batch_pool.hpp"
+#include "event_batch/checkpoint.hpp"
+#include "event_batch/event_block.hpp"
 #include "event_batch/global_decay.hpp"
 #include "event_batch/types.hpp"
 
@@ -18,12 +25,24 @@ namespace event_batch
  *
  * This class estimates the ideal batch of a stream of events from the
  * corresponding global decay.
+ * Batches are emitted as non-owning views (event_batch::Span) over pooled
+ * buffers, so that steady-state batching does not allocate memory.
+ * If the handle returns \p void (or \p false), the view is only valid during
+ * the handle call and the buffer is immediately reused.
+ * If the handle returns \p true, the buffer is retained until \ref release is
+ * called with the emitted view.
+ * Optional event_batch::BatchLimits split the batches that would otherwise
+ * grow past a number of events or a duration, and bounding the number of
+ * events reserves it in every pooled buffer, so that a batch never
+ * reallocates.
  *
  * @tparam Event Type of event.
  * @tparam HandleBatch Type of the handle to further process the estimated
  * batch.
+ * @tparam Timestamp Type of the accessor to the timestamp of an event.
  */
-template <typename Event, typename HandleBatch>
+template <typename Event, typename HandleBatch,
+          typename Timestamp = EventTimestamp>
 class Batch
 {
  public:
@@ -34,11 +53,21 @@ class Batch
    * @param weight_thresh @copybrief weight_thresh_
    * @param decay @copybrief decay_
    * @param handle_batch @copybrief handle_batch_
+   * @param capacity Number of events reserved by each pooled buffer, raised to
+   * the maximum number of events of a batch if bounded.
+   * @param limits @copybrief limits_
+   * @param timestamp @copybrief timestamp_
    */
   Batch(const float weight_thresh, const Decay& decay,
-        HandleBatch&& handle_batch)
+        HandleBatch&& handle_batch, const std::size_t capacity = 0,
+        const BatchLimits& limits = BatchLimits(),
+        Timestamp timestamp = Timestamp())
       : weight_thresh_(weight_thresh),
+        limits_(limits),
         decay_(decay),
+        timestamp_(timestamp),
+        pool_(std::max(capacity, limits.max_events)),
+        batch_(pool_.acquire()),
         handle_batch_(std::forward<HandleBatch>(handle_batch))
   {
   }
@@ -88,18 +117,129 @@ class Batch
   void
   operator()(Event event)
   {
-    batch_.push_back(event);
+    push(event, decay_.n_decay);
+  }
 
-    const float t_diff =
-        (event.t > batch_[0].t) ? static_cast<float>(event.t - batch_[0].t) : 0;
-    const float weight = static_cast<float>(1) /
-                         (static_cast<float>(1e-6) * t_diff * decay_.n_decay +
-                          static_cast<float>(1));
+  /**
+   * @brief Estimates the ideal batch of a block of events from the
+   * corresponding global decays.
+   *
+   * This method processes the events in [\p first, \p last) in a single loop,
+   * and only calls the handle at batch boundaries.
+   *
+   * @tparam DecayIt Type of the iterator over the decays, whose elements
+   * provide a \p n_decay member (e.g. event_batch::Decay).
+   *
+   * @param first Pointer to the first event of the block.
+   * @param last Pointer to one past the last event of the block.
+   * @param decays Beginning of the decays of each event of the block.
+   */
+  template <typename DecayIt>
+  void
+  operator()(const Event* first, const Event* last, DecayIt decays)
+  {
+    for (; first != last; ++first, ++decays)
+    {
+      push(*first, decays->n_decay);
+    }
+  }
 
-    if (weight < weight_thresh_)
+  /**
+   * @brief Estimates the ideal batch of a structure-of-arrays block of events
+   * from the corresponding global decays.
+   *
+   * @tparam DecayIt Type of the iterator over the decays, whose elements
+   * provide a \p n_decay member (e.g. event_batch::Decay).
+   *
+   * @param block Block of events.
+   * @param decays Beginning of the decays of each event of the block.
+   */
+  template <typename DecayIt>
+  void
+  operator()(const EventBlock& block, DecayIt decays)
+  {
+    for (std::size_t i = 0; i < block.size(); ++i, ++decays)
+    {
+      push(block[i], decays->n_decay);
+    }
+  }
+
+  /**
+   * @brief Returns the earliest time at which an incoming event would close
+   * the pending batch.
+   *
+   * The decay structure must hold the decay after the last event of the
+   * batch.
+   * A timer armed at this time bounds the latency of the pending batch
+   * during scene silence.
+   * With a maximum duration, the batch is also complete once no later event
+   * can join it.
+   * \sa event_batch::batch_closing_time.
+   *
+   * @return Closing time of the pending batch \f$[\text{microseconds}]\f$, or
+   * the largest timestamp if it is empty.
+   */
+  uint64_t
+  closing_time() const
+  {
+    if (batch_.empty())
+    {
+      return ~static_cast<uint64_t>(0);
+    }
+    const uint64_t t_first = timestamp_(batch_[0]);
+    const uint64_t t_close =
+        batch_closing_time(decay_, t_first, weight_thresh_);
+    if (limits_.max_duration > 0 &&
+        t_first + limits_.max_duration < ~static_cast<uint64_t>(0))
     {
-      handle_batch_(std::move(batch_));
+      return std::min(t_close, t_first + limits_.max_duration + 1);
     }
+    return t_close;
+  }
+
+  /**
+   * @brief Closes the pending batch if an event arriving at a later time would
+   * close it.
+   *
+   * @param t_now Current stream time \f$[\text{microseconds}]\f$.
+   *
+   * @return True if a batch was passed to the handle, false otherwise.
+   */
+  bool
+  flush_until(const uint64_t t_now)
+  {
+    if (batch_.empty() || t_now < closing_time())
+    {
+      return false;
+    }
+    emit();
+    return true;
+  }
+
+  /**
+   * @brief Passes the pending batch to the handle, if any, regardless of its
+   * weight.
+   */
+  void
+  flush()
+  {
+    if (!batch_.empty())
+    {
+      emit();
+    }
+  }
+
+  /**
+   * @brief Releases a batch previously retained by the handle.
+   *
+   * The underlying buffer is recycled and the view must not be used anymore.
+   *
+   * @param batch View of the retained batch.
+   */
+  void
+  release(const Span<const Event> batch)
+  {
+    pool_.release(batch);
   }
 
   /**
@@ -111,18 +251,118 @@ class Batch
     batch_.clear();
   }
 
+  /**
+   * @brief Serializes the decay structure and the pending batch.
+   *
+   * The same checkpoint restores both the event_batch::GlobalDecay that
+   * updates the decay structure and this estimator.
+   *
+   * @return Checkpoint.
+   * \sa event_batch::write_checkpoint.
+   */
+  StdVector<uint8_t>
+  checkpoint() const
+  {
+    return write_checkpoint(decay_,
+                            Span<const Event>(batch_.data(), batch_.size()));
+  }
+
+  /**
+   * @brief Restores the pending batch from a checkpoint.
+   *
+   * The decay structure is not owned, and is restored through the estimator
+   * that updates it.
+   *
+   * @param bytes Checkpoint.
+   */
+  void
+  restore(const StdVector<uint8_t>& bytes)
+  {
+    read_checkpoint(bytes, batch_);
+  }
+
  protected:
+  /**
+   * @brief Adds an event to the current batch and closes it if its weight
+   * drops below the threshold or if it reaches a limit.
+   *
+   * An event that would stretch the batch past its maximum duration starts
+   * the next batch instead.
+   *
+   * @param event Incoming event.
+   * @param n_decay Count of the incoming number of events after \p event.
+   */
+  void
+  push(const Event& event, const float n_decay)
+  {
+    const uint64_t t = timestamp_(event);
+    if (limits_.max_duration > 0 && !batch_.empty() &&
+        t > timestamp_(batch_[0]) + limits_.max_duration)
+    {
+      emit();
+    }
+
+    batch_.push_back(event);
+
+    const uint64_t t_first = timestamp_(batch_[0]);
+    const float t_diff = (t > t_first) ? static_cast<float>(t - t_first) : 0;
+    const float weight =
+        static_cast<float>(1) /
+        (static_cast<float>(1e-6) * t_diff * n_decay + static_cast<float>(1));
+
+    if (weight < weight_thresh_ || batch_.size() == limits_.max_events)
+    {
+      emit();
+    }
+  }
+
+  /**
+   * @brief Passes the current batch to the handle and recycles its buffer.
+   */
+  void
+  emit()
+  {
+    const Span<const Event> batch(batch_.data(), batch_.size());
+    if constexpr (std::is_same<std::invoke_result_t<HandleBatch&,
+                                                    Span<const Event>>,
+                               bool>::value)
+    {
+      if (handle_batch_(batch))
+      {
+        batch_ = pool_.retain(std::move(batch_));
+        return;
+      }
+    }
+    else
+    {
+      handle_batch_(batch);
+    }
+    batch_.clear();
+  }
+
   /**
    * @brief Weight threshold that splits the batches.
    */
   const float weight_thresh_;
+  /**
+   * @brief Upper bounds on the batches.
+   */
+  const BatchLimits limits_;
 
   /**
    * @brief Decay stucture.
    * \sa event_batch::Decay.
    */
   const Decay& decay_;
+  /**
+   * @brief Accessor to the timestamp of an event.
+   */
+  Timestamp timestamp_;
 
+  /**
+   * @brief Pool of recycled buffers.
+   */
+  BatchPool<Event> pool_;
   /**
    * @brief Event batch.
    */
@@ -145,16 +385,59 @@ class Batch
  * @param decay Decay stucture.
  * \sa event_batch::Decay.
  * @param handle_batch Handle to further process the estimated batch.
+ * @param capacity Number of events reserved by each pooled buffer.
+ * @param limits Upper bounds on the batches.
+ * @param timestamp Accessor to the timestamp of an event.
  *
- * @return Instance of event_batch::GlobalDecay.
+ * @return Instance of event_batch::Batch.
  */
-template <typename Event, typename HandleBatch>
-inline Batch<Event, HandleBatch>
+template <typename Event, typename HandleBatch,
+          typename Timestamp = EventTimestamp>
+inline Batch<Event, HandleBatch, Timestamp>
 make_batch(const float weight_thresh, const Decay& decay,
-           HandleBatch&& handle_batch)
+           HandleBatch&& handle_batch, const std::size_t capacity = 0,
+           const BatchLimits& limits = BatchLimits(),
+           Timestamp timestamp = Timestamp())
+{
+  return Batch<Event, HandleBatch, Timestamp>(
+      weight_thresh, decay, std::forward<HandleBatch>(handle_batch), capacity,
+      limits, timestamp);
+}
+
+/**
+ * @brief Estimates the global decay and the ideal batch of a block of events.
+ *
+ * This function first estimates the global decay of all the events of the
+ * block, writing them into \p decays, and then splits the block into batches,
+ * so that both loops run without per-event handle calls.
+ * The handle to pass from an event to a decay must return an
+ * event_batch::Decay.
+ *
+ * @tparam Event Type of event.
+ * @tparam EventToDecay Type of the handle to pass from an event to a decay.
+ * @tparam HandleDecay Type of the handle to further process the estimated
+ * decay.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch.
+ * @tparam Timestamp Type of the accessor to the timestamp of an event.
+ *
+ * @param global_decay Global decay estimator.
+ * @param batch Batch estimator.
+ * @param first Pointer to the first event of the block.
+ * @param last Pointer to one past the last event of the block.
+ * @param decays Caller-provided storage for the decay of each event, which must
+ * hold as many elements as the block.
+ */
+template <typename Event, typename EventToDecay, typename HandleDecay,
+          typename HandleBatch, typename Timestamp>
+inline void
+decay_and_batch(
+    GlobalDecay<Event, EventToDecay, HandleDecay, Timestamp>& global_decay,
+    Batch<Event, HandleBatch, Timestamp>& batch, const Event* first,
+    const Event* last, Decay* decays)
 {
-  return Batch<Event, HandleBatch>(weight_thresh, decay,
-                                   std::forward<HandleBatch>(handle_batch));
+  global_decay(first, last, decays);
+  batch(first, last, decays);
 }
 }  // namespace event_batch
 
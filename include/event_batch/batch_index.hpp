@@ -0,0 +1,434 @@
+/**
+ * @file
+ * @brief Binary batch index writer and reader.
+ */
+
+#ifndef EVENT_BATCH_BATCH_INDEX_HPP
+#define EVENT_BATCH_BATCH_INDEX_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "event_batch/little_endian.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Entry of a batch index.
+ */
+struct BatchRecord
+{
+  /**
+   * @brief Index of the first event of the batch.
+   */
+  uint64_t first;
+  /**
+   * @brief Index of one past the last event of the batch.
+   */
+  uint64_t last;
+  /**
+   * @brief Timestamp of the first event of the batch
+   * \f$[\text{microseconds}]\f$.
+   */
+  uint64_t t_first;
+  /**
+   * @brief Timestamp of the last event of the batch
+   * \f$[\text{microseconds}]\f$.
+   */
+  uint64_t t_last;
+  /**
+   * @brief Decay after the last event of the batch.
+   */
+  Decay decay;
+};
+
+/// \cond
+namespace batch_index
+{
+/**
+ * @brief Signature at the beginning of a batch index file.
+ */
+constexpr char signature[] = "Event Batch Index";
+/**
+ * @brief Size of the signature in bytes.
+ */
+constexpr std::size_t signature_size = sizeof(signature) - 1;
+/**
+ * @brief Size of the header (signature and version) in bytes.
+ */
+constexpr std::size_t header_size = signature_size + 3;
+/**
+ * @brief Size of an encoded event_batch::BatchRecord in bytes.
+ */
+constexpr std::size_t record_size =
+    4 * sizeof(uint64_t) + little_endian::decay_size;
+}  // namespace batch_index
+/// \endcond
+
+/**
+ * @brief Writer of a binary batch index file.
+ *
+ * The file starts with the signature "Event Batch Index" and a three-byte
+ * version, followed by one fixed-size little-endian record per batch, so that
+ * a batch can be looked up without parsing the previous ones.
+ * Records are buffered and written in large chunks.
+ * Event indices count the events passed to the batch estimator from the start
+ * of the stream, i.e. the events of the Event Stream file when no event is
+ * filtered out.
+ */
+class BatchIndexWriter
+{
+ public:
+  /**
+   * @brief Creates a batch index file and writes its header.
+   *
+   * @param filename Name of the batch index file.
+   * @param buffer_size Number of records buffered before a write.
+   */
+  explicit BatchIndexWriter(const std::string& filename,
+                            const std::size_t buffer_size = 4096)
+      : file_descriptor_(-1), next_(0)
+  {
+    file_descriptor_ =
+        ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file_descriptor_ < 0)
+    {
+      throw std::runtime_error("unwritable file '" + filename + "'");
+    }
+    buffer_.reserve(batch_index::header_size +
+                    (buffer_size > 0 ? buffer_size : 1) *
+                        batch_index::record_size);
+    buffer_.insert(buffer_.end(), batch_index::signature,
+                   batch_index::signature + batch_index::signature_size);
+    buffer_.insert(buffer_.end(), {1, 0, 0});
+  }
+  /**
+   * @brief Deleted copy constructor.
+   */
+  BatchIndexWriter(const BatchIndexWriter&) = delete;
+  /**
+   * @brief Move constructor.
+   */
+  BatchIndexWriter(BatchIndexWriter&& other)
+      : file_descriptor_(std::exchange(other.file_descriptor_, -1)),
+        next_(other.next_),
+        buffer_(std::move(other.buffer_))
+  {
+  }
+  /**
+   * @brief Deleted copy assignment operator.
+   */
+  BatchIndexWriter&
+  operator=(const BatchIndexWriter&) = delete;
+  /**
+   * @brief Deleted move assignment operator.
+   */
+  BatchIndexWriter&
+  operator=(BatchIndexWriter&&) = delete;
+  /**
+   * @brief Writes the buffered records and closes the file.
+   *
+   * Errors are ignored, call \ref close to detect them.
+   */
+  ~BatchIndexWriter()
+  {
+    try
+    {
+      close();
+    }
+    catch (...)
+    {
+    }
+  }
+
+  /**
+   * @brief Appends a record.
+   *
+   * @param record Record to append.
+   */
+  void
+  operator()(const BatchRecord& record)
+  {
+    if (buffer_.size() + batch_index::record_size > buffer_.capacity())
+    {
+      flush();
+    }
+    const std::size_t size = buffer_.size();
+    buffer_.resize(size + batch_index::record_size);
+    uint8_t* byte = buffer_.data() + size;
+    byte = little_endian::encode(byte, record.first);
+    byte = little_endian::encode(byte, record.last);
+    byte = little_endian::encode(byte, record.t_first);
+    byte = little_endian::encode(byte, record.t_last);
+    little_endian::encode(byte, record.decay);
+    next_ = record.last;
+  }
+
+  /**
+   * @brief Appends the record of the batch following the previous one.
+   *
+   * @param batch Batch of events, which directly follows the previous batch.
+   * @param decay Decay after the last event of the batch.
+   */
+  void
+  operator()(const Span<const Event> batch, const Decay& decay)
+  {
+    operator()(BatchRecord{next_, next_ + batch.size(), batch.front().t,
+                           batch.back().t, decay});
+  }
+
+  /**
+   * @brief Writes the buffered records and closes the file.
+   */
+  void
+  close()
+  {
+    if (file_descriptor_ < 0)
+    {
+      return;
+    }
+    flush();
+    const int file_descriptor = std::exchange(file_descriptor_, -1);
+    if (::close(file_descriptor) < 0)
+    {
+      throw std::runtime_error("failed to close batch index file");
+    }
+  }
+
+ protected:
+  /**
+   * @brief Writes the buffered bytes.
+   */
+  void
+  flush()
+  {
+    const uint8_t* byte = buffer_.data();
+    std::size_t size = buffer_.size();
+    while (size > 0)
+    {
+      const ssize_t written = ::write(file_descriptor_, byte, size);
+      if (written < 0)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+        throw std::runtime_error("failed to write batch index file");
+      }
+      byte += written;
+      size -= static_cast<std::size_t>(written);
+    }
+    buffer_.clear();
+  }
+
+  /**
+   * @brief File descriptor, -1 once closed.
+   */
+  int file_descriptor_;
+  /**
+   * @brief Index of the first event of the next batch.
+   */
+  uint64_t next_;
+  /**
+   * @brief Bytes not yet written.
+   */
+  StdVector<uint8_t> buffer_;
+};
+
+/**
+ * @brief Read-only memory mapping of a batch index file.
+ *
+ * Records are decoded on access, so opening an index does not depend on its
+ * number of batches.
+ */
+class MappedBatchIndex
+{
+ public:
+  /**
+   * @brief Maps a batch index file into memory.
+   *
+   * @param filename Name of the batch index file.
+   */
+  explicit MappedBatchIndex(const std::string& filename)
+      : data_(nullptr), size_(0)
+  {
+    const int file_descriptor = ::open(filename.c_str(), O_RDONLY);
+    if (file_descriptor < 0)
+    {
+      throw std::runtime_error("unreadable file '" + filename + "'");
+    }
+    struct stat status;
+    if (::fstat(file_descriptor, &status) < 0)
+    {
+      ::close(file_descriptor);
+      throw std::runtime_error("unreadable file '" + filename + "'");
+    }
+    const std::size_t file_size = static_cast<std::size_t>(status.st_size);
+    if (file_size < batch_index::header_size)
+    {
+      ::close(file_descriptor);
+      throw std::runtime_error("'" + filename + "' is not a batch index file");
+    }
+    void* data =
+        ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    ::close(file_descriptor);
+    if (data == MAP_FAILED)
+    {
+      throw std::runtime_error("failed to map file '" + filename + "'");
+    }
+    data_ = static_cast<const uint8_t*>(data);
+    size_ = file_size;
+
+    if (std::memcmp(data_, batch_index::signature,
+                    batch_index::signature_size) != 0)
+    {
+      unmap();
+      throw std::runtime_error("'" + filename + "' is not a batch index file");
+    }
+    if (data_[batch_index::signature_size] != 1)
+    {
+      unmap();
+      throw std::runtime_error("unsupported batch index version in '" +
+                               filename + "'");
+    }
+    if ((size_ - batch_index::header_size) % batch_index::record_size != 0)
+    {
+      unmap();
+      throw std::runtime_error("truncated record in '" + filename + "'");
+    }
+  }
+  /**
+   * @brief Deleted copy constructor.
+   */
+  MappedBatchIndex(const MappedBatchIndex&) = delete;
+  /**
+   * @brief Move constructor.
+   */
+  MappedBatchIndex(MappedBatchIndex&& other)
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0))
+  {
+  }
+  /**
+   * @brief Deleted copy assignment operator.
+   */
+  MappedBatchIndex&
+  operator=(const MappedBatchIndex&) = delete;
+  /**
+   * @brief Deleted move assignment operator.
+   */
+  MappedBatchIndex&
+  operator=(MappedBatchIndex&&) = delete;
+  /**
+   * @brief Unmaps the file.
+   */
+  ~MappedBatchIndex()
+  {
+    unmap();
+  }
+
+  /**
+   * @brief Returns the number of batches.
+   *
+   * @return Number of batches.
+   */
+  std::size_t
+  size() const
+  {
+    return (data_ == nullptr)
+               ? 0
+               : (size_ - batch_index::header_size) / batch_index::record_size;
+  }
+
+  /**
+   * @brief Decodes the record of a batch.
+   *
+   * @param i Index of the batch.
+   *
+   * @return Record of the batch.
+   */
+  BatchRecord
+  operator[](const std::size_t i) const
+  {
+    BatchRecord record;
+    const uint8_t* byte =
+        data_ + batch_index::header_size + i * batch_index::record_size;
+    byte = little_endian::decode(byte, record.first);
+    byte = little_endian::decode(byte, record.last);
+    byte = little_endian::decode(byte, record.t_first);
+    byte = little_endian::decode(byte, record.t_last);
+    little_endian::decode(byte, record.decay);
+    return record;
+  }
+
+  /**
+   * @brief Finds the first batch that ends at or after a timestamp.
+   *
+   * @param t Timestamp \f$[\text{microseconds}]\f$.
+   *
+   * @return Index of the batch, or the number of batches if all batches end
+   * before \p t.
+   */
+  std::size_t
+  find(const uint64_t t) const
+  {
+    std::size_t first = 0;
+    std::size_t count = size();
+    while (count > 0)
+    {
+      const std::size_t step = count / 2;
+      uint64_t t_last;
+      little_endian::decode(data_ + batch_index::header_size +
+                              (first + step) * batch_index::record_size +
+                              3 * sizeof(uint64_t),
+                          t_last);
+      if (t_last < t)
+      {
+        first += step + 1;
+        count -= step + 1;
+      }
+      else
+      {
+        count = step;
+      }
+    }
+    return first;
+  }
+
+ protected:
+  /**
+   * @brief Unmaps the file, if mapped.
+   */
+  void
+  unmap()
+  {
+    if (data_ != nullptr)
+    {
+      ::munmap(const_cast<uint8_t*>(data_), size_);
+      data_ = nullptr;
+    }
+  }
+
+  /**
+   * @brief Mapped file.
+   */
+  const uint8_t* data_;
+  /**
+   * @brief Size of the file in bytes.
+   */
+  std::size_t size_;
+};
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_BATCH_INDEX_HPP
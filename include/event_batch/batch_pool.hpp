@@ -0,0 +1,148 @@
+/**
+ * @file
+ * @brief Pool of recycled event batch buffers.
+ */
+
+#ifndef EVENT_BATCH_BATCH_POOL_HPP
+#define EVENT_BATCH_BATCH_POOL_HPP
+
+#include <cstddef>
+#include <utility>
+
+#include "event_batch/assert.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Pool of recycled event batch buffers.
+ *
+ * This class keeps released buffers alive so that their capacity is reused by
+ * the next batches.
+ * Once the pool is warmed up, acquiring a buffer does not allocate memory.
+ * Buffers handed out to a consumer are tracked as retained until released.
+ *
+ * @tparam Event Type of event.
+ */
+template <typename Event>
+class BatchPool
+{
+ public:
+  /**
+   * @brief Constructs an empty pool of buffers.
+   *
+   * @param capacity @copybrief capacity_
+   */
+  explicit BatchPool(const std::size_t capacity = 0) : capacity_(capacity) {}
+
+  /**
+   * @brief Returns the number of events reserved by newly created buffers.
+   *
+   * @return Number of events reserved by newly created buffers.
+   */
+  std::size_t
+  capacity() const
+  {
+    return capacity_;
+  }
+
+  /**
+   * @brief Returns the number of buffers available in the pool.
+   *
+   * @return Number of buffers available in the pool.
+   */
+  std::size_t
+  size() const
+  {
+    return buffers_.size();
+  }
+
+  /**
+   * @brief Acquires an empty buffer.
+   *
+   * A recycled buffer is returned if available, otherwise a new buffer with
+   * \ref capacity_ reserved events is created.
+   *
+   * @return Empty buffer.
+   */
+  StdVector<Event>
+  acquire()
+  {
+    if (buffers_.empty())
+    {
+      StdVector<Event> buffer;
+      buffer.reserve(capacity_);
+      return buffer;
+    }
+    StdVector<Event> buffer(std::move(buffers_.back()));
+    buffers_.pop_back();
+    return buffer;
+  }
+
+  /**
+   * @brief Recycles a buffer back to the pool.
+   *
+   * The buffer is cleared, but its capacity is kept.
+   *
+   * @param buffer Buffer to recycle.
+   */
+  void
+  recycle(StdVector<Event>&& buffer)
+  {
+    buffer.clear();
+    buffers_.push_back(std::move(buffer));
+  }
+
+  /**
+   * @brief Retains a buffer handed out to a consumer and acquires a new one.
+   *
+   * @param buffer Buffer to retain until \ref release is called.
+   *
+   * @return Empty buffer.
+   */
+  StdVector<Event>
+  retain(StdVector<Event>&& buffer)
+  {
+    retained_.push_back(std::move(buffer));
+    return acquire();
+  }
+
+  /**
+   * @brief Releases a retained buffer and recycles it.
+   *
+   * @param batch View of the retained buffer.
+   */
+  void
+  release(const Span<const Event> batch)
+  {
+    for (std::size_t i = 0; i < retained_.size(); ++i)
+    {
+      if (retained_[i].data() == batch.data())
+      {
+        std::swap(retained_[i], retained_.back());
+        recycle(std::move(retained_.back()));
+        retained_.pop_back();
+        return;
+      }
+    }
+    ASSERT(false, "The batch to release was not retained");
+  }
+
+ protected:
+  /**
+   * @brief Number of events reserved by newly created buffers.
+   */
+  std::size_t capacity_;
+
+  /**
+   * @brief Available buffers.
+   */
+  StdVector<StdVector<Event>> buffers_;
+  /**
+   * @brief Buffers retained by a consumer.
+   */
+  StdVector<StdVector<Event>> retained_;
+};
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_BATCH_POOL_HPP
@@ -0,0 +1,108 @@
+/**
+ * @file
+ * @brief Per-batch distributions of a batch estimation.
+ */
+
+#ifndef EVENT_BATCH_BATCH_PROFILE_HPP
+#define EVENT_BATCH_BATCH_PROFILE_HPP
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+#include "event_batch/histogram.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Distributions of the batches of an estimation.
+ *
+ * The histograms can be read from another thread while batches are recorded,
+ * e.g. to display the percentiles periodically during a live estimation.
+ */
+struct BatchProfile
+{
+  /**
+   * @brief Time between the first and last events of each batch, i.e. the
+   * time a batch takes to close on the stream clock
+   * \f$[\text{microseconds}]\f$.
+   */
+  Histogram close_time;
+  /**
+   * @brief Wall-clock time spent in the batch handle
+   * \f$[\text{nanoseconds}]\f$.
+   */
+  Histogram handle_time;
+  /**
+   * @brief Number of events of each batch.
+   */
+  Histogram size;
+  /**
+   * @brief Estimated event rate when each batch closes
+   * \f$[\text{events}/\text{seconds}]\f$.
+   */
+  Histogram rate;
+
+  /**
+   * @brief Calls a batch handle and records the batch.
+   *
+   * @tparam Event Type of event.
+   * @tparam HandleBatch Type of the handle to further process the batch.
+   *
+   * @param batch Batch of events.
+   * @param decay Decay when the batch closed.
+   * @param handle_batch Handle to further process the batch, whose runtime
+   * is recorded.
+   */
+  template <typename Event, typename HandleBatch>
+  void
+  record(const Span<const Event> batch, const Decay& decay,
+         HandleBatch&& handle_batch)
+  {
+    const auto t_begin = std::chrono::steady_clock::now();
+    handle_batch(batch);
+    const auto t_end = std::chrono::steady_clock::now();
+    handle_time.record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t_end - t_begin)
+            .count()));
+    close_time.record(batch.back().t - batch.front().t);
+    size.record(batch.size());
+    // The decay rate is in events per microsecond
+    rate.record(static_cast<uint64_t>(std::llround(1e6 * decay.rate)));
+  }
+
+  /**
+   * @brief Removes all recorded batches.
+   */
+  void
+  clear()
+  {
+    close_time.clear();
+    handle_time.clear();
+    size.clear();
+    rate.clear();
+  }
+};
+
+/**
+ * @brief Displays the percentiles of the distributions of the batches.
+ *
+ * @param batch_profile Distributions of the batches.
+ * @param stream Output stream.
+ */
+inline void
+display_batch_profile(const BatchProfile& batch_profile,
+                      std::ostream& stream = std::cout)
+{
+  display_histogram("batch close time", batch_profile.close_time, "microsec",
+                    stream);
+  display_histogram("batch handle time", batch_profile.handle_time,
+                    "nanosec", stream);
+  display_histogram("batch size", batch_profile.size, "events", stream);
+  display_histogram("batch rate", batch_profile.rate, "events/sec", stream);
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_BATCH_PROFILE_HPP
@@ -0,0 +1,209 @@
+/**
+ * @file
+ * @brief Binary checkpoint of the state of the estimators.
+ */
+
+#ifndef EVENT_BATCH_CHECKPOINT_HPP
+#define EVENT_BATCH_CHECKPOINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "event_batch/fixed_point.hpp"
+#include "event_batch/little_endian.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/// \cond
+namespace checkpoint
+{
+/**
+ * @brief Signature at the beginning of a checkpoint.
+ */
+constexpr char signature[] = "Event Batch Checkpoint";
+/**
+ * @brief Size of the signature in bytes.
+ */
+constexpr std::size_t signature_size = sizeof(signature) - 1;
+/**
+ * @brief Size of the header (signature, version, scalar tag, size of an
+ * event, decay and number of events) in bytes.
+ */
+template <typename Scalar>
+constexpr std::size_t header_size =
+    signature_size + 3 + 2 + sizeof(uint16_t) +
+    little_endian::basic_decay_size<Scalar> + sizeof(uint64_t);
+
+/**
+ * @brief Tag of the arithmetic of the decay, given by its type (0 for
+ * single-precision floats, 1 for double-precision floats and 2 for
+ * event_batch::FixedPoint) and its number of fractional bits.
+ */
+template <typename Scalar>
+struct ScalarTag;
+
+template <>
+struct ScalarTag<float>
+{
+  static constexpr uint8_t type = 0;
+  static constexpr uint8_t fraction_bits = 0;
+};
+
+template <>
+struct ScalarTag<double>
+{
+  static constexpr uint8_t type = 1;
+  static constexpr uint8_t fraction_bits = 0;
+};
+
+template <unsigned FractionBits>
+struct ScalarTag<FixedPoint<FractionBits>>
+{
+  static constexpr uint8_t type = 2;
+  static constexpr uint8_t fraction_bits = FractionBits;
+};
+
+/**
+ * @brief Returns whether the events are stored in little endian rather than
+ * in their in-memory layout.
+ */
+template <typename Event>
+constexpr bool
+is_encoded()
+{
+  return std::is_same<Event, ::event_batch::Event>::value ||
+         std::is_integral<Event>::value;
+}
+}  // namespace checkpoint
+/// \endcond
+
+/**
+ * @brief Serializes the state of an estimator.
+ *
+ * The checkpoint starts with the signature "Event Batch Checkpoint", a
+ * three-byte version, a two-byte tag of the arithmetic of the decay and the
+ * size of an event, followed by the decay and the pending events in little
+ * endian.
+ * Events other than event_batch::Event and integer timestamps are stored in
+ * their in-memory layout, so that their checkpoint must be restored on the
+ * same architecture.
+ *
+ * @tparam Scalar Type of the decay arithmetic.
+ * @tparam Event Type of event.
+ *
+ * @param decay Decay.
+ * @param batch Pending events.
+ *
+ * @return Checkpoint.
+ */
+template <typename Scalar, typename Event>
+inline StdVector<uint8_t>
+write_checkpoint(const BasicDecay<Scalar>& decay, const Span<const Event> batch)
+{
+  static_assert(std::is_trivially_copyable<Event>::value,
+                "the events of a checkpoint must be trivially copyable");
+  StdVector<uint8_t> bytes(checkpoint::header_size<Scalar> +
+                           batch.size() * sizeof(Event));
+  uint8_t* byte = bytes.data();
+  std::memcpy(byte, checkpoint::signature, checkpoint::signature_size);
+  byte += checkpoint::signature_size;
+  *(byte++) = 2;
+  *(byte++) = 0;
+  *(byte++) = 0;
+  *(byte++) = checkpoint::ScalarTag<Scalar>::type;
+  *(byte++) = checkpoint::ScalarTag<Scalar>::fraction_bits;
+  byte = little_endian::encode(byte, static_cast<uint16_t>(sizeof(Event)));
+  byte = little_endian::encode(byte, decay);
+  byte = little_endian::encode(byte, static_cast<uint64_t>(batch.size()));
+  if constexpr (checkpoint::is_encoded<Event>())
+  {
+    for (const Event& event : batch)
+    {
+      byte = little_endian::encode(byte, event);
+    }
+  }
+  else if (!batch.empty())
+  {
+    std::memcpy(byte, batch.data(), batch.size() * sizeof(Event));
+  }
+  return bytes;
+}
+
+/**
+ * @brief Deserializes the state of an estimator.
+ *
+ * @tparam Scalar Type of the decay arithmetic, which must match the one of
+ * the checkpoint.
+ * @tparam Event Type of event.
+ *
+ * @param bytes Checkpoint written by event_batch::write_checkpoint.
+ * @param batch Vector the pending events are assigned to.
+ *
+ * @return Decay.
+ */
+template <typename Scalar = float, typename Event>
+inline BasicDecay<Scalar>
+read_checkpoint(const StdVector<uint8_t>& bytes, StdVector<Event>& batch)
+{
+  static_assert(std::is_trivially_copyable<Event>::value,
+                "the events of a checkpoint must be trivially copyable");
+  if (bytes.size() < checkpoint::signature_size + 5 ||
+      std::memcmp(bytes.data(), checkpoint::signature,
+                  checkpoint::signature_size) != 0)
+  {
+    throw std::runtime_error("not a checkpoint");
+  }
+  const uint8_t* byte = bytes.data() + checkpoint::signature_size;
+  if (byte[0] != 2)
+  {
+    throw std::runtime_error("unsupported checkpoint version");
+  }
+  byte += 3;
+  if (byte[0] != checkpoint::ScalarTag<Scalar>::type ||
+      byte[1] != checkpoint::ScalarTag<Scalar>::fraction_bits)
+  {
+    throw std::runtime_error("the checkpoint holds another type of decay");
+  }
+  byte += 2;
+  if (bytes.size() < checkpoint::header_size<Scalar>)
+  {
+    throw std::runtime_error("truncated checkpoint");
+  }
+  uint16_t event_size;
+  byte = little_endian::decode(byte, event_size);
+  if (event_size != sizeof(Event))
+  {
+    throw std::runtime_error("the checkpoint holds another type of event");
+  }
+  BasicDecay<Scalar> decay;
+  byte = little_endian::decode(byte, decay);
+  uint64_t number_events;
+  byte = little_endian::decode(byte, number_events);
+  const std::size_t number_bytes =
+      bytes.size() - checkpoint::header_size<Scalar>;
+  if (number_bytes % sizeof(Event) != 0 ||
+      number_events != number_bytes / sizeof(Event))
+  {
+    throw std::runtime_error("truncated checkpoint");
+  }
+  batch.resize(static_cast<std::size_t>(number_events));
+  if constexpr (checkpoint::is_encoded<Event>())
+  {
+    for (Event& event : batch)
+    {
+      byte = little_endian::decode(byte, event);
+    }
+  }
+  else if (number_events > 0)
+  {
+    std::memcpy(batch.data(), byte, batch.size() * sizeof(Event));
+  }
+  return decay;
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_CHECKPOINT_HPP
@@ -0,0 +1,496 @@
+/**
+ * @file
+ * @brief Block kernel of the global decay recurrence.
+ */
+
+#ifndef EVENT_BATCH_DECAY_KERNEL_HPP
+#define EVENT_BATCH_DECAY_KERNEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EVENT_BATCH_DECAY_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Decays of a block of timestamps.
+ *
+ * This structure stores, for each timestamp of a block, the fields of
+ * event_batch::Decay after the timestamp, in a structure-of-arrays layout.
+ */
+struct DecayLanes
+{
+  /**
+   * @brief Maximum number of timestamps of a block.
+   */
+  static constexpr std::size_t capacity = 256;
+
+  /**
+   * @brief Event decay in \f$[0,1]\f$.
+   */
+  alignas(64) float decay[capacity];
+  /**
+   * @brief Auxiliary variable that counts the incoming number of events.
+   */
+  alignas(64) float n_decay[capacity];
+  /**
+   * @brief Auxiliary variable that estimates the event time decay
+   * \f$[\text{microseconds}]\f$.
+   */
+  alignas(64) float t_decay[capacity];
+  /**
+   * @brief Estimated event rate \f$[\text{events}/\text{microseconds}]\f$.
+   */
+  alignas(64) float rate[capacity];
+  /**
+   * @brief Time difference to the previous timestamp
+   * \f$[\text{microseconds}]\f$.
+   */
+  alignas(64) float t_diff[capacity];
+  /**
+   * @brief Time difference to the previous timestamp \f$[\text{seconds}]\f$.
+   */
+  alignas(64) float t_diff_seconds[capacity];
+};
+
+/// \cond
+/**
+ * @brief Computes the time differences of a block of timestamps.
+ *
+ * @return False if the timestamps are not sorted, in which case the lanes are
+ * left undefined.
+ */
+inline __attribute__((always_inline)) bool
+decay_kernel_t_diff_scalar(const uint64_t t_previous, const uint64_t* t,
+                           const std::size_t first, const std::size_t size,
+                           DecayLanes& lanes)
+{
+  for (std::size_t i = first; i < size; ++i)
+  {
+    const uint64_t t_last = (i > 0) ? t[i - 1] : t_previous;
+    if (t[i] < t_last)
+    {
+      return false;
+    }
+    lanes.t_diff[i] = static_cast<float>(t[i] - t_last);
+    lanes.t_diff_seconds[i] = static_cast<float>(1e-6) * lanes.t_diff[i];
+  }
+  return true;
+}
+
+/**
+ * @brief Runs the recurrence of event_batch::Decay::update on the lanes
+ * [\p first, \p size), whose time differences are already computed.
+ */
+inline void
+decay_kernel_chain(Decay& decay, const std::size_t first,
+                   const std::size_t size, DecayLanes& lanes)
+{
+  float n_decay = decay.n_decay;
+  float t_decay = decay.t_decay;
+  for (std::size_t i = first; i < size; ++i)
+  {
+    float d = static_cast<float>(1);
+    if (lanes.t_diff[i] > 0)
+    {
+      d /= lanes.t_diff_seconds[i] * n_decay + static_cast<float>(1);
+      n_decay *= d;
+      t_decay = d * t_decay + lanes.t_diff[i];
+    }
+    ++n_decay;
+    lanes.decay[i] = d;
+    lanes.n_decay[i] = n_decay;
+    lanes.t_decay[i] = t_decay;
+    lanes.rate[i] = n_decay / t_decay;
+  }
+  if (size > first)
+  {
+    decay.decay = lanes.decay[size - 1];
+    decay.n_decay = n_decay;
+    decay.t_decay = t_decay;
+    decay.rate = lanes.rate[size - 1];
+  }
+}
+
+/**
+ * @brief Portable kernel, which yields the same results as
+ * event_batch::Decay::update.
+ */
+inline bool
+decay_kernel_generic(Decay& decay, const uint64_t* t, const std::size_t size,
+                     DecayLanes& lanes)
+{
+  if (!decay_kernel_t_diff_scalar(decay.t, t, 0, size, lanes))
+  {
+    return false;
+  }
+  decay_kernel_chain(decay, 0, size, lanes);
+  return true;
+}
+
+#ifdef EVENT_BATCH_DECAY_KERNEL_X86
+/**
+ * @brief Shifts the lanes of a vector up by the given offset, filling the
+ * lowest lanes with \p fill.
+ */
+template <int Mask>
+__attribute__((target("avx2,fma"), always_inline)) inline __m256
+decay_kernel_shift(const __m256 v, const __m256i index, const __m256 fill)
+{
+  return _mm256_blend_ps(_mm256_permutevar8x32_ps(v, index), fill, Mask);
+}
+
+/**
+ * @brief One step of the inclusive scan of the Möbius transforms
+ * \f$n\mapsto((d+e)n+b)/(cn+d)\f$ of the lanes.
+ *
+ * The transforms are stored with \f$e=a-d\f$ rather than \f$a\f$, since
+ * \f$a=1+s\f$ would round away most of the bits of a small \f$s\f$.
+ */
+template <int Mask>
+__attribute__((target("avx2,fma"), always_inline)) inline void
+decay_kernel_scan_mobius(__m256& e, __m256& b, __m256& c, __m256& d,
+                         const __m256i index)
+{
+  const __m256 one = _mm256_set1_ps(1);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 e_previous = decay_kernel_shift<Mask>(e, index, zero);
+  const __m256 b_previous = decay_kernel_shift<Mask>(b, index, zero);
+  const __m256 c_previous = decay_kernel_shift<Mask>(c, index, zero);
+  const __m256 d_previous = decay_kernel_shift<Mask>(d, index, one);
+  const __m256 a = _mm256_add_ps(d, e);
+  const __m256 a_previous = _mm256_add_ps(d_previous, e_previous);
+  // e'' = d e' + e a' + b c' - c b'
+  const __m256 e_next = _mm256_fmadd_ps(
+      d, e_previous,
+      _mm256_fmadd_ps(e, a_previous,
+                      _mm256_fmsub_ps(b, c_previous,
+                                      _mm256_mul_ps(c, b_previous))));
+  const __m256 b_next =
+      _mm256_fmadd_ps(a, b_previous, _mm256_mul_ps(b, d_previous));
+  const __m256 c_next =
+      _mm256_fmadd_ps(c, a_previous, _mm256_mul_ps(d, c_previous));
+  d = _mm256_fmadd_ps(c, b_previous, _mm256_mul_ps(d, d_previous));
+  e = e_next;
+  b = b_next;
+  c = c_next;
+}
+
+/**
+ * @brief One step of the inclusive scan of the affine maps
+ * \f$t\mapsto\alpha t+\beta\f$ of the lanes.
+ */
+template <int Mask>
+__attribute__((target("avx2,fma"), always_inline)) inline void
+decay_kernel_scan_affine(__m256& alpha, __m256& beta, const __m256i index)
+{
+  const __m256 alpha_previous =
+      decay_kernel_shift<Mask>(alpha, index, _mm256_set1_ps(1));
+  const __m256 beta_previous =
+      decay_kernel_shift<Mask>(beta, index, _mm256_setzero_ps());
+  beta = _mm256_fmadd_ps(alpha, beta_previous, beta);
+  alpha = _mm256_mul_ps(alpha, alpha_previous);
+}
+
+/**
+ * @brief Runs the recurrence on groups of 8 lanes, whose time differences are
+ * already computed.
+ *
+ * With \f$s=10^{-6}\Delta t\f$, an update of the count is the Möbius transform
+ * \f$n\mapsto((1+s)n+1)/(sn+1)\f$, and an update of the time decay is the
+ * affine map \f$t\mapsto t/(sn+1)+\Delta t\f$.
+ * Both compose, so the transforms of a group are combined with a parallel
+ * scan that does not depend on the state, and the only serial chain left
+ * between two groups is one transform of the count and of the time decay.
+ * The rounding differs from event_batch::Decay::update, see
+ * event_batch::decay_timestamps for the resulting error.
+ * The composed transforms grow with the product of \f$1+s\f$ over the group,
+ * which overflows when several consecutive gaps are huge (about a day), so a
+ * group with a non-finite result is recomputed with the serial chain.
+ *
+ * @return Number of lanes processed.
+ */
+__attribute__((target("avx2,fma"))) inline std::size_t
+decay_kernel_scan(Decay& decay, const std::size_t size, DecayLanes& lanes)
+{
+  const __m256 one = _mm256_set1_ps(1);
+  const __m256i shift_1 = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+  const __m256i shift_2 = _mm256_setr_epi32(0, 0, 0, 1, 2, 3, 4, 5);
+  const __m256i shift_4 = _mm256_setr_epi32(0, 0, 0, 0, 0, 1, 2, 3);
+  const __m256i last = _mm256_set1_epi32(7);
+  __m256 n_decay = _mm256_set1_ps(decay.n_decay);
+  __m256 t_decay = _mm256_set1_ps(decay.t_decay);
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+  {
+    const __m256 t_diff = _mm256_load_ps(lanes.t_diff + i);
+    const __m256 t_diff_seconds = _mm256_load_ps(lanes.t_diff_seconds + i);
+
+    __m256 e = t_diff_seconds;
+    __m256 b = one;
+    __m256 c = t_diff_seconds;
+    __m256 d = one;
+    decay_kernel_scan_mobius<0x01>(e, b, c, d, shift_1);
+    decay_kernel_scan_mobius<0x03>(e, b, c, d, shift_2);
+    decay_kernel_scan_mobius<0x0f>(e, b, c, d, shift_4);
+    const __m256 n_decay_next = _mm256_div_ps(
+        _mm256_fmadd_ps(e, n_decay, _mm256_fmadd_ps(d, n_decay, b)),
+        _mm256_fmadd_ps(c, n_decay, d));
+
+    const __m256 n_decay_previous =
+        decay_kernel_shift<0x01>(n_decay_next, shift_1, n_decay);
+    const __m256 decay_next = _mm256_div_ps(
+        one, _mm256_fmadd_ps(t_diff_seconds, n_decay_previous, one));
+    __m256 alpha = decay_next;
+    __m256 beta = t_diff;
+    decay_kernel_scan_affine<0x01>(alpha, beta, shift_1);
+    decay_kernel_scan_affine<0x03>(alpha, beta, shift_2);
+    decay_kernel_scan_affine<0x0f>(alpha, beta, shift_4);
+    const __m256 t_decay_next = _mm256_fmadd_ps(alpha, t_decay, beta);
+
+    // x - x is 0 for finite values and NaN otherwise
+    const __m256 finite = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_sub_ps(n_decay_next, n_decay_next),
+                      _mm256_setzero_ps(), _CMP_EQ_OQ),
+        _mm256_cmp_ps(_mm256_sub_ps(t_decay_next, t_decay_next),
+                      _mm256_setzero_ps(), _CMP_EQ_OQ));
+    if (_mm256_movemask_ps(finite) != 0xff)
+    {
+      Decay decay_group = decay;
+      decay_group.n_decay = _mm256_cvtss_f32(n_decay);
+      decay_group.t_decay = _mm256_cvtss_f32(t_decay);
+      decay_kernel_chain(decay_group, i, i + 8, lanes);
+      n_decay = _mm256_set1_ps(decay_group.n_decay);
+      t_decay = _mm256_set1_ps(decay_group.t_decay);
+      continue;
+    }
+
+    _mm256_store_ps(lanes.decay + i, decay_next);
+    _mm256_store_ps(lanes.n_decay + i, n_decay_next);
+    _mm256_store_ps(lanes.t_decay + i, t_decay_next);
+    _mm256_store_ps(lanes.rate + i, _mm256_div_ps(n_decay_next, t_decay_next));
+
+    n_decay = _mm256_permutevar8x32_ps(n_decay_next, last);
+    t_decay = _mm256_permutevar8x32_ps(t_decay_next, last);
+  }
+  if (i > 0)
+  {
+    decay.decay = lanes.decay[i - 1];
+    decay.n_decay = lanes.n_decay[i - 1];
+    decay.t_decay = lanes.t_decay[i - 1];
+    decay.rate = lanes.rate[i - 1];
+  }
+  return i;
+}
+
+/**
+ * @brief AVX2 kernel.
+ *
+ * AVX2 cannot convert 64-bit integers to floats, so time differences are
+ * converted from their low 32 bits, which is exact as long as they are below
+ * \f$2^{31}\f$; larger differences fall back to scalar code.
+ */
+__attribute__((target("avx2,fma"))) inline bool
+decay_kernel_avx2(Decay& decay, const uint64_t* t, const std::size_t size,
+                  DecayLanes& lanes)
+{
+  const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i limit =
+      _mm256_set1_epi64x(INT64_MIN + (int64_t(1) << 31) - 1);
+  const __m256i low = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  const __m128 to_seconds = _mm_set1_ps(static_cast<float>(1e-6));
+  std::size_t i = 0;
+  if (size > 0 && !decay_kernel_t_diff_scalar(decay.t, t, 0, 1, lanes))
+  {
+    return false;
+  }
+  for (i = 1; i + 4 <= size; i += 4)
+  {
+    const __m256i t_current =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t + i));
+    const __m256i t_last =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t + i - 1));
+    // Unsigned comparisons through the sign bit
+    const __m256i t_current_signed = _mm256_xor_si256(t_current, sign);
+    const __m256i t_last_signed = _mm256_xor_si256(t_last, sign);
+    const __m256i t_diff = _mm256_sub_epi64(t_current, t_last);
+    const __m256i t_diff_signed = _mm256_xor_si256(t_diff, sign);
+    const __m256i invalid = _mm256_or_si256(
+        _mm256_cmpgt_epi64(t_last_signed, t_current_signed),
+        _mm256_cmpgt_epi64(t_diff_signed, limit));
+    if (!_mm256_testz_si256(invalid, invalid))
+    {
+      if (!decay_kernel_t_diff_scalar(decay.t, t, i, i + 4, lanes))
+      {
+        return false;
+      }
+      continue;
+    }
+    const __m128i t_diff_low =
+        _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(t_diff, low));
+    const __m128 t_diff_float = _mm_cvtepi32_ps(t_diff_low);
+    _mm_storeu_ps(lanes.t_diff + i, t_diff_float);
+    _mm_storeu_ps(lanes.t_diff_seconds + i,
+                  _mm_mul_ps(to_seconds, t_diff_float));
+  }
+  if (!decay_kernel_t_diff_scalar(decay.t, t, i, size, lanes))
+  {
+    return false;
+  }
+
+  decay_kernel_chain(decay, decay_kernel_scan(decay, size, lanes), size,
+                     lanes);
+  return true;
+}
+
+/**
+ * @brief AVX-512 kernel.
+ */
+__attribute__((target("avx512f,avx512dq,avx512vl,avx2,fma"))) inline bool
+decay_kernel_avx512(Decay& decay, const uint64_t* t, const std::size_t size,
+                    DecayLanes& lanes)
+{
+  const __m256 to_seconds = _mm256_set1_ps(static_cast<float>(1e-6));
+  std::size_t i = 0;
+  if (size > 0 && !decay_kernel_t_diff_scalar(decay.t, t, 0, 1, lanes))
+  {
+    return false;
+  }
+  for (i = 1; i + 8 <= size; i += 8)
+  {
+    const __m512i t_current = _mm512_loadu_si512(t + i);
+    const __m512i t_last = _mm512_loadu_si512(t + i - 1);
+    if (_mm512_cmplt_epu64_mask(t_current, t_last) != 0)
+    {
+      return false;
+    }
+    const __m256 t_diff_float =
+        _mm512_cvtepu64_ps(_mm512_sub_epi64(t_current, t_last));
+    _mm256_storeu_ps(lanes.t_diff + i, t_diff_float);
+    _mm256_storeu_ps(lanes.t_diff_seconds + i,
+                     _mm256_mul_ps(to_seconds, t_diff_float));
+  }
+  if (!decay_kernel_t_diff_scalar(decay.t, t, i, size, lanes))
+  {
+    return false;
+  }
+
+  decay_kernel_chain(decay, decay_kernel_scan(decay, size, lanes), size,
+                     lanes);
+  return true;
+}
+#endif
+/// \endcond
+
+/**
+ * @brief Available implementations of the decay kernel.
+ */
+enum class DecayKernel
+{
+  /**
+   * @brief Portable implementation.
+   */
+  generic,
+  /**
+   * @brief AVX2 and FMA implementation.
+   */
+  avx2,
+  /**
+   * @brief AVX-512 implementation.
+   */
+  avx512
+};
+
+/**
+ * @brief Returns the best implementation of the decay kernel supported by the
+ * running CPU.
+ *
+ * The implementation is selected at runtime, so binaries built without
+ * \p -march=native still use the vector units of the machine.
+ *
+ * @return Best supported implementation.
+ */
+inline DecayKernel
+best_decay_kernel()
+{
+#ifdef EVENT_BATCH_DECAY_KERNEL_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+      __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("fma"))
+  {
+    return DecayKernel::avx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+  {
+    return DecayKernel::avx2;
+  }
+#endif
+  return DecayKernel::generic;
+}
+
+/**
+ * @brief Estimates the global decay of a block of sorted timestamps.
+ *
+ * This function vectorizes the recurrence of event_batch::Decay::update: the
+ * time differences are computed across the block, and the updates of groups
+ * of 8 timestamps are combined with a parallel scan, so that the serial chain
+ * is one update per group instead of one per timestamp.
+ * The generic implementation yields the same results as calling
+ * event_batch::Decay::update on each timestamp.
+ * The vector implementations round differently, and since a single-precision
+ * recurrence accumulates its rounding over the events the decay remembers
+ * (about a thousand at one event per microsecond), both drift from the exact
+ * decay by a few \f$10^{-5}\f$ relative at high rates; the vector results
+ * stay within \f$10^{-4}\f$ relative of event_batch::Decay::update.
+ * If the timestamps are not sorted, nothing is computed and the caller must
+ * fall back to event_batch::Decay::update.
+ *
+ * @param decay Decay to update.
+ * @param t Pointer to the first timestamp \f$[\text{microseconds}]\f$.
+ * @param size Number of timestamps, at most event_batch::DecayLanes::capacity.
+ * @param lanes Decay after each timestamp.
+ * @param kernel Implementation of the kernel.
+ *
+ * @return True if the timestamps are sorted and the decay was updated, false
+ * otherwise.
+ */
+inline bool
+decay_timestamps(Decay& decay, const uint64_t* t, const std::size_t size,
+                 DecayLanes& lanes,
+                 const DecayKernel kernel = best_decay_kernel())
+{
+  Decay decay_block = decay;
+  bool sorted = false;
+  switch (kernel)
+  {
+#ifdef EVENT_BATCH_DECAY_KERNEL_X86
+    case DecayKernel::avx512:
+      sorted = decay_kernel_avx512(decay_block, t, size, lanes);
+      break;
+    case DecayKernel::avx2:
+      sorted = decay_kernel_avx2(decay_block, t, size, lanes);
+      break;
+#endif
+    default:
+      sorted = decay_kernel_generic(decay_block, t, size, lanes);
+      break;
+  }
+  if (sorted)
+  {
+    if (size > 0 && t[size - 1] > decay_block.t)
+    {
+      decay_block.t = t[size - 1];
+    }
+    decay = decay_block;
+  }
+  return sorted;
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_DECAY_KERNEL_HPP
@@ -0,0 +1,215 @@
+/**
+ * @file
+ * @brief Structure-of-arrays block of events.
+ */
+
+#ifndef EVENT_BATCH_EVENT_BLOCK_HPP
+#define EVENT_BATCH_EVENT_BLOCK_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "event_batch/types.hpp"
+#include "sepia.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Block of events stored as one aligned array per field.
+ *
+ * event_batch::Event is packed in 14 bytes, so a pass that only reads the
+ * timestamps loads the coordinates and polarities as well, through unaligned
+ * accesses.
+ * This structure stores each field in its own cache-aligned column, so that
+ * such a pass reads the 8 bytes of the timestamp column only, and can use
+ * aligned vector loads.
+ */
+struct EventBlock
+{
+  /**
+   * @brief Timestamps of the events.
+   */
+  AlignedVector<uint64_t> t;
+  /**
+   * @brief Horizontal coordinates of the events.
+   */
+  AlignedVector<uint16_t> x;
+  /**
+   * @brief Vertical coordinates of the events.
+   */
+  AlignedVector<uint16_t> y;
+  /**
+   * @brief Polarities of the events.
+   */
+  AlignedVector<uint16_t> p;
+
+  /**
+   * @brief Returns the number of events.
+   *
+   * @return Number of events.
+   */
+  std::size_t
+  size() const
+  {
+    return t.size();
+  }
+
+  /**
+   * @brief Checks whether the block is empty.
+   *
+   * @return True if the block has no events, false otherwise.
+   */
+  bool
+  empty() const
+  {
+    return t.empty();
+  }
+
+  /**
+   * @brief Reserves storage for \p size events in each column.
+   *
+   * @param size Number of events.
+   */
+  void
+  reserve(const std::size_t size)
+  {
+    t.reserve(size);
+    x.reserve(size);
+    y.reserve(size);
+    p.reserve(size);
+  }
+
+  /**
+   * @brief Removes all events, keeping the storage.
+   */
+  void
+  clear()
+  {
+    t.clear();
+    x.clear();
+    y.clear();
+    p.clear();
+  }
+
+  /**
+   * @brief Appends an event.
+   *
+   * @param event Event to append.
+   */
+  void
+  push_back(const Event& event)
+  {
+    // Packed fields cannot bind to references
+    t.push_back(static_cast<uint64_t>(event.t));
+    x.push_back(static_cast<uint16_t>(event.x));
+    y.push_back(static_cast<uint16_t>(event.y));
+    p.push_back(static_cast<uint16_t>(event.p));
+  }
+
+  /**
+   * @brief Gathers the event at position \p i.
+   *
+   * @param i Position of the event.
+   *
+   * @return Event at position \p i.
+   */
+  Event
+  operator[](const std::size_t i) const
+  {
+    return {t[i], x[i], y[i], p[i]};
+  }
+};
+
+/**
+ * @brief Returns the polarity of an event.
+ *
+ * @param event Event.
+ *
+ * @return Polarity of the event.
+ */
+inline uint16_t
+event_polarity(const Event& event)
+{
+  return event.p;
+}
+
+/**
+ * @brief Returns the polarity of a sepia DVS event.
+ *
+ * @param event Event.
+ *
+ * @return Polarity of the event, 1 if the luminance increases and 0
+ * otherwise.
+ */
+inline uint16_t
+event_polarity(const sepia::dvs_event& event)
+{
+  return static_cast<uint16_t>(event.is_increase ? 1 : 0);
+}
+
+/**
+ * @brief Appends a range of events to a block.
+ *
+ * @tparam InputEvent Type of event, either event_batch::Event or
+ * sepia::dvs_event.
+ *
+ * @param first Pointer to the first event.
+ * @param last Pointer to one past the last event.
+ * @param block Block to append to.
+ */
+template <typename InputEvent>
+inline void
+append_events(const InputEvent* first, const InputEvent* last,
+              EventBlock& block)
+{
+  block.reserve(block.size() + static_cast<std::size_t>(last - first));
+  for (; first != last; ++first)
+  {
+    block.t.push_back(static_cast<uint64_t>(first->t));
+    block.x.push_back(static_cast<uint16_t>(first->x));
+    block.y.push_back(static_cast<uint16_t>(first->y));
+    block.p.push_back(event_polarity(*first));
+  }
+}
+
+/**
+ * @brief Make function that creates an event_batch::EventBlock from a range
+ * of events.
+ *
+ * @tparam InputEvent Type of event, either event_batch::Event or
+ * sepia::dvs_event.
+ *
+ * @param first Pointer to the first event.
+ * @param last Pointer to one past the last event.
+ *
+ * @return Block of events.
+ */
+template <typename InputEvent>
+inline EventBlock
+make_event_block(const InputEvent* first, const InputEvent* last)
+{
+  EventBlock block;
+  append_events(first, last, block);
+  return block;
+}
+
+/**
+ * @brief Gathers the events of a block into packed events.
+ *
+ * @param block Block of events.
+ *
+ * @return Packed events.
+ */
+inline StdVector<Event>
+to_events(const EventBlock& block)
+{
+  StdVector<Event> events(block.size());
+  for (std::size_t i = 0; i < block.size(); ++i)
+  {
+    events[i] = block[i];
+  }
+  return events;
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_EVENT_BLOCK_HPP
@@ -0,0 +1,545 @@
+/**
+ * @file
+ * @brief Streaming sources of events and latency-tracked batch estimation.
+ */
+
+#ifndef EVENT_BATCH_EVENT_SOURCE_HPP
+#define EVENT_BATCH_EVENT_SOURCE_HPP
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/batch_profile.hpp"
+#include "event_batch/event_stream.hpp"
+#include "event_batch/latency_statistics.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Source of events read from a UNIX stream socket.
+ *
+ * The peer sends events as a raw sequence of packed event_batch::Event
+ * records, and closes the connection at the end of the stream.
+ * Records split across reads are reassembled.
+ * With a read timeout, a read returns without events when the peer stays
+ * silent, so that the pending batch of an idle stream can be closed.
+ */
+class SocketEventSource
+{
+ public:
+  /**
+   * @brief Connects to a UNIX stream socket.
+   *
+   * @param path Path of the socket.
+   * @param timeout @copybrief timeout_
+   */
+  explicit SocketEventSource(
+      const std::string& path,
+      const std::chrono::milliseconds timeout = std::chrono::milliseconds(0))
+      : socket_(-1), timeout_(timeout), size_(0), end_of_stream_(false)
+  {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+      throw std::runtime_error("socket path '" + path + "' is too long");
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    socket_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket_ < 0 ||
+        ::connect(socket_, reinterpret_cast<const sockaddr*>(&address),
+                  sizeof(address)) < 0)
+    {
+      close();
+      throw std::runtime_error("failed to connect to socket '" + path + "'");
+    }
+  }
+  /**
+   * @brief Deleted copy constructor.
+   */
+  SocketEventSource(const SocketEventSource&) = delete;
+  /**
+   * @brief Move constructor.
+   */
+  SocketEventSource(SocketEventSource&& other)
+      : socket_(std::exchange(other.socket_, -1)),
+        timeout_(other.timeout_),
+        size_(other.size_),
+        end_of_stream_(other.end_of_stream_)
+  {
+    std::memcpy(bytes_, other.bytes_, size_);
+  }
+  /**
+   * @brief Deleted copy assignment operator.
+   */
+  SocketEventSource&
+  operator=(const SocketEventSource&) = delete;
+  /**
+   * @brief Deleted move assignment operator.
+   */
+  SocketEventSource&
+  operator=(SocketEventSource&&) = delete;
+  /**
+   * @brief Closes the socket.
+   */
+  ~SocketEventSource()
+  {
+    close();
+  }
+
+  /**
+   * @brief Returns whether the peer closed the connection.
+   *
+   * @return True at the end of the stream, false otherwise.
+   */
+  bool
+  end_of_stream() const
+  {
+    return end_of_stream_;
+  }
+
+  /**
+   * @brief Waits for events and reads those available.
+   *
+   * @param events Pointer to the output events.
+   * @param size Maximum number of events to read, at least 1.
+   *
+   * @return Number of events read, 0 at the end of the stream or when the
+   * read times out.
+   */
+  std::size_t
+  read(Event* events, const std::size_t size)
+  {
+    uint8_t* const bytes = reinterpret_cast<uint8_t*>(events);
+    std::memcpy(bytes, bytes_, size_);
+    std::size_t number_bytes = size_;
+    while (number_bytes < sizeof(Event))
+    {
+      if (timeout_.count() > 0)
+      {
+        pollfd descriptor{socket_, POLLIN, 0};
+        const int ready =
+            ::poll(&descriptor, 1, static_cast<int>(timeout_.count()));
+        if (ready < 0)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          throw std::runtime_error("failed to poll socket");
+        }
+        if (ready == 0)
+        {
+          // Keeps the bytes of an incomplete record for the next read
+          size_ = number_bytes;
+          std::memcpy(bytes_, bytes, size_);
+          return 0;
+        }
+      }
+      const ssize_t received = ::recv(socket_, bytes + number_bytes,
+                                      size * sizeof(Event) - number_bytes, 0);
+      if (received < 0)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+        throw std::runtime_error("failed to read from socket");
+      }
+      if (received == 0)
+      {
+        // A truncated trailing record is dropped
+        size_ = 0;
+        end_of_stream_ = true;
+        return 0;
+      }
+      number_bytes += static_cast<std::size_t>(received);
+    }
+    size_ = number_bytes % sizeof(Event);
+    std::memcpy(bytes_, bytes + number_bytes - size_, size_);
+    return number_bytes / sizeof(Event);
+  }
+
+ protected:
+  /**
+   * @brief Closes the socket if open.
+   */
+  void
+  close()
+  {
+    if (socket_ >= 0)
+    {
+      ::close(socket_);
+      socket_ = -1;
+    }
+  }
+
+  /**
+   * @brief File descriptor of the socket.
+   */
+  int socket_;
+  /**
+   * @brief Longest wait of a read for events, 0 to wait indefinitely.
+   */
+  std::chrono::milliseconds timeout_;
+  /**
+   * @brief Bytes of an incomplete record.
+   */
+  uint8_t bytes_[sizeof(Event)];
+  /**
+   * @brief Number of bytes of the incomplete record.
+   */
+  std::size_t size_;
+  /**
+   * @brief Whether the peer closed the connection.
+   */
+  bool end_of_stream_;
+};
+
+/**
+ * @brief Source of events replayed from an Event Stream file at the recorded
+ * speed.
+ *
+ * This class stands in for a live camera: each event is released when the
+ * time elapsed since the first read matches its timestamp relative to the
+ * first event, divided by the speed.
+ * With a read timeout, a read returns without events when the next event is
+ * not due in time, as a silent camera would.
+ */
+class ReplayEventSource
+{
+ public:
+  /**
+   * @brief Opens an Event Stream file for replay.
+   *
+   * @param filename Name of the event stream file.
+   * @param speed @copybrief speed_
+   * @param timeout @copybrief timeout_
+   */
+  explicit ReplayEventSource(
+      const std::string& filename, const double speed = 1,
+      const std::chrono::milliseconds timeout = std::chrono::milliseconds(0))
+      : event_stream_(filename),
+        decoder_(event_stream_.header().width, event_stream_.header().height),
+        byte_(event_stream_.begin()),
+        speed_(speed),
+        timeout_(timeout),
+        end_of_stream_(false),
+        started_(false),
+        t_first_(0),
+        next_(0)
+  {
+  }
+  /**
+   * @brief Deleted copy constructor.
+   */
+  ReplayEventSource(const ReplayEventSource&) = delete;
+  /**
+   * @brief Deleted move constructor, the current byte points into the
+   * mapping.
+   */
+  ReplayEventSource(ReplayEventSource&&) = delete;
+  /**
+   * @brief Deleted copy assignment operator.
+   */
+  ReplayEventSource&
+  operator=(const ReplayEventSource&) = delete;
+  /**
+   * @brief Deleted move assignment operator.
+   */
+  ReplayEventSource&
+  operator=(ReplayEventSource&&) = delete;
+  /**
+   * @brief Default destructor.
+   */
+  ~ReplayEventSource() = default;
+
+  /**
+   * @brief Returns the header of the event stream.
+   *
+   * @return Header of the event stream.
+   */
+  const sepia::header&
+  header() const
+  {
+    return event_stream_.header();
+  }
+
+  /**
+   * @brief Returns whether all the events were released.
+   *
+   * @return True at the end of the stream, false otherwise.
+   */
+  bool
+  end_of_stream() const
+  {
+    return end_of_stream_;
+  }
+
+  /**
+   * @brief Waits until the next event is due and reads the events due.
+   *
+   * @param events Pointer to the output events.
+   * @param size Maximum number of events to read, at least 1.
+   *
+   * @return Number of events read, 0 at the end of the stream or when the
+   * read times out.
+   */
+  std::size_t
+  read(Event* events, const std::size_t size)
+  {
+    while (pending_.empty())
+    {
+      pending_.resize(size);
+      const uint8_t* const byte_first = byte_;
+      Event* const last = decoder_(byte_, event_stream_.end(), pending_.data(),
+                                   pending_.data() + pending_.size());
+      pending_.resize(static_cast<std::size_t>(last - pending_.data()));
+      next_ = 0;
+      if (byte_ == byte_first)
+      {
+        pending_.clear();
+        end_of_stream_ = true;
+        return 0;
+      }
+    }
+    if (!started_)
+    {
+      started_ = true;
+      t_start_ = Clock::now();
+      t_first_ = pending_[next_].t;
+    }
+
+    const Clock::time_point t_release = release_time(pending_[next_].t);
+    if (timeout_.count() > 0)
+    {
+      const Clock::time_point t_timeout = Clock::now() + timeout_;
+      if (t_release > t_timeout)
+      {
+        std::this_thread::sleep_until(t_timeout);
+        return 0;
+      }
+    }
+    std::this_thread::sleep_until(t_release);
+    const Clock::time_point now = Clock::now();
+    std::size_t number_events = 0;
+    while (next_ < pending_.size() && number_events < size &&
+           release_time(pending_[next_].t) <= now)
+    {
+      events[number_events] = pending_[next_];
+      ++number_events;
+      ++next_;
+    }
+    if (next_ == pending_.size())
+    {
+      pending_.clear();
+    }
+    return number_events;
+  }
+
+ protected:
+  /**
+   * @brief Alias for the clock.
+   */
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * @brief Returns the time at which an event is released.
+   *
+   * @param t Timestamp of the event \f$[\text{microseconds}]\f$.
+   *
+   * @return Release time.
+   */
+  Clock::time_point
+  release_time(const uint64_t t) const
+  {
+    if (speed_ <= 0)
+    {
+      return t_start_;
+    }
+    return t_start_ + std::chrono::duration_cast<Clock::duration>(
+                          std::chrono::duration<double, std::micro>(
+                              static_cast<double>(t - t_first_) / speed_));
+  }
+
+  /**
+   * @brief Mapped event stream.
+   */
+  MappedEventStream event_stream_;
+  /**
+   * @brief Decoder of the event stream.
+   */
+  DvsDecoder decoder_;
+  /**
+   * @brief Next byte to decode.
+   */
+  const uint8_t* byte_;
+  /**
+   * @brief Replay speed, 1 for the recorded speed and 0 or less for as fast
+   * as possible.
+   */
+  double speed_;
+  /**
+   * @brief Longest wait of a read for events, 0 to wait indefinitely.
+   */
+  std::chrono::milliseconds timeout_;
+  /**
+   * @brief Whether all the events were released.
+   */
+  bool end_of_stream_;
+
+  /**
+   * @brief Whether the replay started.
+   */
+  bool started_;
+  /**
+   * @brief Time of the first read.
+   */
+  Clock::time_point t_start_;
+  /**
+   * @brief Timestamp of the first event \f$[\text{microseconds}]\f$.
+   */
+  uint64_t t_first_;
+  /**
+   * @brief Decoded events not yet released.
+   */
+  StdVector<Event> pending_;
+  /**
+   * @brief Position of the next event to release.
+   */
+  std::size_t next_;
+};
+
+/**
+ * @brief Estimates the ideal batches of a streaming source of events, measures
+ * their latency and records their distributions.
+ *
+ * The latency of a batch is measured from the arrival of its last event,
+ * i.e. the return of the read that delivered it, to the completion of the
+ * batch handle.
+ * After each read, the pending batch is closed once an event arriving at
+ * the current stream time would close it (event_batch::batch_closing_time).
+ * During silences, the stream time is extrapolated from the last event with
+ * the wall clock, so that the reads of the source must time out to bound the
+ * latency of the pending batch.
+ * The pending batch is passed to the handle at the end of the stream, with
+ * its latency measured from the end of the stream.
+ *
+ * @tparam Source Type of the source, with a \p read(Event*, std::size_t)
+ * method that waits for events and returns the number of events read, or 0
+ * at the end of the stream or when it times out, and an \p end_of_stream()
+ * method that tells both apart (e.g. event_batch::SocketEventSource or
+ * event_batch::ReplayEventSource).
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch, called with a event_batch::Span<const Event>.
+ *
+ * @param source Source of events.
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param handle_batch Handle to further process the estimated batch.
+ * @param latency_statistics Latency statistics the latency of each batch is
+ * added to.
+ * @param batch_profile Distributions each batch is recorded in, which can be
+ * displayed from another thread during the estimation.
+ * @param block_size Maximum number of events per read.
+ * @param limits Upper bounds on the batches.
+ */
+template <typename Source, typename HandleBatch>
+inline void
+stream_batches(Source& source, const uint64_t t_decay_first,
+               const float weight_thresh, HandleBatch&& handle_batch,
+               LatencyStatistics& latency_statistics,
+               BatchProfile& batch_profile,
+               const std::size_t block_size = 4096,
+               const BatchLimits& limits = BatchLimits())
+{
+  typedef std::chrono::steady_clock Clock;
+
+  Clock::time_point t_arrival;
+  const Decay* decay = nullptr;
+  auto handle_and_measure = [&](Span<const Event> batch) {
+    batch_profile.record(batch, *decay, handle_batch);
+    latency_statistics.add(
+        std::chrono::duration<double, std::micro>(Clock::now() - t_arrival)
+            .count());
+  };
+  auto segmenter = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh, handle_and_measure, 0, limits);
+  decay = &segmenter.batch_decay();
+
+  StdVector<Event> events(block_size);
+  uint64_t t_last = 0;
+  for (;;)
+  {
+    const std::size_t size = source.read(events.data(), events.size());
+    if (size == 0)
+    {
+      if (source.end_of_stream())
+      {
+        t_arrival = Clock::now();
+        break;
+      }
+      // The latency of a batch closed by the silence includes the silence
+      const auto t_silence = std::chrono::duration_cast<
+          std::chrono::microseconds>(Clock::now() - t_arrival);
+      segmenter.flush_until(t_last +
+                            static_cast<uint64_t>(t_silence.count()));
+      continue;
+    }
+    t_arrival = Clock::now();
+    t_last = events[size - 1].t;
+    segmenter(events.data(), events.data() + size);
+    segmenter.flush_until(t_last);
+  }
+  segmenter.flush();
+}
+
+/**
+ * @brief Estimates the ideal batches of a streaming source of events and
+ * measures their latency.
+ *
+ * @tparam Source Type of the source \sa event_batch::stream_batches.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch, called with a event_batch::Span<const Event>.
+ *
+ * @param source Source of events.
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param handle_batch Handle to further process the estimated batch.
+ * @param latency_statistics Latency statistics the latency of each batch is
+ * added to.
+ * @param block_size Maximum number of events per read.
+ * @param limits Upper bounds on the batches.
+ */
+template <typename Source, typename HandleBatch>
+inline void
+stream_batches(Source& source, const uint64_t t_decay_first,
+               const float weight_thresh, HandleBatch&& handle_batch,
+               LatencyStatistics& latency_statistics,
+               const std::size_t block_size = 4096,
+               const BatchLimits& limits = BatchLimits())
+{
+  BatchProfile batch_profile;
+  stream_batches(source, t_decay_first, weight_thresh,
+                 std::forward<HandleBatch>(handle_batch), latency_statistics,
+                 batch_profile, block_size, limits);
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_EVENT_SOURCE_HPP
@@ -0,0 +1,618 @@
+/**
+ * @file
+ * @brief Memory-mapped Event Stream reader.
+ */
+
+#ifndef EVENT_BATCH_EVENT_STREAM_HPP
+#define EVENT_BATCH_EVENT_STREAM_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "event_batch/event_block.hpp"
+#include "event_batch/types.hpp"
+#include "sepia.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Read-only memory mapping of an Event Stream file.
+ *
+ * This class maps a whole <a
+ * href="https://github.com/neuromorphic-paris/event_stream">Event Stream</a>
+ * file into memory and parses its header.
+ * The kernel is advised that the file is read sequentially and, when
+ * supported, that it may be backed by huge pages.
+ */
+class MappedEventStream
+{
+ public:
+  /**
+   * @brief Maps an Event Stream file into memory.
+   *
+   * @param filename Name of the event stream file.
+   * It should have \p .es extension.
+   */
+  explicit MappedEventStream(const std::string& filename)
+      : data_(nullptr), size_(0), offset_(0)
+  {
+    const int file_descriptor = ::open(filename.c_str(), O_RDONLY);
+    if (file_descriptor < 0)
+    {
+      throw std::runtime_error("unreadable file '" + filename + "'");
+    }
+    struct stat status;
+    if (::fstat(file_descriptor, &status) < 0)
+    {
+      ::close(file_descriptor);
+      throw std::runtime_error("unreadable file '" + filename + "'");
+    }
+    size_ = static_cast<std::size_t>(status.st_size);
+    if (size_ > 0)
+    {
+      void* data =
+          ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+      if (data == MAP_FAILED)
+      {
+        ::close(file_descriptor);
+        throw std::runtime_error("failed to map file '" + filename + "'");
+      }
+      data_ = static_cast<const uint8_t*>(data);
+      ::madvise(data, size_, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+      ::madvise(data, size_, MADV_HUGEPAGE);
+#endif
+    }
+    ::close(file_descriptor);
+
+    try
+    {
+      read_header(filename);
+    }
+    catch (...)
+    {
+      unmap();
+      throw;
+    }
+  }
+  /**
+   * @brief Deleted copy constructor.
+   */
+  MappedEventStream(const MappedEventStream&) = delete;
+  /**
+   * @brief Move constructor.
+   */
+  MappedEventStream(MappedEventStream&& other)
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        offset_(other.offset_),
+        header_(other.header_)
+  {
+  }
+  /**
+   * @brief Deleted copy assignment operator.
+   */
+  MappedEventStream&
+  operator=(const MappedEventStream&) = delete;
+  /**
+   * @brief Deleted move assignment operator.
+   */
+  MappedEventStream&
+  operator=(MappedEventStream&&) = delete;
+  /**
+   * @brief Unmaps the file.
+   */
+  ~MappedEventStream()
+  {
+    unmap();
+  }
+
+  /**
+   * @brief Returns the header of the event stream.
+   *
+   * @return Header of the event stream.
+   */
+  const sepia::header&
+  header() const
+  {
+    return header_;
+  }
+
+  /**
+   * @brief Returns the size of the file in bytes.
+   *
+   * @return Size of the file in bytes.
+   */
+  std::size_t
+  size() const
+  {
+    return size_;
+  }
+
+  /**
+   * @brief Returns the offset of the first event byte.
+   *
+   * @return Offset of the first event byte.
+   */
+  std::size_t
+  offset() const
+  {
+    return offset_;
+  }
+
+  /**
+   * @brief Returns a pointer to the first event byte.
+   *
+   * @return Pointer to the first event byte.
+   */
+  const uint8_t*
+  begin() const
+  {
+    return data_ + offset_;
+  }
+
+  /**
+   * @brief Returns a pointer to one past the last event byte.
+   *
+   * @return Pointer to one past the last event byte.
+   */
+  const uint8_t*
+  end() const
+  {
+    return data_ + size_;
+  }
+
+ protected:
+  /**
+   * @brief Unmaps the file, if mapped.
+   */
+  void
+  unmap()
+  {
+    if (data_ != nullptr)
+    {
+      ::munmap(const_cast<uint8_t*>(data_), size_);
+      data_ = nullptr;
+    }
+  }
+
+  /**
+   * @brief Parses the header of the event stream.
+   *
+   * @param filename Name of the event stream file.
+   */
+  void
+  read_header(const std::string& filename)
+  {
+    constexpr char signature[] = "Event Stream";
+    constexpr std::size_t signature_size = sizeof(signature) - 1;
+    if (size_ < signature_size + 4 ||
+        std::memcmp(data_, signature, signature_size) != 0)
+    {
+      throw std::runtime_error("'" + filename +
+                               "' is not an Event Stream file");
+    }
+    const uint8_t* byte = data_ + signature_size;
+    header_.version = {byte[0], byte[1], byte[2]};
+    header_.event_stream_type = static_cast<sepia::type>(byte[3]);
+    offset_ = signature_size + 4;
+    if (header_.version[0] != 2)
+    {
+      throw std::runtime_error("unsupported Event Stream version in '" +
+                               filename + "'");
+    }
+    if (header_.event_stream_type != sepia::type::dvs)
+    {
+      throw std::runtime_error("'" + filename +
+                               "' is not a DVS Event Stream file");
+    }
+    if (size_ < offset_ + 4)
+    {
+      throw std::runtime_error("truncated header in '" + filename + "'");
+    }
+    byte = data_ + offset_;
+    header_.width = static_cast<uint16_t>(byte[0] | (byte[1] << 8));
+    header_.height = static_cast<uint16_t>(byte[2] | (byte[3] << 8));
+    offset_ += 4;
+  }
+
+  /**
+   * @brief Mapped file.
+   */
+  const uint8_t* data_;
+  /**
+   * @brief Size of the file in bytes.
+   */
+  std::size_t size_;
+  /**
+   * @brief Offset of the first event byte.
+   */
+  std::size_t offset_;
+  /**
+   * @brief Header of the event stream.
+   */
+  sepia::header header_;
+};
+
+/**
+ * @brief Decoder of DVS Event Stream bytes.
+ *
+ * This class decodes the bytes of a DVS Event Stream into events.
+ * It keeps the current timestamp, so that consecutive byte ranges can be
+ * decoded with successive calls.
+ */
+class DvsDecoder
+{
+ public:
+  /**
+   * @brief Constructs a decoder.
+   *
+   * @param width @copybrief width_
+   * @param height @copybrief height_
+   * @param t @copybrief t_
+   */
+  DvsDecoder(const uint16_t width, const uint16_t height, const uint64_t t = 0)
+      : width_(width), height_(height), t_(t)
+  {
+  }
+
+  /**
+   * @brief Returns the timestamp of the last decoded event
+   * \f$[\text{microseconds}]\f$.
+   *
+   * @return Timestamp of the last decoded event \f$[\text{microseconds}]\f$.
+   */
+  uint64_t
+  t() const
+  {
+    return t_;
+  }
+
+  /**
+   * @brief Decodes events until either the bytes or the output are exhausted.
+   *
+   * Decoding stops at event boundaries, so \p byte can be passed to the next
+   * call.
+   * Trailing bytes that do not form a complete event are left undecoded.
+   *
+   * @param byte Pointer to the first byte to decode, advanced past the
+   * decoded bytes.
+   * @param byte_last Pointer to one past the last byte to decode.
+   * @param first Pointer to the first output event.
+   * @param last Pointer to one past the last output event.
+   *
+   * @return Pointer to one past the last decoded event.
+   */
+  Event*
+  operator()(const uint8_t*& byte, const uint8_t* byte_last, Event* first,
+             Event* last)
+  {
+    decode(byte, byte_last, static_cast<std::size_t>(last - first),
+           [&](const uint64_t t, const uint16_t x, const uint16_t y,
+               const uint16_t p) { *(first++) = {t, x, y, p}; });
+    return first;
+  }
+
+  /**
+   * @brief Decodes at most \p size events and appends them to a block.
+   *
+   * Decoding stops at event boundaries, so \p byte can be passed to the next
+   * call.
+   * Trailing bytes that do not form a complete event are left undecoded.
+   *
+   * @param byte Pointer to the first byte to decode, advanced past the
+   * decoded bytes.
+   * @param byte_last Pointer to one past the last byte to decode.
+   * @param block Block to append the events to.
+   * @param size Maximum number of events to decode.
+   *
+   * @return Number of decoded events.
+   */
+  std::size_t
+  operator()(const uint8_t*& byte, const uint8_t* byte_last, EventBlock& block,
+             const std::size_t size)
+  {
+    // Writing through pointers avoids the capacity checks of push_back
+    const std::size_t block_size = block.size();
+    block.t.resize(block_size + size);
+    block.x.resize(block_size + size);
+    block.y.resize(block_size + size);
+    block.p.resize(block_size + size);
+    uint64_t* t_out = block.t.data() + block_size;
+    uint16_t* x_out = block.x.data() + block_size;
+    uint16_t* y_out = block.y.data() + block_size;
+    uint16_t* p_out = block.p.data() + block_size;
+    const std::size_t number_events = decode(
+        byte, byte_last, size,
+        [&](const uint64_t t, const uint16_t x, const uint16_t y,
+            const uint16_t p) {
+          *(t_out++) = t;
+          *(x_out++) = x;
+          *(y_out++) = y;
+          *(p_out++) = p;
+        });
+    block.t.resize(block_size + number_events);
+    block.x.resize(block_size + number_events);
+    block.y.resize(block_size + number_events);
+    block.p.resize(block_size + number_events);
+    return number_events;
+  }
+
+ protected:
+  /**
+   * @brief Decodes at most \p size events and passes their fields to
+   * \p emit.
+   *
+   * @return Number of decoded events.
+   */
+  template <typename Emit>
+  std::size_t
+  decode(const uint8_t*& byte, const uint8_t* byte_last,
+         const std::size_t size, Emit&& emit)
+  {
+    const uint8_t* b = byte;
+    uint64_t t = t_;
+    std::size_t i = 0;
+    for (; b != byte_last && i != size;)
+    {
+      if (*b == 0b11111111)
+      {
+        t += 127;
+        ++b;
+      }
+      else if (*b == 0b11111110)
+      {
+        ++b;
+      }
+      else
+      {
+        if (byte_last - b < 5)
+        {
+          break;
+        }
+        t += static_cast<uint64_t>(*b >> 1);
+        const uint16_t x = static_cast<uint16_t>(b[1] | (b[2] << 8));
+        const uint16_t y = static_cast<uint16_t>(b[3] | (b[4] << 8));
+        if (x >= width_ || y >= height_)
+        {
+          throw std::runtime_error("event coordinates overflow");
+        }
+        emit(t, x, y, static_cast<uint16_t>(*b & 1));
+        b += 5;
+        ++i;
+      }
+    }
+    byte = b;
+    t_ = t;
+    return i;
+  }
+
+  /**
+   * @brief Width of the sensor.
+   */
+  uint16_t width_;
+  /**
+   * @brief Height of the sensor.
+   */
+  uint16_t height_;
+  /**
+   * @brief Current timestamp \f$[\text{microseconds}]\f$.
+   */
+  uint64_t t_;
+};
+
+/**
+ * @brief Encodes events as DVS Event Stream bytes, without header.
+ *
+ * This function is the inverse of event_batch::DvsDecoder, e.g. to feed the
+ * decoder with synthetic events.
+ *
+ * @param first Pointer to the first event, sorted by timestamp.
+ * @param last Pointer to one past the last event.
+ * @param bytes Bytes to append the encoded events to.
+ * @param t Timestamp of the previous event \f$[\text{microseconds}]\f$.
+ *
+ * @return Timestamp of the last encoded event \f$[\text{microseconds}]\f$.
+ */
+inline uint64_t
+encode_dvs_events(const Event* first, const Event* last,
+                  StdVector<uint8_t>& bytes, uint64_t t = 0)
+{
+  for (; first != last; ++first)
+  {
+    if (first->t < t)
+    {
+      throw std::runtime_error("the events must be sorted by timestamp");
+    }
+    uint64_t t_diff = first->t - t;
+    for (; t_diff >= 127; t_diff -= 127)
+    {
+      bytes.push_back(0b11111111);
+    }
+    bytes.push_back(static_cast<uint8_t>((t_diff << 1) | (first->p & 1)));
+    bytes.push_back(static_cast<uint8_t>(first->x & 0xff));
+    bytes.push_back(static_cast<uint8_t>(first->x >> 8));
+    bytes.push_back(static_cast<uint8_t>(first->y & 0xff));
+    bytes.push_back(static_cast<uint8_t>(first->y >> 8));
+    t = first->t;
+  }
+  return t;
+}
+
+/**
+ * @brief Writer of a DVS Event Stream file.
+ *
+ * The header is written on construction, and each range of events is encoded
+ * with event_batch::encode_dvs_events and written at once, so that streams of
+ * any length can be written in constant memory.
+ */
+class EventStreamWriter
+{
+ public:
+  /**
+   * @brief Creates a DVS Event Stream file and writes its header.
+   *
+   * @param filename Name of the event stream file.
+   * @param width Width of the sensor.
+   * @param height Height of the sensor.
+   */
+  EventStreamWriter(const std::string& filename, const uint16_t width,
+                    const uint16_t height)
+      : file_(filename, std::ios::binary), t_(0)
+  {
+    if (!file_)
+    {
+      throw std::runtime_error("unwritable file '" + filename + "'");
+    }
+    constexpr char signature[] = "Event Stream";
+    file_.write(signature, sizeof(signature) - 1);
+    const uint8_t header[] = {2,
+                              0,
+                              0,
+                              static_cast<uint8_t>(sepia::type::dvs),
+                              static_cast<uint8_t>(width & 0xff),
+                              static_cast<uint8_t>(width >> 8),
+                              static_cast<uint8_t>(height & 0xff),
+                              static_cast<uint8_t>(height >> 8)};
+    file_.write(reinterpret_cast<const char*>(header), sizeof(header));
+  }
+
+  /**
+   * @brief Appends events.
+   *
+   * @param first Pointer to the first event, sorted by timestamp and not
+   * before the previous events.
+   * @param last Pointer to one past the last event.
+   */
+  void
+  operator()(const Event* first, const Event* last)
+  {
+    bytes_.clear();
+    t_ = encode_dvs_events(first, last, bytes_, t_);
+    file_.write(reinterpret_cast<const char*>(bytes_.data()),
+                static_cast<std::streamsize>(bytes_.size()));
+    if (!file_)
+    {
+      throw std::runtime_error("failed to write Event Stream file");
+    }
+  }
+
+  /**
+   * @brief Writes the buffered bytes and closes the file.
+   */
+  void
+  close()
+  {
+    file_.close();
+    if (!file_)
+    {
+      throw std::runtime_error("failed to close Event Stream file");
+    }
+  }
+
+ protected:
+  /**
+   * @brief Event stream file.
+   */
+  std::ofstream file_;
+  /**
+   * @brief Encoded bytes of the current range of events.
+   */
+  StdVector<uint8_t> bytes_;
+  /**
+   * @brief Timestamp of the previous event \f$[\text{microseconds}]\f$.
+   */
+  uint64_t t_;
+};
+
+/**
+ * @brief Decodes a mapped DVS Event Stream in blocks of events.
+ *
+ * The events are decoded into a single reusable block, which is passed to the
+ * handle as the range [\p first, \p last).
+ *
+ * @tparam HandleBlock Type of the handle to further process each block of
+ * events.
+ *
+ * @param event_stream Mapped event stream.
+ * @param handle_block Handle to further process each block of events.
+ * @param block_size Maximum number of events per block.
+ */
+template <typename HandleBlock>
+inline void
+for_each_block(const MappedEventStream& event_stream,
+               HandleBlock&& handle_block, const std::size_t block_size = 4096)
+{
+  DvsDecoder decoder(event_stream.header().width,
+                     event_stream.header().height);
+  StdVector<Event> block(block_size);
+  const uint8_t* byte = event_stream.begin();
+  while (byte != event_stream.end())
+  {
+    const uint8_t* const byte_first = byte;
+    Event* const last = decoder(byte, event_stream.end(), block.data(),
+                                block.data() + block.size());
+    if (last != block.data())
+    {
+      handle_block(static_cast<const Event*>(block.data()),
+                   static_cast<const Event*>(last));
+    }
+    if (byte == byte_first)
+    {
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Decodes a mapped DVS Event Stream in structure-of-arrays blocks of
+ * events.
+ *
+ * The events are decoded into a single reusable event_batch::EventBlock, which
+ * is passed to the handle.
+ *
+ * @tparam HandleBlock Type of the handle to further process each block of
+ * events.
+ *
+ * @param event_stream Mapped event stream.
+ * @param handle_block Handle to further process each block of events.
+ * @param block_size Maximum number of events per block.
+ */
+template <typename HandleBlock>
+inline void
+for_each_event_block(const MappedEventStream& event_stream,
+                     HandleBlock&& handle_block,
+                     const std::size_t block_size = 4096)
+{
+  DvsDecoder decoder(event_stream.header().width,
+                     event_stream.header().height);
+  EventBlock block;
+  block.reserve(block_size);
+  const uint8_t* byte = event_stream.begin();
+  while (byte != event_stream.end())
+  {
+    const uint8_t* const byte_first = byte;
+    block.clear();
+    if (decoder(byte, event_stream.end(), block, block_size) > 0)
+    {
+      handle_block(static_cast<const EventBlock&>(block));
+    }
+    if (byte == byte_first)
+    {
+      break;
+    }
+  }
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_EVENT_STREAM_HPP
@@ -10,6 +10,7 @@
 #include <utility>
 
 #include "event_batch/assert.hpp"
+#include "event_batch/event_block.hpp"
 
 namespace event_batch
 {
@@ -96,6 +97,75 @@ class EventStreamStatistics
                                             event.t - t_first_));
   }
 
+  /**
+   * @brief Computes the basic statistics of a block of events.
+   *
+   * This method updates the number of events and duration of an event stream
+   * with the events in [\p first, \p last), and calls the handle only once
+   * with the last event of the block.
+   * Its cost does not depend on the block size, so it can ride along another
+   * block-based pipeline.
+   *
+   * @param first Pointer to the first event of the block.
+   * @param last Pointer to one past the last event of the block.
+   */
+  void
+  operator()(const Event* first, const Event* last)
+  {
+    if (first == last)
+    {
+      return;
+    }
+
+    if (first_)
+    {
+      t_first_ = first->t;
+      first_ = false;
+    }
+    number_events_ += static_cast<uint64_t>(last - first);
+
+    const Event& event = *(last - 1);
+    ASSERT(event.t >= t_first_, "The current timestamp "
+                                    << event.t << "must be >= first timestamp "
+                                    << t_first_);
+
+    handle_statistics_(event_to_statistics_(event, t_first_, number_events_,
+                                            event.t - t_first_));
+  }
+
+  /**
+   * @brief Computes the basic statistics of a structure-of-arrays block of
+   * events.
+   *
+   * This method behaves as the overload on a range of events, and only reads
+   * the first and last events of the block.
+   *
+   * @param block Block of events.
+   */
+  void
+  operator()(const EventBlock& block)
+  {
+    if (block.empty())
+    {
+      return;
+    }
+
+    if (first_)
+    {
+      t_first_ = block.t[0];
+      first_ = false;
+    }
+    number_events_ += block.size();
+
+    const Event event = block[block.size() - 1];
+    ASSERT(event.t >= t_first_, "The current timestamp "
+                                    << event.t << "must be >= first timestamp "
+                                    << t_first_);
+
+    handle_statistics_(event_to_statistics_(event, t_first_, number_events_,
+                                            event.t - t_first_));
+  }
+
  protected:
   /**
    * @brief First timestamp \f$[\text{microseconds}]\f$.
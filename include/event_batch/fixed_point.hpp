@@ -0,0 +1,356 @@
+/**
+ * @file
+ * @brief Fixed-point arithmetic for the decay estimation.
+ */
+
+#ifndef EVENT_BATCH_FIXED_POINT_HPP
+#define EVENT_BATCH_FIXED_POINT_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace event_batch
+{
+/**
+ * @brief Signed fixed-point number stored in a 64-bit integer.
+ *
+ * Products and quotients go through 128-bit intermediates, so that they are
+ * exact up to the last fractional bit and, unlike single-precision floats,
+ * the resolution does not degrade as the values grow.
+ * With the default 24 fractional bits, the resolution is
+ * \f$6\cdot10^{-8}\f$ and the range \f$\pm5.5\cdot10^{11}\f$, i.e. about six
+ * days in microseconds.
+ *
+ * @tparam FractionBits Number of fractional bits.
+ */
+template <unsigned FractionBits = 24>
+class FixedPoint
+{
+  static_assert(FractionBits > 0 && FractionBits < 62,
+                "the number of fractional bits must be in [1, 61]");
+
+ public:
+  /**
+   * @brief Number of fractional bits.
+   */
+  static constexpr unsigned fraction_bits = FractionBits;
+
+  /**
+   * @brief Constructs zero.
+   */
+  constexpr FixedPoint() : raw_(0) {}
+
+  /**
+   * @brief Converts an integer or a floating-point number.
+   *
+   * Numbers out of range saturate to the largest or smallest fixed-point
+   * number, and NaN converts to zero.
+   *
+   * @tparam T Type of the number.
+   *
+   * @param value Number.
+   */
+  template <typename T, typename = typename std::enable_if<
+                            std::is_arithmetic<T>::value>::type>
+  explicit FixedPoint(const T value) : raw_(convert(value)) {}
+
+  /**
+   * @brief Creates a number from its underlying integer.
+   *
+   * @param raw Underlying integer, i.e. the number times
+   * \f$2^\text{FractionBits}\f$.
+   *
+   * @return Fixed-point number.
+   */
+  static constexpr FixedPoint
+  from_raw(const int64_t raw)
+  {
+    FixedPoint number;
+    number.raw_ = raw;
+    return number;
+  }
+
+  /**
+   * @brief Returns the underlying integer.
+   *
+   * @return Number times \f$2^\text{FractionBits}\f$.
+   */
+  constexpr int64_t
+  raw() const
+  {
+    return raw_;
+  }
+
+  /**
+   * @brief Converts to a floating-point number.
+   *
+   * @tparam T Floating-point type.
+   *
+   * @return Nearest floating-point number.
+   */
+  template <typename T, typename = typename std::enable_if<
+                            std::is_floating_point<T>::value>::type>
+  constexpr explicit operator T() const
+  {
+    return static_cast<T>(raw_) / static_cast<T>(one_raw);
+  }
+
+  /**
+   * @brief Adds a number.
+   *
+   * @param other Number.
+   *
+   * @return Reference to this number.
+   */
+  FixedPoint&
+  operator+=(const FixedPoint other)
+  {
+    raw_ += other.raw_;
+    return *this;
+  }
+
+  /**
+   * @brief Subtracts a number.
+   *
+   * @param other Number.
+   *
+   * @return Reference to this number.
+   */
+  FixedPoint&
+  operator-=(const FixedPoint other)
+  {
+    raw_ -= other.raw_;
+    return *this;
+  }
+
+  /**
+   * @brief Multiplies by a number, rounding to the nearest.
+   *
+   * @param other Number.
+   *
+   * @return Reference to this number.
+   */
+  FixedPoint&
+  operator*=(const FixedPoint other)
+  {
+    const Wide product = static_cast<Wide>(raw_) * other.raw_;
+    raw_ = static_cast<int64_t>((product + half_raw) >> FractionBits);
+    return *this;
+  }
+
+  /**
+   * @brief Divides by a number, rounding towards zero.
+   *
+   * @param other Non-zero number.
+   *
+   * @return Reference to this number.
+   */
+  FixedPoint&
+  operator/=(const FixedPoint other)
+  {
+    raw_ = static_cast<int64_t>(
+        (static_cast<Wide>(raw_) * (static_cast<Wide>(1) << FractionBits)) /
+        other.raw_);
+    return *this;
+  }
+
+  /**
+   * @brief Adds one.
+   *
+   * @return Reference to this number.
+   */
+  FixedPoint&
+  operator++()
+  {
+    raw_ += one_raw;
+    return *this;
+  }
+
+  /**
+   * @brief Adds two numbers.
+   */
+  friend FixedPoint
+  operator+(FixedPoint lhs, const FixedPoint rhs)
+  {
+    return lhs += rhs;
+  }
+  /**
+   * @brief Subtracts two numbers.
+   */
+  friend FixedPoint
+  operator-(FixedPoint lhs, const FixedPoint rhs)
+  {
+    return lhs -= rhs;
+  }
+  /**
+   * @brief Multiplies two numbers.
+   */
+  friend FixedPoint
+  operator*(FixedPoint lhs, const FixedPoint rhs)
+  {
+    return lhs *= rhs;
+  }
+  /**
+   * @brief Divides two numbers.
+   */
+  friend FixedPoint
+  operator/(FixedPoint lhs, const FixedPoint rhs)
+  {
+    return lhs /= rhs;
+  }
+  /**
+   * @brief Compares two numbers.
+   */
+  friend constexpr bool
+  operator==(const FixedPoint lhs, const FixedPoint rhs)
+  {
+    return lhs.raw_ == rhs.raw_;
+  }
+  /**
+   * @brief Compares two numbers.
+   */
+  friend constexpr bool
+  operator!=(const FixedPoint lhs, const FixedPoint rhs)
+  {
+    return lhs.raw_ != rhs.raw_;
+  }
+  /**
+   * @brief Compares two numbers.
+   */
+  friend constexpr bool
+  operator<(const FixedPoint lhs, const FixedPoint rhs)
+  {
+    return lhs.raw_ < rhs.raw_;
+  }
+  /**
+   * @brief Compares two numbers.
+   */
+  friend constexpr bool
+  operator>(const FixedPoint lhs, const FixedPoint rhs)
+  {
+    return lhs.raw_ > rhs.raw_;
+  }
+
+ protected:
+  /**
+   * @brief Intermediate integer of products and quotients.
+   */
+  __extension__ typedef __int128 Wide;
+  /**
+   * @brief Underlying integer of one.
+   */
+  static constexpr int64_t one_raw = int64_t(1) << FractionBits;
+  /**
+   * @brief Underlying integer of one half, to round products.
+   */
+  static constexpr int64_t half_raw = int64_t(1) << (FractionBits - 1);
+  /**
+   * @brief Largest underlying integer.
+   */
+  static constexpr int64_t max_raw = std::numeric_limits<int64_t>::max();
+  /**
+   * @brief Smallest underlying integer.
+   */
+  static constexpr int64_t min_raw = std::numeric_limits<int64_t>::min();
+  /**
+   * @brief Largest integer part.
+   */
+  static constexpr int64_t max_integer = max_raw / one_raw;
+  /**
+   * @brief Smallest integer part.
+   */
+  static constexpr int64_t min_integer = min_raw / one_raw;
+
+  /**
+   * @brief Converts an integer or a floating-point number to an underlying
+   * integer, saturating out of range.
+   *
+   * @tparam T Type of the number.
+   *
+   * @param value Number.
+   *
+   * @return Underlying integer.
+   */
+  template <typename T>
+  static int64_t
+  convert(const T value)
+  {
+    if constexpr (std::is_floating_point<T>::value)
+    {
+      if (std::isnan(value))
+      {
+        return 0;
+      }
+      // 2^63 is exact in long double, unlike the largest underlying integer
+      const long double limit = -static_cast<long double>(min_raw);
+      const long double scaled = static_cast<long double>(value) * one_raw;
+      if (scaled >= limit)
+      {
+        return max_raw;
+      }
+      if (scaled <= -limit)
+      {
+        return min_raw;
+      }
+      return static_cast<int64_t>(std::llround(scaled));
+    }
+    else if constexpr (std::is_unsigned<T>::value)
+    {
+      if (static_cast<uint64_t>(value) > static_cast<uint64_t>(max_integer))
+      {
+        return max_raw;
+      }
+      return static_cast<int64_t>(value) * one_raw;
+    }
+    else
+    {
+      if (static_cast<int64_t>(value) > max_integer)
+      {
+        return max_raw;
+      }
+      if (static_cast<int64_t>(value) < min_integer)
+      {
+        return min_raw;
+      }
+      return static_cast<int64_t>(value) * one_raw;
+    }
+  }
+
+  /**
+   * @brief Number times \f$2^\text{FractionBits}\f$.
+   */
+  int64_t raw_;
+};
+
+/**
+ * @brief Returns the decay of the event count over a time difference,
+ * \f$1/(10^{-6}\Delta t\,n_\text{decay}+1)\f$, in fixed point.
+ *
+ * The decay is computed as \f$10^6/(\Delta t\,n_\text{decay}+10^6)\f$ with
+ * a 128-bit denominator, so that neither the small factor \f$10^{-6}\f$ nor
+ * long silences lose precision or overflow.
+ *
+ * @tparam FractionBits Number of fractional bits.
+ *
+ * @param t_diff Time difference \f$[\text{microseconds}]\f$.
+ * @param n_decay Count of the incoming number of events.
+ *
+ * @return Decay in \f$[0,1]\f$.
+ */
+template <unsigned FractionBits>
+inline FixedPoint<FractionBits>
+decay_factor(const FixedPoint<FractionBits> t_diff,
+             const FixedPoint<FractionBits> n_decay)
+{
+  __extension__ typedef __int128 Wide;
+  const Wide million = static_cast<Wide>(1000000) << (2 * FractionBits);
+  const Wide denominator =
+      static_cast<Wide>(t_diff.raw()) * n_decay.raw() + million;
+  return FixedPoint<FractionBits>::from_raw(
+      static_cast<int64_t>((million << FractionBits) / denominator));
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_FIXED_POINT_HPP
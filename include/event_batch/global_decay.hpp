@@ -6,9 +6,15 @@
 #ifndef EVENT_BATCH_GLOBAL_DECAY_HPP
 #define EVENT_BATCH_GLOBAL_DECAY_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
 #include <utility>
 
+#include "event_batch/checkpoint.hpp"
+#include "event_batch/decay_kernel.hpp"
+#include "event_batch/event_block.hpp"
 #include "event_batch/types.hpp"
 #include "event_batch/utils.hpp"
 
@@ -20,12 +26,21 @@ namespace event_batch
  * This class estimates the decay from a stream of events generated by a single
  * motion.
  *
+ * Only the timestamps of the events are read, through the \p Timestamp
+ * accessor.
+ * With event_batch::RawTimestamp and \p uint64_t as event type, the estimator
+ * runs on a column of timestamps, which the block overloads consume in place.
+ *
  * @tparam Event Type of event.
  * @tparam EventToDecay Type of the handle to pass from an event to a decay.
  * @tparam HandleDecay Type of the handle to further process the estimated
  * decay.
+ * @tparam Timestamp Type of the accessor to the timestamp of an event.
+ * @tparam Scalar Type of the decay arithmetic \sa event_batch::BasicDecay.
+ * The block overloads only use the vectorized kernel with \p float.
  */
-template <typename Event, typename EventToDecay, typename HandleDecay>
+template <typename Event, typename EventToDecay, typename HandleDecay,
+          typename Timestamp = EventTimestamp, typename Scalar = float>
 class GlobalDecay
 {
  public:
@@ -36,10 +51,13 @@ class GlobalDecay
    * @param t_decay_first @copybrief t_decay_first_
    * @param event_to_decay @copybrief event_to_decay_
    * @param handle_decay @copybrief handle_decay_
+   * @param timestamp @copybrief timestamp_
    */
   GlobalDecay(const uint64_t t_decay_first, EventToDecay&& event_to_decay,
-              HandleDecay&& handle_decay)
+              HandleDecay&& handle_decay, Timestamp timestamp = Timestamp())
       : t_decay_first_(t_decay_first),
+        kernel_(best_decay_kernel()),
+        timestamp_(timestamp),
         event_to_decay_(std::forward<EventToDecay>(event_to_decay)),
         handle_decay_(std::forward<HandleDecay>(handle_decay))
   {
@@ -84,7 +102,7 @@ class GlobalDecay
    *
    * @return Current decay.
    */
-  float
+  Scalar
   decay() const
   {
     return decay_.decay;
@@ -95,7 +113,7 @@ class GlobalDecay
    *
    * @return Count of the incoming number of events.
    */
-  float
+  Scalar
   n_decay() const
   {
     return decay_.n_decay;
@@ -106,7 +124,7 @@ class GlobalDecay
    *
    * @return Event time decay \f$[\text{microseconds}]\f$.
    */
-  float
+  Scalar
   t_decay() const
   {
     return decay_.t_decay;
@@ -118,7 +136,7 @@ class GlobalDecay
    *
    * @return Current event rate \f$[\text{events}/\text{microseconds}]\f$.
    */
-  float
+  Scalar
   rate() const
   {
     return decay_.rate;
@@ -135,27 +153,143 @@ class GlobalDecay
   void
   operator()(Event event)
   {
-    decay_.decay = static_cast<float>(1);
-    const float t_diff =
-        (event.t > decay_.t) ? static_cast<float>(event.t - decay_.t) : 0;
-    if (t_diff > 0)
-    {
-      decay_.decay /= static_cast<float>(1e-6) * t_diff * decay_.n_decay +
-                      static_cast<float>(1);
+    decay_.update(timestamp_(event));
 
-      decay_.n_decay *= decay_.decay;
-      decay_.t_decay = decay_.decay * decay_.t_decay + t_diff;
+    handle_decay_(event_to_decay_(event, decay_.decay, decay_.n_decay,
+                                  decay_.t_decay, decay_.rate));
+  }
 
-      decay_.t = event.t;
+  /**
+   * @brief Estimates the global decay of a block of events.
+   *
+   * This method estimates the decay of the events in [\p first, \p last) with
+   * the vectorized event_batch::decay_timestamps kernel and writes the decay of
+   * each event into the caller-provided output, instead of calling the handle
+   * for each event.
+   *
+   * @tparam OutputIt Type of the output iterator.
+   *
+   * @param first Pointer to the first event of the block.
+   * @param last Pointer to one past the last event of the block.
+   * @param d_first Beginning of the output, which must hold as many elements
+   * as the block.
+   *
+   * @return Output iterator to the element past the last written decay.
+   */
+  template <typename OutputIt>
+  OutputIt
+  operator()(const Event* first, const Event* last, OutputIt d_first)
+  {
+    uint64_t buffer[DecayLanes::capacity];
+    DecayLanes lanes;
+    while (first != last)
+    {
+      const std::size_t size = std::min(static_cast<std::size_t>(last - first),
+                                        DecayLanes::capacity);
+      const uint64_t* const t = timestamps(first, size, buffer);
+      if (decay_block(t, size, lanes))
+      {
+        if constexpr (std::is_same<Scalar, float>::value)
+        {
+          for (std::size_t i = 0; i < size; ++i, ++d_first)
+          {
+            *d_first = event_to_decay_(first[i], lanes.decay[i],
+                                       lanes.n_decay[i], lanes.t_decay[i],
+                                       lanes.rate[i]);
+          }
+        }
+      }
+      else
+      {
+        for (std::size_t i = 0; i < size; ++i, ++d_first)
+        {
+          decay_.update(t[i]);
+          *d_first = event_to_decay_(first[i], decay_.decay, decay_.n_decay,
+                                     decay_.t_decay, decay_.rate);
+        }
+      }
+      first += size;
     }
-    ++decay_.n_decay;
+    return d_first;
+  }
 
-    decay_.rate = decay_.n_decay / decay_.t_decay;
+  /**
+   * @brief Estimates the global decay of a block of events.
+   *
+   * This method estimates the decay of the events in [\p first, \p last) with
+   * the vectorized event_batch::decay_timestamps kernel, and calls the handle
+   * only once with the decay of the last event of the block.
+   *
+   * @param first Pointer to the first event of the block.
+   * @param last Pointer to one past the last event of the block.
+   */
+  void
+  operator()(const Event* first, const Event* last)
+  {
+    if (first == last)
+    {
+      return;
+    }
 
-    handle_decay_(event_to_decay_(event, decay_.decay, decay_.n_decay,
+    uint64_t buffer[DecayLanes::capacity];
+    DecayLanes lanes;
+    for (const Event* event = first; event != last;)
+    {
+      const std::size_t size = std::min(static_cast<std::size_t>(last - event),
+                                        DecayLanes::capacity);
+      const uint64_t* const t = timestamps(event, size, buffer);
+      if (!decay_block(t, size, lanes))
+      {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+          decay_.update(t[i]);
+        }
+      }
+      event += size;
+    }
+
+    handle_decay_(event_to_decay_(*(last - 1), decay_.decay, decay_.n_decay,
                                   decay_.t_decay, decay_.rate));
   }
 
+  /**
+   * @brief Estimates the global decay of a structure-of-arrays block of
+   * events.
+   *
+   * This method only reads the timestamp column, and calls the handle once
+   * with the decay of the last event of the block.
+   *
+   * @param block Block of events.
+   */
+  void
+  operator()(const EventBlock& block)
+  {
+    if (block.empty())
+    {
+      return;
+    }
+
+    DecayLanes lanes;
+    const uint64_t* const last = block.t.data() + block.size();
+    for (const uint64_t* t = block.t.data(); t != last;)
+    {
+      const std::size_t size =
+          std::min(static_cast<std::size_t>(last - t), DecayLanes::capacity);
+      if (!decay_block(t, size, lanes))
+      {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+          decay_.update(t[i]);
+        }
+      }
+      t += size;
+    }
+
+    handle_decay_(event_to_decay_(block[block.size() - 1], decay_.decay,
+                                  decay_.n_decay, decay_.t_decay,
+                                  decay_.rate));
+  }
+
   /**
    * @brief Resets the context.
    */
@@ -165,18 +299,121 @@ class GlobalDecay
     decay_.reset(t_decay_first_);
   }
 
+  /**
+   * @brief Resets the context to a decay checkpoint, so that the estimation
+   * resumes after the event the checkpoint was taken at.
+   *
+   * @param decay Decay checkpoint.
+   */
+  void
+  reset(const BasicDecay<Scalar>& decay)
+  {
+    decay_ = decay;
+  }
+
+  /**
+   * @brief Serializes the decay.
+   *
+   * @return Checkpoint, without pending events.
+   * \sa event_batch::write_checkpoint.
+   */
+  StdVector<uint8_t>
+  checkpoint() const
+  {
+    return write_checkpoint(decay_, Span<const Event>());
+  }
+
+  /**
+   * @brief Restores the decay from a checkpoint, so that the estimation
+   * resumes without bootstrapping the rate estimator again.
+   *
+   * The checkpoint may also hold pending events, e.g. when written by
+   * event_batch::Batch::checkpoint, which are ignored.
+   *
+   * @param bytes Checkpoint.
+   */
+  void
+  restore(const StdVector<uint8_t>& bytes)
+  {
+    StdVector<Event> batch;
+    decay_ = read_checkpoint<Scalar>(bytes, batch);
+  }
+
  protected:
+  /**
+   * @brief Estimates the decay of a block of timestamps with the vectorized
+   * kernel, when the decay arithmetic is single precision.
+   *
+   * @param t Pointer to the first timestamp.
+   * @param size Number of timestamps, at most
+   * event_batch::DecayLanes::capacity.
+   * @param lanes Output lanes.
+   *
+   * @return Whether the kernel estimated the block, otherwise the decay must
+   * be updated one timestamp at a time.
+   */
+  bool
+  decay_block(const uint64_t* t, const std::size_t size, DecayLanes& lanes)
+  {
+    if constexpr (std::is_same<Scalar, float>::value)
+    {
+      return decay_timestamps(decay_, t, size, lanes, kernel_);
+    }
+    else
+    {
+      static_cast<void>(t);
+      static_cast<void>(size);
+      static_cast<void>(lanes);
+      return false;
+    }
+  }
+
+  /**
+   * @brief Returns the timestamps of \p size events, either in place for
+   * event_batch::RawTimestamp or gathered into \p buffer.
+   *
+   * @param first Pointer to the first event.
+   * @param size Number of events.
+   * @param buffer Storage for the gathered timestamps.
+   *
+   * @return Pointer to the first timestamp.
+   */
+  const uint64_t*
+  timestamps(const Event* first, const std::size_t size, uint64_t* buffer) const
+  {
+    if constexpr (std::is_same<Timestamp, RawTimestamp>::value)
+    {
+      return first;
+    }
+    else
+    {
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        buffer[i] = timestamp_(first[i]);
+      }
+      return buffer;
+    }
+  }
+
   /**
    * @brief Initial time rate assumption to bootstrap the rate estimator
    * \f$[\text{microseconds}]\f$.
    */
   const uint64_t t_decay_first_;
+  /**
+   * @brief Implementation of the block kernel.
+   */
+  DecayKernel kernel_;
+  /**
+   * @brief Accessor to the timestamp of an event.
+   */
+  Timestamp timestamp_;
 
   /**
    * @brief Decay stucture.
-   * \sa event_batch::Decay.
+   * \sa event_batch::BasicDecay.
    */
-  Decay decay_;
+  BasicDecay<Scalar> decay_;
 
   /**
    * @brief Handle to pass from an event to a decay.
@@ -195,22 +432,59 @@ class GlobalDecay
  * @tparam EventToDecay Type of the handle to pass from an event to a decay.
  * @tparam HandleDecay Type of the handle to further process the estimated
  * decay.
+ * @tparam Timestamp Type of the accessor to the timestamp of an event.
  *
  * @param t_decay_first Initial decay assumption to bootstrap the rate
  * estimator \f$[\text{microseconds}]\f$.
  * @param event_to_decay Handle to pass from an event to to a decay.
  * @param handle_decay Handle to further process the estimated decay.
+ * @param timestamp Accessor to the timestamp of an event.
  *
  * @return Instance of event_batch::GlobalDecay.
  */
-template <typename Event, typename EventToDecay, typename HandleDecay>
-inline GlobalDecay<Event, EventToDecay, HandleDecay>
+template <typename Event, typename EventToDecay, typename HandleDecay,
+          typename Timestamp = EventTimestamp>
+inline GlobalDecay<Event, EventToDecay, HandleDecay, Timestamp>
 make_global_decay(const uint64_t t_decay_first, EventToDecay&& event_to_decay,
-                  HandleDecay&& handle_decay)
+                  HandleDecay&& handle_decay, Timestamp timestamp = Timestamp())
+{
+  return GlobalDecay<Event, EventToDecay, HandleDecay, Timestamp>(
+      t_decay_first, std::forward<EventToDecay>(event_to_decay),
+      std::forward<HandleDecay>(handle_decay), timestamp);
+}
+
+/**
+ * @brief Make function that creates an instance of event_batch::GlobalDecay
+ * with a given decay arithmetic.
+ *
+ * @tparam Scalar Type of the decay arithmetic, e.g. \p double or
+ * event_batch::FixedPoint.
+ * @tparam Event Type of event.
+ * @tparam EventToDecay Type of the handle to pass from an event to a decay,
+ * called with \p Scalar values.
+ * @tparam HandleDecay Type of the handle to further process the estimated
+ * decay.
+ * @tparam Timestamp Type of the accessor to the timestamp of an event.
+ *
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator \f$[\text{microseconds}]\f$.
+ * @param event_to_decay Handle to pass from an event to to a decay.
+ * @param handle_decay Handle to further process the estimated decay.
+ * @param timestamp Accessor to the timestamp of an event.
+ *
+ * @return Instance of event_batch::GlobalDecay.
+ */
+template <typename Scalar, typename Event, typename EventToDecay,
+          typename HandleDecay, typename Timestamp = EventTimestamp>
+inline GlobalDecay<Event, EventToDecay, HandleDecay, Timestamp, Scalar>
+make_basic_global_decay(const uint64_t t_decay_first,
+                        EventToDecay&& event_to_decay,
+                        HandleDecay&& handle_decay,
+                        Timestamp timestamp = Timestamp())
 {
-  return GlobalDecay<Event, EventToDecay, HandleDecay>(
+  return GlobalDecay<Event, EventToDecay, HandleDecay, Timestamp, Scalar>(
       t_decay_first, std::forward<EventToDecay>(event_to_decay),
-      std::forward<HandleDecay>(handle_decay));
+      std::forward<HandleDecay>(handle_decay), timestamp);
 }
 }  // namespace event_batch
 
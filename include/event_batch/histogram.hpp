@@ -0,0 +1,324 @@
+/**
+ * @file
+ * @brief Lock-free log-linear histogram.
+ */
+
+#ifndef EVENT_BATCH_HISTOGRAM_HPP
+#define EVENT_BATCH_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace event_batch
+{
+/**
+ * @brief Histogram of unsigned values with a bounded relative error.
+ *
+ * This class follows the layout of HDR histograms: values below
+ * \f$2^s\f$, with \f$s\f$ the number of significant bits, have their own
+ * bucket, and each following power of two is split into \f$2^{s-1}\f$
+ * buckets, so that the whole 64-bit range is covered with a relative error
+ * below \f$2^{1-s}\f$ in a few thousand buckets.
+ * Recording is wait-free, so that a histogram can be filled on a hot path and
+ * read from another thread, e.g. to display percentiles periodically, at the
+ * cost of slightly inconsistent reads while values are recorded.
+ */
+class Histogram
+{
+ public:
+  /**
+   * @brief Constructs an empty histogram.
+   *
+   * @param significant_bits @copybrief significant_bits_, in [2, 16].
+   */
+  explicit Histogram(const unsigned significant_bits = 7)
+      : significant_bits_(significant_bits)
+  {
+    if (significant_bits_ < 2 || significant_bits_ > 16)
+    {
+      throw std::runtime_error("the significant bits must be in [2, 16]");
+    }
+    number_buckets_ = static_cast<std::size_t>(66 - significant_bits_)
+                      << (significant_bits_ - 1);
+    buckets_.reset(new std::atomic<uint64_t>[number_buckets_]);
+    clear();
+  }
+
+  /**
+   * @brief Records a value.
+   *
+   * @param value Value.
+   * @param count Number of times the value occurred.
+   */
+  void
+  record(const uint64_t value, const uint64_t count = 1)
+  {
+    buckets_[index(value)].fetch_add(count, std::memory_order_relaxed);
+    count_.fetch_add(count, std::memory_order_relaxed);
+    sum_.fetch_add(value * count, std::memory_order_relaxed);
+    record_extrema(value, value);
+  }
+
+  /**
+   * @brief Adds the values of another histogram.
+   *
+   * @param other Histogram with the same number of significant bits.
+   */
+  void
+  merge(const Histogram& other)
+  {
+    if (other.significant_bits_ != significant_bits_)
+    {
+      throw std::runtime_error(
+          "the histograms must have the same significant bits");
+    }
+    for (std::size_t i = 0; i < number_buckets_; ++i)
+    {
+      const uint64_t count =
+          other.buckets_[i].load(std::memory_order_relaxed);
+      if (count > 0)
+      {
+        buckets_[i].fetch_add(count, std::memory_order_relaxed);
+      }
+    }
+    count_.fetch_add(other.size(), std::memory_order_relaxed);
+    sum_.fetch_add(other.sum_.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+    if (other.size() > 0)
+    {
+      record_extrema(other.min(), other.max());
+    }
+  }
+
+  /**
+   * @brief Returns the number of recorded values.
+   *
+   * @return Number of values.
+   */
+  uint64_t
+  size() const
+  {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Returns the smallest recorded value.
+   *
+   * @return Smallest value, 0 without values.
+   */
+  uint64_t
+  min() const
+  {
+    return (size() == 0) ? 0 : min_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Returns the largest recorded value.
+   *
+   * @return Largest value, 0 without values.
+   */
+  uint64_t
+  max() const
+  {
+    return max_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Returns the mean of the recorded values.
+   *
+   * @return Mean, 0 without values.
+   */
+  double
+  mean() const
+  {
+    const uint64_t count = size();
+    return (count == 0) ? 0
+                        : static_cast<double>(
+                              sum_.load(std::memory_order_relaxed)) /
+                              static_cast<double>(count);
+  }
+
+  /**
+   * @brief Returns a percentile of the recorded values, with the nearest-rank
+   * method.
+   *
+   * The percentile is the largest value of its bucket, clamped to the
+   * recorded extrema, so that it never underestimates the exact percentile by
+   * more than the relative error.
+   *
+   * @param percentage Percentage of the values below the percentile, in
+   * [0, 100].
+   *
+   * @return Percentile, 0 without values.
+   */
+  uint64_t
+  percentile(const double percentage) const
+  {
+    uint64_t count = 0;
+    for (std::size_t i = 0; i < number_buckets_; ++i)
+    {
+      count += buckets_[i].load(std::memory_order_relaxed);
+    }
+    if (count == 0)
+    {
+      return 0;
+    }
+    const double rank = std::clamp(
+        std::ceil(percentage / 100 * static_cast<double>(count)), 1.0,
+        static_cast<double>(count));
+    uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < number_buckets_; ++i)
+    {
+      cumulative += buckets_[i].load(std::memory_order_relaxed);
+      if (static_cast<double>(cumulative) >= rank)
+      {
+        return std::clamp(highest_value(i), min(), max());
+      }
+    }
+    return max();
+  }
+
+  /**
+   * @brief Removes all values.
+   *
+   * This function must not run concurrently with \ref record.
+   */
+  void
+  clear()
+  {
+    for (std::size_t i = 0; i < number_buckets_; ++i)
+    {
+      buckets_[i].store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(std::numeric_limits<uint64_t>::max(),
+               std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+ protected:
+  /**
+   * @brief Returns the bucket of a value.
+   *
+   * @param value Value.
+   *
+   * @return Index of the bucket.
+   */
+  std::size_t
+  index(const uint64_t value) const
+  {
+    if (value < (uint64_t(1) << significant_bits_))
+    {
+      return static_cast<std::size_t>(value);
+    }
+    const unsigned shift =
+        63 - static_cast<unsigned>(__builtin_clzll(value)) -
+        (significant_bits_ - 1);
+    return (static_cast<std::size_t>(shift) << (significant_bits_ - 1)) +
+           static_cast<std::size_t>(value >> shift);
+  }
+
+  /**
+   * @brief Returns the largest value of a bucket.
+   *
+   * @param i Index of the bucket.
+   *
+   * @return Largest value of the bucket.
+   */
+  uint64_t
+  highest_value(const std::size_t i) const
+  {
+    if (i < (std::size_t(1) << significant_bits_))
+    {
+      return i;
+    }
+    const unsigned shift =
+        static_cast<unsigned>(i >> (significant_bits_ - 1)) - 1;
+    const uint64_t mantissa =
+        i - (static_cast<std::size_t>(shift) << (significant_bits_ - 1));
+    // Wraps around to the largest value for the last bucket
+    return ((mantissa + 1) << shift) - 1;
+  }
+
+  /**
+   * @brief Updates the extrema.
+   *
+   * @param min Smallest new value.
+   * @param max Largest new value.
+   */
+  void
+  record_extrema(const uint64_t min, const uint64_t max)
+  {
+    uint64_t current = min_.load(std::memory_order_relaxed);
+    while (min < current && !min_.compare_exchange_weak(
+                                current, min, std::memory_order_relaxed))
+    {
+    }
+    current = max_.load(std::memory_order_relaxed);
+    while (max > current && !max_.compare_exchange_weak(
+                                current, max, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  /**
+   * @brief Number of significant bits of the values.
+   */
+  unsigned significant_bits_;
+  /**
+   * @brief Number of buckets.
+   */
+  std::size_t number_buckets_;
+  /**
+   * @brief Number of values of each bucket.
+   */
+  std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+  /**
+   * @brief Number of values.
+   */
+  std::atomic<uint64_t> count_;
+  /**
+   * @brief Sum of the values.
+   */
+  std::atomic<uint64_t> sum_;
+  /**
+   * @brief Smallest value.
+   */
+  std::atomic<uint64_t> min_;
+  /**
+   * @brief Largest value.
+   */
+  std::atomic<uint64_t> max_;
+};
+
+/**
+ * @brief Displays the percentiles of a histogram on one line.
+ *
+ * @param name Name of the histogram.
+ * @param histogram Histogram.
+ * @param unit Unit of the values.
+ * @param stream Output stream.
+ */
+inline void
+display_histogram(const std::string& name, const Histogram& histogram,
+                  const std::string& unit, std::ostream& stream = std::cout)
+{
+  stream << name << ": count " << histogram.size() << ", mean "
+         << histogram.mean() << ", p50 " << histogram.percentile(50)
+         << ", p90 " << histogram.percentile(90) << ", p99 "
+         << histogram.percentile(99) << ", p99.9 "
+         << histogram.percentile(99.9) << ", max " << histogram.max() << " ["
+         << unit << "]\n";
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_HISTOGRAM_HPP
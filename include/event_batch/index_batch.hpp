@@ -0,0 +1,310 @@
+/**
+ * @file
+ * @brief Batch estimator that emits index ranges.
+ */
+
+#ifndef EVENT_BATCH_INDEX_BATCH_HPP
+#define EVENT_BATCH_INDEX_BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "event_batch/global_decay.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Range of event indices [\p first, \p last).
+ */
+struct IndexRange
+{
+  /**
+   * @brief Index of the first event.
+   */
+  std::size_t first;
+  /**
+   * @brief Index of one past the last event.
+   */
+  std::size_t last;
+
+  /**
+   * @brief Returns the number of events.
+   *
+   * @return Number of events.
+   */
+  std::size_t
+  size() const
+  {
+    return last - first;
+  }
+};
+
+/**
+ * @brief Batch estimator from global decay that emits index ranges.
+ *
+ * This class splits a stream of events into the same batches as
+ * event_batch::Batch, with the same limits, but neither copies nor keeps the
+ * events: it counts the
+ * events since the last reset and emits each batch as the range of their
+ * indices.
+ * Callers that already hold the events in a buffer fed from its start thus
+ * get batches as index ranges into that buffer, and batch detection only
+ * reads the timestamps.
+ *
+ * @tparam Event Type of event.
+ * @tparam HandleRange Type of the handle to further process the estimated
+ * batch range.
+ * @tparam Timestamp Type of the accessor to the timestamp of an event.
+ */
+template <typename Event, typename HandleRange,
+          typename Timestamp = EventTimestamp>
+class IndexBatch
+{
+ public:
+  /**
+   * @brief Constructs an instance to estimate the ideal batch ranges of a
+   * stream of events from the corresponding global decay.
+   *
+   * @param weight_thresh @copybrief weight_thresh_
+   * @param decay @copybrief decay_
+   * @param handle_range @copybrief handle_range_
+   * @param limits @copybrief limits_
+   * @param timestamp @copybrief timestamp_
+   */
+  IndexBatch(const float weight_thresh, const Decay& decay,
+             HandleRange&& handle_range,
+             const BatchLimits& limits = BatchLimits(),
+             Timestamp timestamp = Timestamp())
+      : weight_thresh_(weight_thresh),
+        limits_(limits),
+        decay_(decay),
+        timestamp_(timestamp),
+        handle_range_(std::forward<HandleRange>(handle_range))
+  {
+    reset();
+  }
+  /**
+   * @brief Deleted copy constructor.
+   */
+  IndexBatch(const IndexBatch&) = delete;
+  /**
+   * @brief Default move constructor.
+   */
+  IndexBatch(IndexBatch&&) = default;
+  /**
+   * @brief Deleted copy assignment operator.
+   */
+  IndexBatch&
+  operator=(const IndexBatch&) = delete;
+  /**
+   * @brief Default move assignment operator.
+   */
+  IndexBatch&
+  operator=(IndexBatch&&) = default;
+  /**
+   * @brief Default destructor.
+   */
+  ~IndexBatch() = default;
+
+  /**
+   * @brief Returns the range of the batch being filled.
+   *
+   * @return Range of the pending batch.
+   */
+  IndexRange
+  pending() const
+  {
+    return {batch_first_, index_};
+  }
+
+  /**
+   * @brief Estimates the ideal batch of a stream of events from the
+   * corresponding global decay one event at a time.
+   *
+   * @param event Incoming event.
+   */
+  void
+  operator()(const Event& event)
+  {
+    push(timestamp_(event), decay_.n_decay);
+  }
+
+  /**
+   * @brief Estimates the ideal batch of a block of events from the
+   * corresponding global decays.
+   *
+   * @tparam DecayIt Type of the iterator over the decays, whose elements
+   * provide a \p n_decay member (e.g. event_batch::Decay).
+   *
+   * @param first Pointer to the first event of the block.
+   * @param last Pointer to one past the last event of the block.
+   * @param decays Beginning of the decays of each event of the block.
+   */
+  template <typename DecayIt>
+  void
+  operator()(const Event* first, const Event* last, DecayIt decays)
+  {
+    for (; first != last; ++first, ++decays)
+    {
+      push(timestamp_(*first), decays->n_decay);
+    }
+  }
+
+  /**
+   * @brief Resets the context, so that the next event has index 0.
+   */
+  void
+  reset()
+  {
+    index_ = 0;
+    batch_first_ = 0;
+    t_batch_first_ = 0;
+  }
+
+ protected:
+  /**
+   * @brief Counts an event and closes the current batch if its weight drops
+   * below the threshold or if it reaches a limit.
+   *
+   * An event that would stretch the batch past its maximum duration starts
+   * the next batch instead.
+   *
+   * @param t Timestamp of the event \f$[\text{microseconds}]\f$.
+   * @param n_decay Count of the incoming number of events after the event.
+   */
+  void
+  push(const uint64_t t, const float n_decay)
+  {
+    if (limits_.max_duration > 0 && index_ > batch_first_ &&
+        t > t_batch_first_ + limits_.max_duration)
+    {
+      handle_range_(IndexRange{batch_first_, index_});
+      batch_first_ = index_;
+    }
+    if (index_ == batch_first_)
+    {
+      t_batch_first_ = t;
+    }
+    ++index_;
+
+    const float t_diff =
+        (t > t_batch_first_) ? static_cast<float>(t - t_batch_first_) : 0;
+    const float weight =
+        static_cast<float>(1) /
+        (static_cast<float>(1e-6) * t_diff * n_decay + static_cast<float>(1));
+
+    if (weight < weight_thresh_ ||
+        index_ - batch_first_ == limits_.max_events)
+    {
+      handle_range_(IndexRange{batch_first_, index_});
+      batch_first_ = index_;
+    }
+  }
+
+  /**
+   * @brief Weight threshold that splits the batches.
+   */
+  const float weight_thresh_;
+  /**
+   * @brief Upper bounds on the batches, on top of the weight threshold.
+   */
+  const BatchLimits limits_;
+
+  /**
+   * @brief Decay stucture.
+   * \sa event_batch::Decay.
+   */
+  const Decay& decay_;
+  /**
+   * @brief Accessor to the timestamp of an event.
+   */
+  Timestamp timestamp_;
+
+  /**
+   * @brief Index of the next event.
+   */
+  std::size_t index_;
+  /**
+   * @brief Index of the first event of the current batch.
+   */
+  std::size_t batch_first_;
+  /**
+   * @brief Timestamp of the first event of the current batch
+   * \f$[\text{microseconds}]\f$.
+   */
+  uint64_t t_batch_first_;
+
+  /**
+   * @brief Handle to further process the estimated batch range.
+   */
+  HandleRange handle_range_;
+};
+
+/**
+ * @brief Make function that creates an instance of event_batch::IndexBatch.
+ *
+ * @tparam Event Type of event.
+ * @tparam HandleRange Type of the handle to further process the estimated
+ * batch range.
+ * @tparam Timestamp Type of the accessor to the timestamp of an event.
+ *
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param decay Decay stucture.
+ * \sa event_batch::Decay.
+ * @param handle_range Handle to further process the estimated batch range.
+ * @param limits Upper bounds on the batches.
+ * @param timestamp Accessor to the timestamp of an event.
+ *
+ * @return Instance of event_batch::IndexBatch.
+ */
+template <typename Event, typename HandleRange,
+          typename Timestamp = EventTimestamp>
+inline IndexBatch<Event, HandleRange, Timestamp>
+make_index_batch(const float weight_thresh, const Decay& decay,
+                 HandleRange&& handle_range,
+                 const BatchLimits& limits = BatchLimits(),
+                 Timestamp timestamp = Timestamp())
+{
+  return IndexBatch<Event, HandleRange, Timestamp>(
+      weight_thresh, decay, std::forward<HandleRange>(handle_range), limits,
+      timestamp);
+}
+
+/**
+ * @brief Estimates the global decay and the ideal batch ranges of a block of
+ * events.
+ *
+ * This function behaves as the overload for event_batch::Batch, with batches
+ * emitted as index ranges.
+ *
+ * @tparam Event Type of event.
+ * @tparam EventToDecay Type of the handle to pass from an event to a decay.
+ * @tparam HandleDecay Type of the handle to further process the estimated
+ * decay.
+ * @tparam HandleRange Type of the handle to further process the estimated
+ * batch range.
+ * @tparam Timestamp Type of the accessor to the timestamp of an event.
+ *
+ * @param global_decay Global decay estimator.
+ * @param index_batch Batch range estimator.
+ * @param first Pointer to the first event of the block.
+ * @param last Pointer to one past the last event of the block.
+ * @param decays Caller-provided storage for the decay of each event, which must
+ * hold as many elements as the block.
+ */
+template <typename Event, typename EventToDecay, typename HandleDecay,
+          typename HandleRange, typename Timestamp>
+inline void
+decay_and_batch(
+    GlobalDecay<Event, EventToDecay, HandleDecay, Timestamp>& global_decay,
+    IndexBatch<Event, HandleRange, Timestamp>& index_batch, const Event* first,
+    const Event* last, Decay* decays)
+{
+  global_decay(first, last, decays);
+  index_batch(first, last, decays);
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_INDEX_BATCH_HPP
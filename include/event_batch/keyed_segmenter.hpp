@@ -0,0 +1,309 @@
+/**
+ * @file
+ * @brief Keyed decay and batch estimator implementation.
+ */
+
+#ifndef EVENT_BATCH_KEYED_SEGMENTER_HPP
+#define EVENT_BATCH_KEYED_SEGMENTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Keyed decay and batch estimator.
+ *
+ * This class estimates an independent decay and ideal batch for each key of
+ * a stream of events, in the same way as event_batch::AdaptiveSegmenter does
+ * for the events of that key only, in a single pass over the events.
+ * The keys of an event are found by a dispatcher, e.g. the tile of its pixel
+ * (event_batch::TiledDecay), the regions that contain it
+ * (event_batch::RegionSegmenter) or its polarity
+ * (event_batch::PolaritySegmenter).
+ * The state of each key lives in its own cache line of a contiguous array,
+ * and the batches of each key are bounded in the same way as
+ * event_batch::Batch.
+ * Batches are passed to the handle with their key, as views that are only
+ * valid during the handle call.
+ *
+ * @tparam Event Type of event.
+ * @tparam Dispatch Type of the dispatcher, with a \p number_keys() method
+ * and an \p operator()(const Event&, Push&&) that calls \p push with each key
+ * of the event, in [0, number_keys()).
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch of a key, called with the key and a event_batch::Span<const Event>.
+ */
+template <typename Event, typename Dispatch, typename HandleBatch>
+class KeyedSegmenter
+{
+ public:
+  /**
+   * @brief Constructs an instance to estimate the ideal batches of each key.
+   *
+   * @param dispatch @copybrief dispatch_
+   * @param t_decay_first @copybrief t_decay_first_
+   * @param weight_thresh Weight threshold that splits the batches.
+   * @param handle_batch @copybrief handle_batch_
+   * @param limits @copybrief limits_
+   */
+  KeyedSegmenter(Dispatch&& dispatch, const uint64_t t_decay_first,
+                 const float weight_thresh, HandleBatch&& handle_batch,
+                 const BatchLimits& limits = BatchLimits())
+      : dispatch_(std::move(dispatch)),
+        t_decay_first_(t_decay_first),
+        inverse_weight_thresh_(static_cast<float>(1) / weight_thresh),
+        limits_(limits),
+        states_(dispatch_.number_keys()),
+        handle_batch_(std::forward<HandleBatch>(handle_batch))
+  {
+    reset();
+  }
+  /**
+   * @brief Deleted copy constructor.
+   */
+  KeyedSegmenter(const KeyedSegmenter&) = delete;
+  /**
+   * @brief Default move constructor.
+   */
+  KeyedSegmenter(KeyedSegmenter&&) = default;
+  /**
+   * @brief Deleted copy assignment operator.
+   */
+  KeyedSegmenter&
+  operator=(const KeyedSegmenter&) = delete;
+  /**
+   * @brief Default move assignment operator.
+   */
+  KeyedSegmenter&
+  operator=(KeyedSegmenter&&) = default;
+  /**
+   * @brief Default destructor.
+   */
+  ~KeyedSegmenter() = default;
+
+  /**
+   * @brief Returns the number of keys.
+   *
+   * @return Number of keys.
+   */
+  std::size_t
+  number_keys() const
+  {
+    return states_.size();
+  }
+
+  /**
+   * @brief Returns the current decay of a key.
+   *
+   * @param key Key.
+   *
+   * @return Current decay of the key.
+   */
+  const Decay&
+  decay(const std::size_t key) const
+  {
+    return states_[key].decay;
+  }
+
+  /**
+   * @brief Returns the pending batch of a key.
+   *
+   * @param key Key.
+   *
+   * @return Pending batch of the key.
+   */
+  const StdVector<Event>&
+  batch(const std::size_t key) const
+  {
+    return states_[key].batch;
+  }
+
+  /**
+   * @brief Estimates the decays and the ideal batches of the keys of an
+   * event.
+   *
+   * @param event Incoming event.
+   */
+  void
+  operator()(Event event)
+  {
+    dispatch_(event, [&](const std::size_t key) { push(key, event); });
+  }
+
+  /**
+   * @brief Estimates the decays and the ideal batches of the keys of a block
+   * of events.
+   *
+   * @param first Pointer to the first event of the block.
+   * @param last Pointer to one past the last event of the block.
+   */
+  void
+  operator()(const Event* first, const Event* last)
+  {
+    for (; first != last; ++first)
+    {
+      dispatch_(*first, [&](const std::size_t key) { push(key, *first); });
+    }
+  }
+
+  /**
+   * @brief Passes the pending batch of every key to the handle, in key order,
+   * and clears it.
+   */
+  void
+  flush()
+  {
+    for (std::size_t key = 0; key < states_.size(); ++key)
+    {
+      if (!states_[key].batch.empty())
+      {
+        emit(key);
+      }
+    }
+  }
+
+  /**
+   * @brief Resets the context.
+   *
+   * With a maximum number of events, the batch of each key is reserved to it,
+   * so that it never reallocates.
+   */
+  void
+  reset()
+  {
+    for (State& state : states_)
+    {
+      state.decay.reset(t_decay_first_);
+      state.batch.clear();
+      if (limits_.max_events > 0)
+      {
+        state.batch.reserve(limits_.max_events);
+      }
+    }
+  }
+
+ protected:
+  /**
+   * @brief State of a key, which fills its own cache line.
+   */
+  struct alignas(64) State
+  {
+    /**
+     * @brief Decay of the key.
+     */
+    Decay decay;
+    /**
+     * @brief Pending batch of the key.
+     */
+    StdVector<Event> batch;
+  };
+
+  /**
+   * @brief Updates the decay of a key with an event, adds the event to the
+   * batch of the key and closes the batch if its weight drops below the
+   * threshold or if it reaches a limit.
+   *
+   * @param key Key of the event.
+   * @param event Incoming event.
+   */
+  void
+  push(const std::size_t key, const Event& event)
+  {
+    State& state = states_[key];
+    state.decay.update(event.t);
+    if (limits_.max_duration > 0 && !state.batch.empty() &&
+        event.t > state.batch[0].t + limits_.max_duration)
+    {
+      emit(key);
+    }
+    state.batch.push_back(event);
+
+    if (closes_batch(event.t, state.batch[0].t, state.decay.n_decay,
+                     inverse_weight_thresh_) ||
+        state.batch.size() == limits_.max_events)
+    {
+      emit(key);
+    }
+  }
+
+  /**
+   * @brief Passes the batch of a key to the handle and clears it.
+   *
+   * @param key Key.
+   */
+  void
+  emit(const std::size_t key)
+  {
+    State& state = states_[key];
+    handle_batch_(key,
+                  Span<const Event>(state.batch.data(), state.batch.size()));
+    state.batch.clear();
+  }
+
+  /**
+   * @brief Dispatcher that finds the keys of an event.
+   */
+  Dispatch dispatch_;
+  /**
+   * @brief Initial time rate assumption to bootstrap the rate estimator of
+   * each key \f$[\text{microseconds}]\f$.
+   */
+  uint64_t t_decay_first_;
+  /**
+   * @brief Inverse of the weight threshold that splits the batches.
+   */
+  float inverse_weight_thresh_;
+  /**
+   * @brief Upper bounds on the batches of each key, on top of the weight
+   * threshold.
+   */
+  BatchLimits limits_;
+
+  /**
+   * @brief State of each key.
+   */
+  StdVector<State> states_;
+
+  /**
+   * @brief Handle to further process the estimated batch of a key.
+   */
+  HandleBatch handle_batch_;
+};
+
+/**
+ * @brief Make function that creates an instance of
+ * event_batch::KeyedSegmenter.
+ *
+ * @tparam Event Type of event.
+ * @tparam Dispatch Type of the dispatcher that finds the keys of an event.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch of a key.
+ *
+ * @param dispatch Dispatcher that finds the keys of an event.
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator of each key \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param handle_batch Handle to further process the estimated batch of a
+ * key.
+ * @param limits Upper bounds on the batches of each key.
+ *
+ * @return Instance of event_batch::KeyedSegmenter.
+ */
+template <typename Event, typename Dispatch, typename HandleBatch>
+inline KeyedSegmenter<Event, Dispatch, HandleBatch>
+make_keyed_segmenter(Dispatch dispatch, const uint64_t t_decay_first,
+                     const float weight_thresh, HandleBatch&& handle_batch,
+                     const BatchLimits& limits = BatchLimits())
+{
+  return KeyedSegmenter<Event, Dispatch, HandleBatch>(
+      std::move(dispatch), t_decay_first, weight_thresh,
+      std::forward<HandleBatch>(handle_batch), limits);
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_KEYED_SEGMENTER_HPP
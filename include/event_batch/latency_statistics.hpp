@@ -0,0 +1,133 @@
+/**
+ * @file
+ * @brief Latency statistics.
+ */
+
+#ifndef EVENT_BATCH_LATENCY_STATISTICS_HPP
+#define EVENT_BATCH_LATENCY_STATISTICS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+#include "event_batch/histogram.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Latency samples and their percentiles.
+ *
+ * The samples are recorded in nanoseconds in an event_batch::Histogram, so
+ * that the memory is bounded however long the stream runs, and the statistics
+ * can be read from another thread while samples are added.
+ * The mean is exact up to a nanosecond, and the percentiles are within the
+ * relative error of the histogram.
+ */
+class LatencyStatistics
+{
+ public:
+  /**
+   * @brief Adds a sample.
+   *
+   * @param latency Latency \f$[\text{microseconds}]\f$, clamped to 0 if
+   * negative.
+   */
+  void
+  add(const double latency)
+  {
+    histogram_.record(
+        static_cast<uint64_t>(std::llround(std::max(latency, 0.0) * 1e3)));
+  }
+
+  /**
+   * @brief Returns the number of samples.
+   *
+   * @return Number of samples.
+   */
+  std::size_t
+  size() const
+  {
+    return static_cast<std::size_t>(histogram_.size());
+  }
+
+  /**
+   * @brief Returns the mean latency.
+   *
+   * @return Mean latency \f$[\text{microseconds}]\f$, 0 without samples.
+   */
+  double
+  mean() const
+  {
+    return histogram_.mean() / 1e3;
+  }
+
+  /**
+   * @brief Returns a percentile of the latency, with the nearest-rank
+   * method.
+   *
+   * \sa event_batch::Histogram::percentile.
+   *
+   * @param percentage Percentage of the samples below the percentile, in
+   * [0, 100].
+   *
+   * @return Percentile \f$[\text{microseconds}]\f$, 0 without samples.
+   */
+  double
+  percentile(const double percentage) const
+  {
+    return static_cast<double>(histogram_.percentile(percentage)) / 1e3;
+  }
+
+  /**
+   * @brief Returns the histogram of the samples.
+   *
+   * @return Histogram of the samples \f$[\text{nanoseconds}]\f$.
+   */
+  const Histogram&
+  histogram() const
+  {
+    return histogram_;
+  }
+
+  /**
+   * @brief Removes all samples.
+   *
+   * This function must not run concurrently with \ref add.
+   */
+  void
+  clear()
+  {
+    histogram_.clear();
+  }
+
+ protected:
+  /**
+   * @brief Histogram of the samples \f$[\text{nanoseconds}]\f$.
+   */
+  Histogram histogram_;
+};
+
+/**
+ * @brief Displays latency statistics.
+ *
+ * @param latency_statistics Latency statistics.
+ * @param stream Output stream.
+ */
+inline void
+display_latency_statistics(const LatencyStatistics& latency_statistics,
+                           std::ostream& stream = std::cout)
+{
+  stream << "number of batches: " << latency_statistics.size() << '\n';
+  stream << "mean latency: " << latency_statistics.mean() << " [microsec]\n";
+  stream << "p50 latency: " << latency_statistics.percentile(50)
+         << " [microsec]\n";
+  stream << "p99 latency: " << latency_statistics.percentile(99)
+         << " [microsec]\n";
+  stream << "max latency: " << latency_statistics.percentile(100)
+         << " [microsec]\n";
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_LATENCY_STATISTICS_HPP
@@ -0,0 +1,192 @@
+/**
+ * @file
+ * @brief Little-endian encoding of the binary file formats.
+ */
+
+#ifndef EVENT_BATCH_LITTLE_ENDIAN_HPP
+#define EVENT_BATCH_LITTLE_ENDIAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "event_batch/fixed_point.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/// \cond
+namespace little_endian
+{
+/**
+ * @brief Size of an encoded event_batch::BasicDecay in bytes.
+ */
+template <typename Scalar>
+constexpr std::size_t basic_decay_size =
+    sizeof(uint64_t) + 4 * sizeof(Scalar);
+
+/**
+ * @brief Size of an encoded event_batch::Decay in bytes.
+ */
+constexpr std::size_t decay_size = basic_decay_size<float>;
+
+/**
+ * @brief Writes an unsigned integer in little endian.
+ */
+template <typename T>
+inline uint8_t*
+encode(uint8_t* byte, const T value)
+{
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+  {
+    *(byte++) = static_cast<uint8_t>(value >> (8 * i));
+  }
+  return byte;
+}
+
+/**
+ * @brief Writes a float in little endian.
+ */
+inline uint8_t*
+encode(uint8_t* byte, const float value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return encode(byte, bits);
+}
+
+/**
+ * @brief Writes a double in little endian.
+ */
+inline uint8_t*
+encode(uint8_t* byte, const double value)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return encode(byte, bits);
+}
+
+/**
+ * @brief Writes a fixed-point number in little endian.
+ */
+template <unsigned FractionBits>
+inline uint8_t*
+encode(uint8_t* byte, const FixedPoint<FractionBits> value)
+{
+  return encode(byte, static_cast<uint64_t>(value.raw()));
+}
+
+/**
+ * @brief Writes an event in little endian.
+ */
+inline uint8_t*
+encode(uint8_t* byte, const Event& event)
+{
+  byte = encode(byte, event.t);
+  byte = encode(byte, event.x);
+  byte = encode(byte, event.y);
+  return encode(byte, event.p);
+}
+
+/**
+ * @brief Reads an unsigned integer in little endian.
+ */
+template <typename T>
+inline const uint8_t*
+decode(const uint8_t* byte, T& value)
+{
+  value = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+  {
+    value |= static_cast<T>(*(byte++)) << (8 * i);
+  }
+  return byte;
+}
+
+/**
+ * @brief Reads a float in little endian.
+ */
+inline const uint8_t*
+decode(const uint8_t* byte, float& value)
+{
+  uint32_t bits;
+  byte = decode(byte, bits);
+  std::memcpy(&value, &bits, sizeof(value));
+  return byte;
+}
+
+/**
+ * @brief Reads a double in little endian.
+ */
+inline const uint8_t*
+decode(const uint8_t* byte, double& value)
+{
+  uint64_t bits;
+  byte = decode(byte, bits);
+  std::memcpy(&value, &bits, sizeof(value));
+  return byte;
+}
+
+/**
+ * @brief Reads a fixed-point number in little endian.
+ */
+template <unsigned FractionBits>
+inline const uint8_t*
+decode(const uint8_t* byte, FixedPoint<FractionBits>& value)
+{
+  uint64_t bits;
+  byte = decode(byte, bits);
+  value = FixedPoint<FractionBits>::from_raw(static_cast<int64_t>(bits));
+  return byte;
+}
+
+/**
+ * @brief Reads an event in little endian.
+ */
+inline const uint8_t*
+decode(const uint8_t* byte, Event& event)
+{
+  uint64_t t;
+  uint16_t x;
+  uint16_t y;
+  uint16_t p;
+  byte = decode(byte, t);
+  byte = decode(byte, x);
+  byte = decode(byte, y);
+  byte = decode(byte, p);
+  event = {t, x, y, p};
+  return byte;
+}
+
+/**
+ * @brief Writes a decay in little endian.
+ */
+template <typename Scalar>
+inline uint8_t*
+encode(uint8_t* byte, const BasicDecay<Scalar>& decay)
+{
+  byte = encode(byte, decay.t);
+  byte = encode(byte, decay.decay);
+  byte = encode(byte, decay.n_decay);
+  byte = encode(byte, decay.t_decay);
+  return encode(byte, decay.rate);
+}
+
+/**
+ * @brief Reads a decay in little endian.
+ */
+template <typename Scalar>
+inline const uint8_t*
+decode(const uint8_t* byte, BasicDecay<Scalar>& decay)
+{
+  byte = decode(byte, decay.t);
+  byte = decode(byte, decay.decay);
+  byte = decode(byte, decay.n_decay);
+  byte = decode(byte, decay.t_decay);
+  return decode(byte, decay.rate);
+}
+}  // namespace little_endian
+/// \endcond
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_LITTLE_ENDIAN_HPP
@@ -0,0 +1,257 @@
+/**
+ * @file
+ * @brief Intra-stream parallel batch segmentation.
+ */
+
+#ifndef EVENT_BATCH_PARALLEL_SEGMENTATION_HPP
+#define EVENT_BATCH_PARALLEL_SEGMENTATION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/types.hpp"
+#include "event_batch/work_stealing_pool.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Closes the pending batch of a stream at an event, if the event
+ * closes it before or after joining it.
+ *
+ * An event that would stretch the batch past its maximum duration starts the
+ * next batch, which the event may then close in turn, as in
+ * event_batch::AdaptiveSegmenter.
+ *
+ * @tparam Event Type of event.
+ * @tparam Close Type of the function called with each closing boundary.
+ *
+ * @param first Pointer to the first event of the stream.
+ * @param i Index of the event.
+ * @param batch_first Index of the first event of the pending batch, moved past
+ * each closed batch.
+ * @param n_decay Count of the incoming number of events after the event.
+ * @param inverse_weight_thresh Inverse of the weight threshold.
+ * @param limits Upper bounds on the batches.
+ * @param close Function called with the index one past the last event of
+ * each closed batch.
+ */
+template <typename Event, typename Close>
+inline void
+close_batches(const Event* first, const std::size_t i,
+              std::size_t& batch_first, const float n_decay,
+              const float inverse_weight_thresh, const BatchLimits& limits,
+              Close&& close)
+{
+  if (limits.max_duration > 0 && i > batch_first &&
+      first[i].t > first[batch_first].t + limits.max_duration)
+  {
+    batch_first = i;
+    close(batch_first);
+  }
+  if (closes_batch(first[i].t, first[batch_first].t, n_decay,
+                   inverse_weight_thresh) ||
+      i + 1 - batch_first == limits.max_events)
+  {
+    batch_first = i + 1;
+    close(batch_first);
+  }
+}
+
+/**
+ * @brief Splits a stream of events into batches sequentially.
+ *
+ * This function is the reference for \ref segment_parallel, and yields the
+ * same batches as event_batch::AdaptiveSegmenter fed one event at a time (the
+ * block overload may move a boundary that ties with the threshold, since its
+ * vectorized decay rounds differently).
+ *
+ * @tparam Event Type of event.
+ *
+ * @param first Pointer to the first event of the stream.
+ * @param last Pointer to one past the last event of the stream.
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param limits Upper bounds on the batches.
+ *
+ * @return Index one past the last event of each closed batch.
+ * The events after the last index form the pending batch.
+ */
+template <typename Event>
+inline StdVector<std::size_t>
+segment(const Event* first, const Event* last, const uint64_t t_decay_first,
+        const float weight_thresh, const BatchLimits& limits = BatchLimits())
+{
+  const float inverse_weight_thresh = static_cast<float>(1) / weight_thresh;
+  const std::size_t size = static_cast<std::size_t>(last - first);
+
+  StdVector<std::size_t> ends;
+  Decay decay;
+  decay.reset(t_decay_first);
+  std::size_t batch_first = 0;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    decay.update(first[i].t);
+    close_batches(first, i, batch_first, decay.n_decay, inverse_weight_thresh,
+                  limits,
+                  [&](const std::size_t end) { ends.push_back(end); });
+  }
+  return ends;
+}
+
+/**
+ * @brief Splits a stream of events into batches using several threads.
+ *
+ * The stream is split into chunks of equal number of events, which are
+ * processed in parallel in two steps:
+ *  1. The decay of each event of a chunk is estimated from a reset state at
+ *  the start of a warm-up window of \p t_warmup microseconds before the chunk.
+ *  Since the decay forgets its history exponentially, the warm-up makes the
+ *  decay at the start of the chunk match the sequential one up to a small
+ *  error, which vanishes as \p t_warmup grows (the first chunk is exact).
+ *  2. The batch boundaries of each chunk are computed speculatively, assuming
+ *  that a batch starts at the first event of the chunk.
+ *
+ * The chunks are then reconciled sequentially: the batch left open by the
+ * previous chunk is continued into the current chunk until one of its
+ * boundaries matches a speculative boundary, from which point both agree and
+ * the remaining speculative boundaries are kept.
+ * Hence, given the decays of step 1, the boundaries are exactly those of the
+ * sequential scan, since the limits also only depend on the first event of
+ * the batch.
+ * With a warm-up window covering the whole stream, the result is identical to
+ * \ref segment.
+ * The number of threads only changes the runtime, not the boundaries, so that
+ * a caller that already runs in parallel (e.g. one task per file) can share
+ * its thread budget with the chunks instead of oversubscribing the cores.
+ *
+ * @tparam Event Type of event.
+ *
+ * @param first Pointer to the first event of the stream.
+ * @param last Pointer to one past the last event of the stream.
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param number_chunks Number of chunks, each processed by one task.
+ * @param t_warmup Duration of the warm-up window before each chunk
+ * \f$[\text{microseconds}]\f$.
+ * @param limits Upper bounds on the batches.
+ * @param number_threads Largest number of threads running the tasks,
+ * including the calling thread.
+ * If 0, the number of concurrent threads supported by the machine is used.
+ *
+ * @return Index one past the last event of each closed batch.
+ * The events after the last index form the pending batch.
+ */
+template <typename Event>
+inline StdVector<std::size_t>
+segment_parallel(const Event* first, const Event* last,
+                 const uint64_t t_decay_first, const float weight_thresh,
+                 const std::size_t number_chunks, const uint64_t t_warmup,
+                 const BatchLimits& limits = BatchLimits(),
+                 const std::size_t number_threads = 0)
+{
+  const float inverse_weight_thresh = static_cast<float>(1) / weight_thresh;
+  const std::size_t size = static_cast<std::size_t>(last - first);
+  const std::size_t chunk_size =
+      (size + std::max(number_chunks, std::size_t(1)) - 1) /
+      std::max(number_chunks, std::size_t(1));
+  if (chunk_size == 0)
+  {
+    return {};
+  }
+  const std::size_t n_chunks = (size + chunk_size - 1) / chunk_size;
+
+  StdVector<float> n_decays(size);
+  StdVector<StdVector<std::size_t>> chunk_ends(n_chunks);
+  StdVector<std::size_t> chunk_batch_firsts(n_chunks);
+
+  StdVector<WorkStealingPool::Task> tasks;
+  for (std::size_t c = 0; c < n_chunks; ++c)
+  {
+    tasks.push_back([&, c]() {
+      const std::size_t chunk_first = c * chunk_size;
+      const std::size_t chunk_last = std::min(chunk_first + chunk_size, size);
+
+      // Warm-up
+      Decay decay;
+      decay.reset(t_decay_first);
+      if (c > 0)
+      {
+        const uint64_t t_chunk = first[chunk_first].t;
+        const uint64_t t_warmup_first =
+            (t_chunk > t_warmup) ? t_chunk - t_warmup : 0;
+        const std::size_t warmup_first = static_cast<std::size_t>(
+            std::lower_bound(first, first + chunk_first, t_warmup_first,
+                             [](const Event& event, const uint64_t t) {
+                               return event.t < t;
+                             }) -
+            first);
+        for (std::size_t i = warmup_first; i < chunk_first; ++i)
+        {
+          decay.update(first[i].t);
+        }
+      }
+
+      // Decays and speculative boundaries
+      std::size_t batch_first = chunk_first;
+      for (std::size_t i = chunk_first; i < chunk_last; ++i)
+      {
+        decay.update(first[i].t);
+        n_decays[i] = decay.n_decay;
+        close_batches(
+            first, i, batch_first, decay.n_decay, inverse_weight_thresh,
+            limits,
+            [&](const std::size_t end) { chunk_ends[c].push_back(end); });
+      }
+      chunk_batch_firsts[c] = batch_first;
+    });
+  }
+  WorkStealingPool(number_threads).run(std::move(tasks));
+
+  // Reconciliation
+  StdVector<std::size_t> ends(chunk_ends[0]);
+  std::size_t batch_first = chunk_batch_firsts[0];
+  for (std::size_t c = 1; c < n_chunks; ++c)
+  {
+    const std::size_t chunk_first = c * chunk_size;
+    const std::size_t chunk_last = std::min(chunk_first + chunk_size, size);
+    const StdVector<std::size_t>& speculative_ends = chunk_ends[c];
+
+    bool converged = (batch_first == chunk_first);
+    auto speculative_end = speculative_ends.begin();
+    for (std::size_t i = chunk_first; i < chunk_last && !converged; ++i)
+    {
+      close_batches(first, i, batch_first, n_decays[i], inverse_weight_thresh,
+                    limits, [&](const std::size_t end) {
+                      if (converged)
+                      {
+                        return;
+                      }
+                      speculative_end = std::lower_bound(
+                          speculative_end, speculative_ends.end(), end);
+                      if (speculative_end != speculative_ends.end() &&
+                          *speculative_end == end)
+                      {
+                        converged = true;
+                      }
+                      else
+                      {
+                        ends.push_back(end);
+                      }
+                    });
+    }
+    if (converged)
+    {
+      ends.insert(ends.end(), speculative_end, speculative_ends.end());
+      batch_first = chunk_batch_firsts[c];
+    }
+  }
+  return ends;
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_PARALLEL_SEGMENTATION_HPP
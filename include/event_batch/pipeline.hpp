@@ -0,0 +1,243 @@
+/**
+ * @file
+ * @brief Three-stage decoding, estimation and batch handling pipeline.
+ */
+
+#ifndef EVENT_BATCH_PIPELINE_HPP
+#define EVENT_BATCH_PIPELINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/spsc_ring.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Options of event_batch::run_pipeline.
+ */
+struct PipelineOptions
+{
+  /**
+   * @brief Number of blocks of events in flight between the source and the
+   * estimator.
+   */
+  std::size_t number_blocks = 16;
+  /**
+   * @brief Number of batches in flight between the estimator and the batch
+   * handle.
+   */
+  std::size_t number_batches = 64;
+  /**
+   * @brief Upper bounds on the batches, on top of the weight threshold.
+   */
+  BatchLimits limits;
+  /**
+   * @brief Cores of the source, estimator and batch handle threads, reused
+   * in order if fewer than three.
+   *
+   * If empty, the threads are left to the scheduler, which honors the
+   * affinity mask of the process and spreads concurrent pipelines.
+   */
+  StdVector<std::size_t> cpus;
+};
+
+/**
+ * @brief Estimates the ideal batches of a source of events on three threads.
+ *
+ * The source, the estimation of the global decay and the ideal batch, and the
+ * batch handle run on their own threads, so that a slow handle no longer
+ * stalls the decoding: the pipeline sustains the throughput of its slowest
+ * stage rather than the sum of the three.
+ * The blocks of events are passed from the source to the estimator through a
+ * lock-free event_batch::SpscRing, and the batches from the estimator to the
+ * handle through a second one.
+ * Both kinds of buffers are sent back through a ring in the opposite
+ * direction once consumed, so that no allocation happens in steady state.
+ * The batches are the same as those of event_batch::AdaptiveSegmenter with
+ * the same limits, and the pending batch is passed to the handle at the end
+ * of the source.
+ * If a stage throws, or a thread cannot be pinned to its core, the other
+ * stages stop and the first exception is rethrown once all threads are
+ * joined.
+ *
+ * @tparam Event Type of event.
+ * @tparam Source Type of the source, called once with a handle that takes
+ * blocks of events as a range [\p first, \p last) (e.g. a lambda calling
+ * event_batch::for_each_block).
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch, called with a event_batch::Span<const Event>.
+ *
+ * @param source Source of events.
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param handle_batch Handle to further process the estimated batch.
+ * @param options Sizes of the rings, limits of the batches and cores of the
+ * threads.
+ */
+template <typename Event, typename Source, typename HandleBatch>
+inline void
+run_pipeline(Source&& source, const uint64_t t_decay_first,
+             const float weight_thresh, HandleBatch&& handle_batch,
+             const PipelineOptions& options = PipelineOptions())
+{
+  // Thrown by a stage whose ring was closed by another stage
+  struct Stopped
+  {
+  };
+
+  SpscRing<StdVector<Event>> blocks(options.number_blocks);
+  SpscRing<StdVector<Event>> free_blocks(options.number_blocks);
+  SpscRing<StdVector<Event>> batches(options.number_batches);
+  SpscRing<StdVector<Event>> free_batches(options.number_batches);
+
+  std::mutex exception_mutex;
+  std::exception_ptr exception;
+  auto stop = [&]() {
+    blocks.close();
+    free_blocks.close();
+    batches.close();
+    free_batches.close();
+  };
+  auto run_stage = [&](auto&& stage) {
+    try
+    {
+      stage();
+    }
+    catch (const Stopped&)
+    {
+    }
+    catch (...)
+    {
+      {
+        const std::lock_guard<std::mutex> lock(exception_mutex);
+        if (!exception)
+        {
+          exception = std::current_exception();
+        }
+      }
+      stop();
+    }
+  };
+
+  auto run_source = [&]() {
+    StdVector<Event> block;
+    std::size_t number_allocated = 0;
+    source([&](const Event* first, const Event* last) {
+      // Recycled blocks first, new ones while the ring is not saturated
+      if (!free_blocks.try_pop(block))
+      {
+        if (number_allocated < blocks.capacity())
+        {
+          block = StdVector<Event>();
+          ++number_allocated;
+        }
+        else if (!free_blocks.pop(block))
+        {
+          throw Stopped();
+        }
+      }
+      block.assign(first, last);
+      if (!blocks.push(block))
+      {
+        throw Stopped();
+      }
+    });
+    blocks.close();
+  };
+
+  auto run_estimator = [&]() {
+    std::size_t number_allocated = 0;
+    auto segmenter = make_adaptive_segmenter<Event>(
+        t_decay_first, weight_thresh, [&](Span<const Event> batch) {
+          StdVector<Event> buffer;
+          if (!free_batches.try_pop(buffer))
+          {
+            if (number_allocated < batches.capacity())
+            {
+              ++number_allocated;
+            }
+            else if (!free_batches.pop(buffer))
+            {
+              throw Stopped();
+            }
+          }
+          buffer.assign(batch.begin(), batch.end());
+          if (!batches.push(buffer))
+          {
+            throw Stopped();
+          }
+        },
+        0, options.limits);
+    StdVector<Event> block;
+    while (blocks.pop(block))
+    {
+      segmenter(block.data(), block.data() + block.size());
+      // At most capacity blocks exist, so the ring is never full
+      free_blocks.try_push(block);
+    }
+    if (!segmenter.batch().empty())
+    {
+      StdVector<Event> buffer(segmenter.batch().begin(),
+                              segmenter.batch().end());
+      if (!batches.push(buffer))
+      {
+        throw Stopped();
+      }
+    }
+    batches.close();
+  };
+
+  auto run_handle = [&]() {
+    StdVector<Event> batch;
+    while (batches.pop(batch))
+    {
+      handle_batch(Span<const Event>(batch.data(), batch.size()));
+      free_batches.try_push(batch);
+    }
+  };
+
+  std::thread source_thread([&]() { run_stage(run_source); });
+  std::thread estimator_thread([&]() { run_stage(run_estimator); });
+  std::thread handle_thread([&]() { run_stage(run_handle); });
+  const std::size_t number_cpus = options.cpus.size();
+  if (number_cpus > 0)
+  {
+    std::thread* threads[] = {&source_thread, &estimator_thread,
+                              &handle_thread};
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      const std::size_t cpu = options.cpus[i % number_cpus];
+      if (!pin_thread(*threads[i], cpu))
+      {
+        // Fails like a stage, so that the running stages stop
+        run_stage([&]() {
+          throw std::runtime_error("the pipeline thread cannot be pinned to "
+                                   "cpu " +
+                                   std::to_string(cpu));
+        });
+        break;
+      }
+    }
+  }
+  source_thread.join();
+  estimator_thread.join();
+  handle_thread.join();
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_PIPELINE_HPP
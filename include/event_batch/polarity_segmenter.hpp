@@ -0,0 +1,165 @@
+/**
+ * @file
+ * @brief Polarity-split decay and batch estimator implementation.
+ */
+
+#ifndef EVENT_BATCH_POLARITY_SEGMENTER_HPP
+#define EVENT_BATCH_POLARITY_SEGMENTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "event_batch/assert.hpp"
+#include "event_batch/event_block.hpp"
+#include "event_batch/keyed_segmenter.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Dispatcher of event_batch::PolaritySegmenter, whose keys are the
+ * polarities.
+ *
+ * Events whose polarity is not below the number of polarities have no key.
+ */
+class PolarityKeys
+{
+ public:
+  /**
+   * @brief Constructs a dispatcher for a number of polarities.
+   *
+   * @param number_polarities @copybrief number_polarities_
+   */
+  explicit PolarityKeys(const uint16_t number_polarities)
+      : number_polarities_(number_polarities)
+  {
+    ASSERT(number_polarities > 0, "The number of polarities must be positive");
+  }
+
+  /**
+   * @brief Returns the number of polarities.
+   *
+   * @return Number of polarities.
+   */
+  std::size_t
+  number_keys() const
+  {
+    return number_polarities_;
+  }
+
+  /**
+   * @brief Passes the polarity of an event to a push function, if in range.
+   *
+   * @tparam Event Type of event, either event_batch::Event or
+   * sepia::dvs_event.
+   * @tparam Push Type of the push function.
+   *
+   * @param event Incoming event.
+   * @param push Push function, called with the polarity.
+   */
+  template <typename Event, typename Push>
+  void
+  operator()(const Event& event, Push&& push) const
+  {
+    const std::size_t polarity = event_polarity(event);
+    if (polarity < number_polarities_)
+    {
+      push(polarity);
+    }
+  }
+
+ protected:
+  /**
+   * @brief Number of polarities, 2 for ON/OFF events.
+   */
+  std::size_t number_polarities_;
+};
+
+/**
+ * @brief Polarity-split decay and batch estimator.
+ *
+ * This class estimates an independent decay and ideal batch for each
+ * polarity with event_batch::KeyedSegmenter, in the same way as
+ * event_batch::AdaptiveSegmenter does for the whole stream, in a single pass
+ * over the events.
+ * The batches reach the handle already split, without copying the output of
+ * a global segmenter into per-polarity vectors afterwards.
+ *
+ * @tparam Event Type of event, either event_batch::Event or
+ * sepia::dvs_event.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch of a polarity, called with the polarity and a
+ * event_batch::Span<const Event>.
+ */
+template <typename Event, typename HandleBatch>
+class PolaritySegmenter
+    : public KeyedSegmenter<Event, PolarityKeys, HandleBatch>
+{
+ public:
+  /**
+   * @brief Constructs an instance to estimate the ideal batches of each
+   * polarity.
+   *
+   * @param number_polarities Number of polarities, 2 for ON/OFF events.
+   * @param t_decay_first Initial decay assumption to bootstrap the rate
+   * estimator of each polarity \f$[\text{microseconds}]\f$.
+   * @param weight_thresh Weight threshold that splits the batches.
+   * @param handle_batch Handle to further process the estimated batch of a
+   * polarity.
+   * @param limits Upper bounds on the batches of each polarity.
+   */
+  PolaritySegmenter(const uint16_t number_polarities,
+                    const uint64_t t_decay_first, const float weight_thresh,
+                    HandleBatch&& handle_batch,
+                    const BatchLimits& limits = BatchLimits())
+      : KeyedSegmenter<Event, PolarityKeys, HandleBatch>(
+            PolarityKeys(number_polarities), t_decay_first, weight_thresh,
+            std::forward<HandleBatch>(handle_batch), limits)
+  {
+  }
+
+  /**
+   * @brief Returns the number of polarities.
+   *
+   * @return Number of polarities.
+   */
+  std::size_t
+  number_polarities() const
+  {
+    return this->number_keys();
+  }
+};
+
+/**
+ * @brief Make function that creates an instance of
+ * event_batch::PolaritySegmenter.
+ *
+ * @tparam Event Type of event.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch of a polarity.
+ *
+ * @param number_polarities Number of polarities, 2 for ON/OFF events.
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator of each polarity \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param handle_batch Handle to further process the estimated batch of a
+ * polarity.
+ * @param limits Upper bounds on the batches of each polarity.
+ *
+ * @return Instance of event_batch::PolaritySegmenter.
+ */
+template <typename Event, typename HandleBatch>
+inline PolaritySegmenter<Event, HandleBatch>
+make_polarity_segmenter(const uint16_t number_polarities,
+                        const uint64_t t_decay_first, const float weight_thresh,
+                        HandleBatch&& handle_batch,
+                        const BatchLimits& limits = BatchLimits())
+{
+  return PolaritySegmenter<Event, HandleBatch>(
+      number_polarities, t_decay_first, weight_thresh,
+      std::forward<HandleBatch>(handle_batch), limits);
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_POLARITY_SEGMENTER_HPP
@@ -0,0 +1,200 @@
+/**
+ * @file
+ * @brief Multi-region decay and batch estimator implementation.
+ */
+
+#ifndef EVENT_BATCH_REGION_SEGMENTER_HPP
+#define EVENT_BATCH_REGION_SEGMENTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "event_batch/assert.hpp"
+#include "event_batch/keyed_segmenter.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Dispatcher of event_batch::RegionSegmenter, whose keys are the
+ * regions that contain an event.
+ *
+ * The regions crossing each row of the sensor are precomputed in a lookup
+ * table, so that an event is only tested against the regions of its row.
+ */
+class RegionKeys
+{
+ public:
+  /**
+   * @brief Precomputes the regions of each row of the sensor.
+   *
+   * @param height Height of the sensor.
+   * @param regions Regions of the sensor, clipped to its height.
+   */
+  RegionKeys(const uint16_t height, const StdVector<Region>& regions)
+      : regions_(regions), row_first_(static_cast<std::size_t>(height) + 1, 0)
+  {
+    for (std::size_t i = 0; i < regions.size(); ++i)
+    {
+      ASSERT(regions[i].left <= regions[i].right &&
+                 regions[i].bottom <= regions[i].top,
+             "Region " << i << " is inverted");
+    }
+
+    // Compressed rows: the regions of row y are
+    // row_regions_[row_first_[y], row_first_[y + 1])
+    for (std::size_t y = 0; y < height; ++y)
+    {
+      for (std::size_t i = 0; i < regions.size(); ++i)
+      {
+        if (y >= regions[i].bottom && y < regions[i].top)
+        {
+          row_regions_.push_back(static_cast<uint32_t>(i));
+        }
+      }
+      row_first_[y + 1] = static_cast<uint32_t>(row_regions_.size());
+    }
+  }
+
+  /**
+   * @brief Returns the number of regions.
+   *
+   * @return Number of regions.
+   */
+  std::size_t
+  number_keys() const
+  {
+    return regions_.size();
+  }
+
+  /**
+   * @brief Passes every region that contains an event to a push function.
+   *
+   * @tparam Event Type of event.
+   * @tparam Push Type of the push function.
+   *
+   * @param event Incoming event.
+   * @param push Push function, called with each region index in order.
+   */
+  template <typename Event, typename Push>
+  void
+  operator()(const Event& event, Push&& push) const
+  {
+    const uint16_t y = event.y;
+    if (y + static_cast<std::size_t>(1) >= row_first_.size())
+    {
+      return;
+    }
+    const uint16_t x = event.x;
+    for (uint32_t i = row_first_[y]; i < row_first_[y + 1]; ++i)
+    {
+      const uint32_t index = row_regions_[i];
+      if (x >= regions_[index].left && x < regions_[index].right)
+      {
+        push(index);
+      }
+    }
+  }
+
+ protected:
+  /**
+   * @brief Bounds of each region.
+   */
+  StdVector<Region> regions_;
+  /**
+   * @brief Position in event_batch::RegionKeys::row_regions_ of the first
+   * region of each row, followed by the total number of positions.
+   */
+  StdVector<uint32_t> row_first_;
+  /**
+   * @brief Indices of the regions crossing each row, row by row.
+   */
+  StdVector<uint32_t> row_regions_;
+};
+
+/**
+ * @brief Multi-region decay and batch estimator.
+ *
+ * This class estimates an independent decay and ideal batch for each of a
+ * list of possibly overlapping regions with event_batch::KeyedSegmenter, in
+ * the same way as event_batch::AdaptiveSegmenter does for a single cropped
+ * stream, but in a single pass over the events.
+ *
+ * @tparam Event Type of event.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch of a region, called with the region index and a
+ * event_batch::Span<const Event>.
+ */
+template <typename Event, typename HandleBatch>
+class RegionSegmenter : public KeyedSegmenter<Event, RegionKeys, HandleBatch>
+{
+ public:
+  /**
+   * @brief Constructs an instance to estimate the ideal batches of each
+   * region of the sensor.
+   *
+   * @param height Height of the sensor.
+   * @param regions Regions of the sensor, clipped to its height.
+   * @param t_decay_first Initial decay assumption to bootstrap the rate
+   * estimator of each region \f$[\text{microseconds}]\f$.
+   * @param weight_thresh Weight threshold that splits the batches.
+   * @param handle_batch Handle to further process the estimated batch of a
+   * region.
+   * @param limits Upper bounds on the batches of each region.
+   */
+  RegionSegmenter(const uint16_t height, const StdVector<Region>& regions,
+                  const uint64_t t_decay_first, const float weight_thresh,
+                  HandleBatch&& handle_batch,
+                  const BatchLimits& limits = BatchLimits())
+      : KeyedSegmenter<Event, RegionKeys, HandleBatch>(
+            RegionKeys(height, regions), t_decay_first, weight_thresh,
+            std::forward<HandleBatch>(handle_batch), limits)
+  {
+  }
+
+  /**
+   * @brief Returns the number of regions.
+   *
+   * @return Number of regions.
+   */
+  std::size_t
+  number_regions() const
+  {
+    return this->number_keys();
+  }
+};
+
+/**
+ * @brief Make function that creates an instance of
+ * event_batch::RegionSegmenter.
+ *
+ * @tparam Event Type of event.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch of a region.
+ *
+ * @param height Height of the sensor.
+ * @param regions Regions of the sensor, clipped to its height.
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator of each region \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param handle_batch Handle to further process the estimated batch of a
+ * region.
+ * @param limits Upper bounds on the batches of each region.
+ *
+ * @return Instance of event_batch::RegionSegmenter.
+ */
+template <typename Event, typename HandleBatch>
+inline RegionSegmenter<Event, HandleBatch>
+make_region_segmenter(const uint16_t height, const StdVector<Region>& regions,
+                      const uint64_t t_decay_first, const float weight_thresh,
+                      HandleBatch&& handle_batch,
+                      const BatchLimits& limits = BatchLimits())
+{
+  return RegionSegmenter<Event, HandleBatch>(
+      height, regions, t_decay_first, weight_thresh,
+      std::forward<HandleBatch>(handle_batch), limits);
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_REGION_SEGMENTER_HPP
@@ -0,0 +1,375 @@
+/**
+ * @file
+ * @brief Seekable Event Stream index with decay checkpoints.
+ */
+
+#ifndef EVENT_BATCH_SEEK_INDEX_HPP
+#define EVENT_BATCH_SEEK_INDEX_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "event_batch/decay_kernel.hpp"
+#include "event_batch/event_stream.hpp"
+#include "event_batch/little_endian.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Point of an Event Stream where the decoding and the decay estimation
+ * can resume.
+ */
+struct SeekPoint
+{
+  /**
+   * @brief Index of the next event.
+   */
+  uint64_t index;
+  /**
+   * @brief Offset of the next event byte from the first event byte.
+   */
+  uint64_t offset;
+  /**
+   * @brief Timestamp of the previous event, which the decoder starts from
+   * \f$[\text{microseconds}]\f$.
+   */
+  uint64_t t;
+  /**
+   * @brief Global decay after the previous event.
+   */
+  Decay decay;
+};
+
+/**
+ * @brief Seek points of an Event Stream at regular event intervals.
+ *
+ * The first seek point is always the start of the stream, so that every
+ * lookup succeeds.
+ */
+class SeekIndex
+{
+ public:
+  /**
+   * @brief Constructs an index from its seek points.
+   *
+   * @param t_decay_first @copybrief t_decay_first_
+   * @param points @copybrief points_
+   */
+  SeekIndex(const uint64_t t_decay_first, StdVector<SeekPoint>&& points)
+      : t_decay_first_(t_decay_first), points_(std::move(points))
+  {
+    if (points_.empty() || points_.front().index != 0)
+    {
+      throw std::runtime_error("the seek index must start at the first event");
+    }
+  }
+
+  /**
+   * @brief Returns the initial time decay the checkpoints were estimated with
+   * \f$[\text{microseconds}]\f$.
+   *
+   * @return Initial time decay \f$[\text{microseconds}]\f$.
+   */
+  uint64_t
+  t_decay_first() const
+  {
+    return t_decay_first_;
+  }
+
+  /**
+   * @brief Returns the seek points, sorted by event index.
+   *
+   * @return Seek points.
+   */
+  const StdVector<SeekPoint>&
+  points() const
+  {
+    return points_;
+  }
+
+  /**
+   * @brief Finds the last seek point at or before an event.
+   *
+   * @param index Index of the event.
+   *
+   * @return Seek point.
+   */
+  const SeekPoint&
+  find_index(const uint64_t index) const
+  {
+    const auto point = std::upper_bound(
+        points_.begin(), points_.end(), index,
+        [](const uint64_t i, const SeekPoint& p) { return i < p.index; });
+    return *std::prev(point);
+  }
+
+  /**
+   * @brief Finds the last seek point before the first event at or after a
+   * timestamp.
+   *
+   * @param t Timestamp \f$[\text{microseconds}]\f$.
+   *
+   * @return Seek point.
+   */
+  const SeekPoint&
+  find_time(const uint64_t t) const
+  {
+    const auto point = std::lower_bound(
+        points_.begin() + 1, points_.end(), t,
+        [](const SeekPoint& p, const uint64_t t) { return p.t < t; });
+    return *std::prev(point);
+  }
+
+ protected:
+  /**
+   * @brief Initial time rate assumption to bootstrap the rate estimator
+   * \f$[\text{microseconds}]\f$.
+   */
+  uint64_t t_decay_first_;
+  /**
+   * @brief Seek points, sorted by event index.
+   */
+  StdVector<SeekPoint> points_;
+};
+
+/**
+ * @brief Builds the seek index of a mapped DVS Event Stream.
+ *
+ * The stream is decoded once, and the global decay is estimated with the
+ * vectorized kernel as event_batch::GlobalDecay does on blocks of events.
+ *
+ * @param event_stream Mapped event stream.
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator \f$[\text{microseconds}]\f$.
+ * @param interval Number of events between two seek points.
+ *
+ * @return Seek index.
+ */
+inline SeekIndex
+build_seek_index(const MappedEventStream& event_stream,
+                 const uint64_t t_decay_first,
+                 const std::size_t interval = 65536)
+{
+  if (interval == 0)
+  {
+    throw std::runtime_error("the seek interval must be positive");
+  }
+  DvsDecoder decoder(event_stream.header().width,
+                     event_stream.header().height);
+  const DecayKernel kernel = best_decay_kernel();
+  Decay decay;
+  decay.reset(t_decay_first);
+  StdVector<SeekPoint> points;
+  StdVector<Event> block(std::min(interval, DecayLanes::capacity));
+  uint64_t t[DecayLanes::capacity];
+  DecayLanes lanes;
+  uint64_t index = 0;
+  const uint8_t* byte = event_stream.begin();
+  while (byte != event_stream.end())
+  {
+    if (index % interval == 0)
+    {
+      points.push_back({index,
+                        static_cast<uint64_t>(byte - event_stream.begin()),
+                        decoder.t(), decay});
+    }
+    // Blocks never straddle a seek point
+    const std::size_t size = std::min(
+        block.size(), static_cast<std::size_t>(interval - index % interval));
+    const uint8_t* const byte_first = byte;
+    const Event* const last = decoder(byte, event_stream.end(), block.data(),
+                                      block.data() + size);
+    const std::size_t number_events =
+        static_cast<std::size_t>(last - block.data());
+    for (std::size_t i = 0; i < number_events; ++i)
+    {
+      t[i] = block[i].t;
+    }
+    if (!decay_timestamps(decay, t, number_events, lanes, kernel))
+    {
+      for (std::size_t i = 0; i < number_events; ++i)
+      {
+        decay.update(t[i]);
+      }
+    }
+    index += number_events;
+    if (byte == byte_first)
+    {
+      break;
+    }
+  }
+  if (points.empty())
+  {
+    points.push_back({0, 0, 0, decay});
+  }
+  return SeekIndex(t_decay_first, std::move(points));
+}
+
+/// \cond
+namespace seek_index
+{
+/**
+ * @brief Signature at the beginning of a seek index file.
+ */
+constexpr char signature[] = "Event Stream Index";
+/**
+ * @brief Size of the signature in bytes.
+ */
+constexpr std::size_t signature_size = sizeof(signature) - 1;
+/**
+ * @brief Size of the header (signature, version and initial time decay) in
+ * bytes.
+ */
+constexpr std::size_t header_size = signature_size + 3 + sizeof(uint64_t);
+/**
+ * @brief Size of an encoded event_batch::SeekPoint in bytes.
+ */
+constexpr std::size_t point_size =
+    3 * sizeof(uint64_t) + little_endian::decay_size;
+}  // namespace seek_index
+/// \endcond
+
+/**
+ * @brief Writes a seek index to a sidecar file.
+ *
+ * The file starts with the signature "Event Stream Index", a three-byte
+ * version and the initial time decay, followed by one fixed-size
+ * little-endian record per seek point.
+ *
+ * @param index Seek index.
+ * @param filename Name of the seek index file.
+ */
+inline void
+write_seek_index(const SeekIndex& index, const std::string& filename)
+{
+  StdVector<uint8_t> bytes(seek_index::header_size +
+                           index.points().size() * seek_index::point_size);
+  uint8_t* byte = bytes.data();
+  std::memcpy(byte, seek_index::signature, seek_index::signature_size);
+  byte += seek_index::signature_size;
+  *(byte++) = 1;
+  *(byte++) = 0;
+  *(byte++) = 0;
+  byte = little_endian::encode(byte, index.t_decay_first());
+  for (const SeekPoint& point : index.points())
+  {
+    byte = little_endian::encode(byte, point.index);
+    byte = little_endian::encode(byte, point.offset);
+    byte = little_endian::encode(byte, point.t);
+    byte = little_endian::encode(byte, point.decay);
+  }
+
+  std::ofstream file(filename, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(bytes.data()),
+             static_cast<std::streamsize>(bytes.size()));
+  if (!file)
+  {
+    throw std::runtime_error("unwritable file '" + filename + "'");
+  }
+}
+
+/**
+ * @brief Reads a seek index from a sidecar file.
+ *
+ * @param filename Name of the seek index file.
+ *
+ * @return Seek index.
+ */
+inline SeekIndex
+read_seek_index(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if (!file)
+  {
+    throw std::runtime_error("unreadable file '" + filename + "'");
+  }
+  const StdVector<uint8_t> bytes((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+  if (bytes.size() < seek_index::header_size ||
+      std::memcmp(bytes.data(), seek_index::signature,
+                  seek_index::signature_size) != 0)
+  {
+    throw std::runtime_error("'" + filename + "' is not a seek index file");
+  }
+  if (bytes[seek_index::signature_size] != 1)
+  {
+    throw std::runtime_error("unsupported seek index version in '" +
+                             filename + "'");
+  }
+  if ((bytes.size() - seek_index::header_size) % seek_index::point_size != 0)
+  {
+    throw std::runtime_error("truncated record in '" + filename + "'");
+  }
+
+  const uint8_t* byte = bytes.data() + seek_index::signature_size + 3;
+  uint64_t t_decay_first;
+  byte = little_endian::decode(byte, t_decay_first);
+  StdVector<SeekPoint> points(
+      (bytes.size() - seek_index::header_size) / seek_index::point_size);
+  for (SeekPoint& point : points)
+  {
+    byte = little_endian::decode(byte, point.index);
+    byte = little_endian::decode(byte, point.offset);
+    byte = little_endian::decode(byte, point.t);
+    byte = little_endian::decode(byte, point.decay);
+  }
+  return SeekIndex(t_decay_first, std::move(points));
+}
+
+/**
+ * @brief Decodes a mapped DVS Event Stream in blocks of events from a seek
+ * point.
+ *
+ * The estimators are resumed with their \p reset overload taking the decay
+ * of the seek point, e.g. event_batch::AdaptiveSegmenter::reset.
+ *
+ * @tparam HandleBlock Type of the handle to further process each block of
+ * events.
+ *
+ * @param event_stream Mapped event stream the seek point belongs to.
+ * @param point Seek point.
+ * @param handle_block Handle to further process each block of events.
+ * @param block_size Maximum number of events per block.
+ */
+template <typename HandleBlock>
+inline void
+for_each_block_from(const MappedEventStream& event_stream,
+                    const SeekPoint& point, HandleBlock&& handle_block,
+                    const std::size_t block_size = 4096)
+{
+  if (point.offset > static_cast<uint64_t>(event_stream.end() -
+                                           event_stream.begin()))
+  {
+    throw std::runtime_error("the seek point is past the end of the stream");
+  }
+  DvsDecoder decoder(event_stream.header().width,
+                     event_stream.header().height, point.t);
+  StdVector<Event> block(block_size);
+  const uint8_t* byte = event_stream.begin() + point.offset;
+  while (byte != event_stream.end())
+  {
+    const uint8_t* const byte_first = byte;
+    Event* const last = decoder(byte, event_stream.end(), block.data(),
+                                block.data() + block.size());
+    if (last != block.data())
+    {
+      handle_block(static_cast<const Event*>(block.data()),
+                   static_cast<const Event*>(last));
+    }
+    if (byte == byte_first)
+    {
+      break;
+    }
+  }
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_SEEK_INDEX_HPP
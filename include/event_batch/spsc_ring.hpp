@@ -0,0 +1,290 @@
+/**
+ * @file
+ * @brief Lock-free single-producer single-consumer ring buffer
+ * implementation.
+ */
+
+#ifndef EVENT_BATCH_SPSC_RING_HPP
+#define EVENT_BATCH_SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+#include "event_batch/types.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace event_batch
+{
+/**
+ * @brief Lock-free single-producer single-consumer ring buffer.
+ *
+ * This class passes elements from one producer thread to one consumer thread
+ * without locks: each side owns one index, which it publishes with release
+ * semantics and the other side reads with acquire semantics.
+ * Both indices live in their own cache line, next to a private copy of the
+ * other index, so that a side only reads the shared index of the other one
+ * when its copy says the ring is full (producer) or empty (consumer).
+ * Elements are moved in and out of preallocated slots, so moving a
+ * std::vector through the ring passes its storage without copying events.
+ * The ring can be closed by either side: the consumer then drains the
+ * remaining elements, and blocking pushes fail.
+ *
+ * @tparam T Type of element.
+ */
+template <typename T>
+class SpscRing
+{
+ public:
+  /**
+   * @brief Constructs an empty ring.
+   *
+   * @param capacity Minimum number of elements the ring holds, rounded up to
+   * a power of two.
+   */
+  explicit SpscRing(const std::size_t capacity)
+  {
+    std::size_t size = 2;
+    while (size < capacity)
+    {
+      size *= 2;
+    }
+    slots_.resize(size);
+    mask_ = size - 1;
+  }
+  /**
+   * @brief Deleted copy constructor.
+   */
+  SpscRing(const SpscRing&) = delete;
+  /**
+   * @brief Deleted move constructor, the indices are shared with the other
+   * thread.
+   */
+  SpscRing(SpscRing&&) = delete;
+  /**
+   * @brief Deleted copy assignment operator.
+   */
+  SpscRing&
+  operator=(const SpscRing&) = delete;
+  /**
+   * @brief Deleted move assignment operator.
+   */
+  SpscRing&
+  operator=(SpscRing&&) = delete;
+  /**
+   * @brief Default destructor.
+   */
+  ~SpscRing() = default;
+
+  /**
+   * @brief Returns the number of elements the ring holds.
+   *
+   * @return Capacity of the ring.
+   */
+  std::size_t
+  capacity() const
+  {
+    return slots_.size();
+  }
+
+  /**
+   * @brief Moves an element into the ring if it is not full.
+   *
+   * Only the producer thread may call this method.
+   *
+   * @param value Element to move, left untouched if the ring is full.
+   *
+   * @return True if the element was pushed, false if the ring is full.
+   */
+  bool
+  try_push(T& value)
+  {
+    const std::size_t tail = producer_.index.load(std::memory_order_relaxed);
+    if (tail - producer_.other_index == slots_.size())
+    {
+      producer_.other_index =
+          consumer_.index.load(std::memory_order_acquire);
+      if (tail - producer_.other_index == slots_.size())
+      {
+        return false;
+      }
+    }
+    slots_[tail & mask_] = std::move(value);
+    producer_.index.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Moves an element out of the ring if it is not empty.
+   *
+   * Only the consumer thread may call this method.
+   *
+   * @param value Destination of the element, left untouched if the ring is
+   * empty.
+   *
+   * @return True if an element was popped, false if the ring is empty.
+   */
+  bool
+  try_pop(T& value)
+  {
+    const std::size_t head = consumer_.index.load(std::memory_order_relaxed);
+    if (head == consumer_.other_index)
+    {
+      consumer_.other_index =
+          producer_.index.load(std::memory_order_acquire);
+      if (head == consumer_.other_index)
+      {
+        return false;
+      }
+    }
+    value = std::move(slots_[head & mask_]);
+    consumer_.index.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Moves an element into the ring, waiting while it is full.
+   *
+   * Only the producer thread may call this method.
+   *
+   * @param value Element to move.
+   *
+   * @return True if the element was pushed, false if the ring was closed.
+   */
+  bool
+  push(T& value)
+  {
+    while (!try_push(value))
+    {
+      if (closed())
+      {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+  /**
+   * @brief Moves an element out of the ring, waiting while it is empty.
+   *
+   * Only the consumer thread may call this method.
+   *
+   * @param value Destination of the element.
+   *
+   * @return True if an element was popped, false if the ring is closed and
+   * drained.
+   */
+  bool
+  pop(T& value)
+  {
+    while (!try_pop(value))
+    {
+      if (closed())
+      {
+        // Elements pushed before the close are still delivered
+        return try_pop(value);
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+  /**
+   * @brief Closes the ring, so that waiting calls return.
+   */
+  void
+  close()
+  {
+    closed_.store(true, std::memory_order_release);
+  }
+
+  /**
+   * @brief Checks whether the ring was closed.
+   *
+   * @return True if the ring was closed, false otherwise.
+   */
+  bool
+  closed() const
+  {
+    return closed_.load(std::memory_order_acquire);
+  }
+
+ protected:
+  /**
+   * @brief Index owned by one side, with its copy of the index of the other
+   * side.
+   */
+  struct alignas(64) Side
+  {
+    /**
+     * @brief Number of elements pushed (producer) or popped (consumer).
+     */
+    std::atomic<std::size_t> index{0};
+    /**
+     * @brief Last value read from the index of the other side.
+     */
+    std::size_t other_index = 0;
+  };
+
+  /**
+   * @brief Producer side.
+   */
+  Side producer_;
+  /**
+   * @brief Consumer side.
+   */
+  Side consumer_;
+  /**
+   * @brief Whether the ring was closed.
+   */
+  alignas(64) std::atomic<bool> closed_{false};
+
+  /**
+   * @brief Storage of the elements.
+   */
+  StdVector<T> slots_;
+  /**
+   * @brief Mask that wraps an index into the storage.
+   */
+  std::size_t mask_;
+};
+
+/**
+ * @brief Pins a thread to a core.
+ *
+ * This function is a no-op on systems without thread affinity support.
+ *
+ * @param thread Thread to pin.
+ * @param cpu Index of the core.
+ *
+ * @return True if the thread was pinned, false otherwise (e.g. if the core
+ * does not exist or is outside the affinity mask of the process).
+ */
+inline bool
+pin_thread(std::thread& thread, const std::size_t cpu)
+{
+#ifdef __linux__
+  if (cpu >= CPU_SETSIZE)
+  {
+    return false;
+  }
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  return pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t),
+                                &cpus) == 0;
+#else
+  (void)thread;
+  (void)cpu;
+  return false;
+#endif
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_SPSC_RING_HPP
@@ -11,6 +11,7 @@
 #include <string>
 
 #include "event_batch/event_stream_statistics.hpp"
+#include "event_batch/tictoc.hpp"
 #include "event_batch/types.hpp"
 #include "sepia.hpp"
 
@@ -80,6 +81,36 @@ stream_statistics_from_file(const std::string& filename)
   return stream_statistics;
 }
 
+/**
+ * @brief Make function that creates an event_batch::EventStreamStatistics
+ * instance that stores its statistics.
+ *
+ * This function is a convenience to compute the basic statistics of an event
+ * stream along with another pipeline, instead of decoding the event stream
+ * twice with \ref stream_statistics_from_file.
+ *
+ * @tparam Event Type of event.
+ *
+ * @param stream_statistics Storage of the computed statistics, which must
+ * outlive the returned instance.
+ *
+ * @return Instance of event_batch::EventStreamStatistics.
+ */
+template <typename Event>
+inline auto
+make_stream_statistics_tap(StreamStatistics& stream_statistics)
+{
+  stream_statistics = {0, 0, 0, 0};
+  return make_event_stream_statistics<Event>(
+      [](const Event& event, uint64_t t_first, uint64_t number_events,
+         uint64_t duration) -> StreamStatistics {
+        return {event.t, t_first, number_events, duration};
+      },
+      [&stream_statistics](StreamStatistics statistics) {
+        stream_statistics = statistics;
+      });
+}
+
 /**
  * @brief Displays runtime statistics.
  *
@@ -99,6 +130,76 @@ display_runtime_statistics(const double t_diff,
   std::cout << "real-time factor: " << stream_statistics.duration / t_diff
             << " (>1 means real-time)\n";
 }
+
+/**
+ * @brief Displays runtime statistics and hardware counter statistics.
+ *
+ * The counts per event, the instructions per cycle and the miss rates are
+ * only displayed for the events that could be counted.
+ *
+ * @param t_diff Elapsed computation time \f$[\text{microseconds}]\f$.
+ * @param stream_statistics Stream statistics \sa StreamStatistics.
+ * @param counts Hardware event counts \sa HardwareCounts.
+ */
+inline void
+display_runtime_statistics(const double t_diff,
+                           const StreamStatistics& stream_statistics,
+                           const HardwareCounts& counts)
+{
+  display_runtime_statistics(t_diff, stream_statistics);
+  const double number_events =
+      static_cast<double>(stream_statistics.number_events);
+  const auto per_event = [&](const HardwareEvent event) {
+    return static_cast<double>(counts[event]) / number_events;
+  };
+  if (counts.has(HardwareEvent::cycles))
+  {
+    std::cout << "cycles per event: " << per_event(HardwareEvent::cycles)
+              << '\n';
+  }
+  if (counts.has(HardwareEvent::instructions))
+  {
+    std::cout << "instructions per event: "
+              << per_event(HardwareEvent::instructions) << '\n';
+  }
+  if (counts.has(HardwareEvent::cycles) &&
+      counts.has(HardwareEvent::instructions))
+  {
+    std::cout << "instructions per cycle: "
+              << static_cast<double>(counts[HardwareEvent::instructions]) /
+                     static_cast<double>(counts[HardwareEvent::cycles])
+              << '\n';
+  }
+  if (counts.has(HardwareEvent::cache_misses))
+  {
+    std::cout << "cache misses per event: "
+              << per_event(HardwareEvent::cache_misses) << '\n';
+  }
+  if (counts.has(HardwareEvent::branch_misses))
+  {
+    std::cout << "branch misses per event: "
+              << per_event(HardwareEvent::branch_misses) << '\n';
+  }
+  if (counts.has(HardwareEvent::instructions))
+  {
+    if (counts.has(HardwareEvent::cache_misses))
+    {
+      std::cout << "cache misses per kilo-instruction: "
+                << 1e3 * static_cast<double>(
+                             counts[HardwareEvent::cache_misses]) /
+                       static_cast<double>(counts[HardwareEvent::instructions])
+                << '\n';
+    }
+    if (counts.has(HardwareEvent::branch_misses))
+    {
+      std::cout << "branch misses per kilo-instruction: "
+                << 1e3 * static_cast<double>(
+                             counts[HardwareEvent::branch_misses]) /
+                       static_cast<double>(counts[HardwareEvent::instructions])
+                << '\n';
+    }
+  }
+}
 }  // namespace event_batch
 
 #endif  // EVENT_BATCH_STREAM_STATISTICS_HPP
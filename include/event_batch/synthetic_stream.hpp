@@ -0,0 +1,565 @@
+/**
+ * @file
+ * @brief Synthetic event stream generators.
+ */
+
+#ifndef EVENT_BATCH_SYNTHETIC_STREAM_HPP
+#define EVENT_BATCH_SYNTHETIC_STREAM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Activity profile of a synthetic event stream.
+ */
+enum class StreamProfile
+{
+  /**
+   * @brief Events evenly spaced in time at the base rate.
+   */
+  constant,
+  /**
+   * @brief Poisson events at the base rate.
+   */
+  poisson,
+  /**
+   * @brief Sensor-wide Poisson bursts at the peak rate during the first
+   * fraction of each period, and the base rate otherwise.
+   */
+  bursty,
+  /**
+   * @brief Poisson events whose rate steps between the base rate and the
+   * peak rate every period.
+   */
+  step,
+  /**
+   * @brief Poisson events whose rate oscillates between the base rate and the
+   * peak rate with the given period.
+   */
+  sinusoid
+};
+
+/**
+ * @brief Returns the name of an activity profile.
+ *
+ * @param profile Activity profile.
+ *
+ * @return Name of the profile.
+ */
+inline const char*
+stream_profile_name(const StreamProfile profile)
+{
+  switch (profile)
+  {
+    case StreamProfile::constant:
+      return "constant";
+    case StreamProfile::poisson:
+      return "poisson";
+    case StreamProfile::bursty:
+      return "bursty";
+    case StreamProfile::step:
+      return "step";
+    case StreamProfile::sinusoid:
+      return "sinusoid";
+  }
+  return "";
+}
+
+/**
+ * @brief Parses the name of an activity profile.
+ *
+ * @param name Name of the profile, as returned by
+ * event_batch::stream_profile_name.
+ *
+ * @return Activity profile.
+ */
+inline StreamProfile
+parse_stream_profile(const std::string& name)
+{
+  for (const StreamProfile profile :
+       {StreamProfile::constant, StreamProfile::poisson, StreamProfile::bursty,
+        StreamProfile::step, StreamProfile::sinusoid})
+  {
+    if (name == stream_profile_name(profile))
+    {
+      return profile;
+    }
+  }
+  throw std::runtime_error("unknown stream profile '" + name + "'");
+}
+
+/**
+ * @brief Parameters of a synthetic event stream.
+ */
+struct SyntheticStreamParameters
+{
+  /**
+   * @brief Activity profile.
+   */
+  StreamProfile profile = StreamProfile::poisson;
+  /**
+   * @brief Base rate of the activity \f$[\text{events}/\text{seconds}]\f$.
+   */
+  double rate = 1e6;
+  /**
+   * @brief Peak rate of the activity of the bursty, step and sinusoid
+   * profiles \f$[\text{events}/\text{seconds}]\f$.
+   */
+  double rate_peak = 1e7;
+  /**
+   * @brief Period of the bursty, step and sinusoid profiles
+   * \f$[\text{microseconds}]\f$.
+   */
+  double period = 100000;
+  /**
+   * @brief Fraction of the period spent in a burst.
+   */
+  double duty_cycle = 0.1;
+  /**
+   * @brief Number of hot pixels, which fire independently of the activity.
+   */
+  std::size_t hot_pixels = 0;
+  /**
+   * @brief Rate of each hot pixel \f$[\text{events}/\text{seconds}]\f$.
+   */
+  double hot_pixel_rate = 0;
+  /**
+   * @brief Width of the sensor.
+   */
+  uint16_t width = 320;
+  /**
+   * @brief Height of the sensor.
+   */
+  uint16_t height = 240;
+  /**
+   * @brief Seed of the random generator.
+   */
+  uint64_t seed = 0;
+};
+
+/**
+ * @brief Generator of a synthetic event stream with a known rate.
+ *
+ * The activity is spread uniformly over the sensor, with uniform polarities,
+ * and the hot pixels add independent Poisson events at fixed random pixels.
+ * Events are generated on demand, so that streams of any length can be
+ * produced in constant memory, and the stream is reproducible for a given
+ * seed.
+ */
+class SyntheticStreamGenerator
+{
+ public:
+  /**
+   * @brief Constructs a generator.
+   *
+   * @param parameters @copybrief parameters_
+   */
+  explicit SyntheticStreamGenerator(
+      const SyntheticStreamParameters& parameters)
+      : parameters_(parameters),
+        generator_(parameters.seed),
+        x_distribution_(0, static_cast<uint16_t>(parameters.width - 1)),
+        y_distribution_(0, static_cast<uint16_t>(parameters.height - 1)),
+        p_distribution_(0, 1),
+        t_activity_(0),
+        t_hot_pixel_(0),
+        number_events_(0)
+  {
+    if (!(parameters_.rate >= 0) || !(parameters_.rate_peak >= 0) ||
+        !(parameters_.hot_pixel_rate >= 0) || parameters_.width == 0 ||
+        parameters_.height == 0)
+    {
+      throw std::runtime_error(
+          "the rates must be non-negative and the size of the sensor "
+          "positive");
+    }
+    if (parameters_.profile != StreamProfile::constant &&
+        parameters_.profile != StreamProfile::poisson &&
+        (!(parameters_.period > 0) || !(parameters_.duty_cycle >= 0) ||
+         !(parameters_.duty_cycle <= 1)))
+    {
+      throw std::runtime_error(
+          "the period must be positive and the duty cycle in [0, 1]");
+    }
+    if (mean_rate() <= 0)
+    {
+      throw std::runtime_error("the stream must have a positive rate");
+    }
+    hot_pixels_.reserve(parameters_.hot_pixels);
+    for (std::size_t i = 0; i < parameters_.hot_pixels; ++i)
+    {
+      hot_pixels_.push_back(
+          {0, x_distribution_(generator_), y_distribution_(generator_), 0});
+    }
+    t_activity_ = next_activity(0, true);
+    t_hot_pixel_ = next_hot_pixel(0);
+  }
+
+  /**
+   * @brief Returns the parameters of the stream.
+   *
+   * @return Parameters of the stream.
+   */
+  const SyntheticStreamParameters&
+  parameters() const
+  {
+    return parameters_;
+  }
+
+  /**
+   * @brief Returns the number of events generated so far.
+   *
+   * @return Number of events.
+   */
+  uint64_t
+  number_events() const
+  {
+    return number_events_;
+  }
+
+  /**
+   * @brief Returns the ground-truth rate of the stream, including the hot
+   * pixels.
+   *
+   * @param t Time \f$[\text{microseconds}]\f$.
+   *
+   * @return Rate at \p t \f$[\text{events}/\text{seconds}]\f$.
+   */
+  double
+  rate(const double t) const
+  {
+    return activity_rate(t) + hot_pixel_rate();
+  }
+
+  /**
+   * @brief Returns the mean ground-truth rate of the stream over a period,
+   * including the hot pixels.
+   *
+   * @return Mean rate \f$[\text{events}/\text{seconds}]\f$.
+   */
+  double
+  mean_rate() const
+  {
+    const SyntheticStreamParameters& p = parameters_;
+    double activity = p.rate;
+    switch (p.profile)
+    {
+      case StreamProfile::constant:
+      case StreamProfile::poisson:
+        break;
+      case StreamProfile::bursty:
+        activity = p.duty_cycle * p.rate_peak + (1 - p.duty_cycle) * p.rate;
+        break;
+      case StreamProfile::step:
+      case StreamProfile::sinusoid:
+        activity = (p.rate + p.rate_peak) / 2;
+        break;
+    }
+    return activity + hot_pixel_rate();
+  }
+
+  /**
+   * @brief Generates the next event.
+   *
+   * @return Next event.
+   */
+  Event
+  operator()()
+  {
+    ++number_events_;
+    if (t_hot_pixel_ < t_activity_)
+    {
+      const double t = t_hot_pixel_;
+      t_hot_pixel_ = next_hot_pixel(t);
+      std::uniform_int_distribution<std::size_t> pixel(0,
+                                                       hot_pixels_.size() - 1);
+      Event event = hot_pixels_[pixel(generator_)];
+      event.t = static_cast<uint64_t>(t);
+      event.p = p_distribution_(generator_);
+      return event;
+    }
+    const double t = t_activity_;
+    t_activity_ = next_activity(t, false);
+    return {static_cast<uint64_t>(t), x_distribution_(generator_),
+            y_distribution_(generator_), p_distribution_(generator_)};
+  }
+
+  /**
+   * @brief Generates the next events.
+   *
+   * @param first Pointer to the first output event.
+   * @param last Pointer to one past the last output event.
+   */
+  void
+  operator()(Event* first, Event* last)
+  {
+    for (; first != last; ++first)
+    {
+      *first = operator()();
+    }
+  }
+
+ protected:
+  /**
+   * @brief Returns the rate of the activity, without the hot pixels.
+   *
+   * @param t Time \f$[\text{microseconds}]\f$.
+   *
+   * @return Rate \f$[\text{events}/\text{seconds}]\f$.
+   */
+  double
+  activity_rate(const double t) const
+  {
+    const SyntheticStreamParameters& p = parameters_;
+    switch (p.profile)
+    {
+      case StreamProfile::constant:
+      case StreamProfile::poisson:
+        return p.rate;
+      case StreamProfile::bursty:
+        return (std::fmod(t, p.period) < p.duty_cycle * p.period) ? p.rate_peak
+                                                                  : p.rate;
+      case StreamProfile::step:
+        return (std::fmod(t, 2 * p.period) < p.period) ? p.rate : p.rate_peak;
+      case StreamProfile::sinusoid:
+        return p.rate + (p.rate_peak - p.rate) *
+                            (1 - std::cos(2 * M_PI * t / p.period)) / 2;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Returns the total rate of the hot pixels.
+   *
+   * @return Rate \f$[\text{events}/\text{seconds}]\f$.
+   */
+  double
+  hot_pixel_rate() const
+  {
+    return static_cast<double>(parameters_.hot_pixels) *
+           parameters_.hot_pixel_rate;
+  }
+
+  /**
+   * @brief Returns the end of the piecewise-constant segment of the activity
+   * rate that contains a time.
+   *
+   * @param t Time \f$[\text{microseconds}]\f$.
+   *
+   * @return End of the segment \f$[\text{microseconds}]\f$.
+   */
+  double
+  segment_end(const double t) const
+  {
+    const SyntheticStreamParameters& p = parameters_;
+    if (p.profile == StreamProfile::step)
+    {
+      return (std::floor(t / p.period) + 1) * p.period;
+    }
+    const double t_period = std::floor(t / p.period) * p.period;
+    const double t_burst = t_period + p.duty_cycle * p.period;
+    return (t < t_burst) ? t_burst : t_period + p.period;
+  }
+
+  /**
+   * @brief Returns the time of the next activity event.
+   *
+   * Piecewise-constant rates are sampled exactly segment by segment, and the
+   * sinusoid by thinning.
+   *
+   * @param t Time of the previous activity event \f$[\text{microseconds}]\f$.
+   * @param first Whether no activity event was generated yet.
+   *
+   * @return Time of the next activity event \f$[\text{microseconds}]\f$, or
+   * infinity without activity.
+   */
+  double
+  next_activity(double t, const bool first)
+  {
+    const SyntheticStreamParameters& p = parameters_;
+    switch (p.profile)
+    {
+      case StreamProfile::constant:
+        if (p.rate <= 0)
+        {
+          return HUGE_VAL;
+        }
+        return first ? 0 : t + 1e6 / p.rate;
+      case StreamProfile::poisson:
+        return (p.rate > 0) ? t + exponential(p.rate) : HUGE_VAL;
+      case StreamProfile::bursty:
+      case StreamProfile::step:
+        for (;;)
+        {
+          const double t_end = segment_end(t);
+          const double r = activity_rate(t);
+          if (r > 0)
+          {
+            const double t_next = t + exponential(r);
+            if (t_next < t_end)
+            {
+              return t_next;
+            }
+          }
+          // Poisson arrivals are memoryless, so sampling restarts at the end
+          // of the segment
+          t = t_end;
+        }
+      case StreamProfile::sinusoid:
+      {
+        const double r_max = std::max(p.rate, p.rate_peak);
+        std::uniform_real_distribution<double> accept(0, r_max);
+        for (;;)
+        {
+          t += exponential(r_max);
+          if (accept(generator_) < activity_rate(t))
+          {
+            return t;
+          }
+        }
+      }
+    }
+    return HUGE_VAL;
+  }
+
+  /**
+   * @brief Returns the time of the next hot pixel event.
+   *
+   * @param t Time of the previous hot pixel event
+   * \f$[\text{microseconds}]\f$.
+   *
+   * @return Time of the next hot pixel event \f$[\text{microseconds}]\f$, or
+   * infinity without hot pixels.
+   */
+  double
+  next_hot_pixel(const double t)
+  {
+    const double r = hot_pixel_rate();
+    return (r > 0) ? t + exponential(r) : HUGE_VAL;
+  }
+
+  /**
+   * @brief Draws a Poisson inter-arrival time.
+   *
+   * @param r Rate \f$[\text{events}/\text{seconds}]\f$.
+   *
+   * @return Inter-arrival time \f$[\text{microseconds}]\f$.
+   */
+  double
+  exponential(const double r)
+  {
+    return std::exponential_distribution<double>(1e-6 * r)(generator_);
+  }
+
+  /**
+   * @brief Parameters of the stream.
+   */
+  SyntheticStreamParameters parameters_;
+  /**
+   * @brief Random generator.
+   */
+  std::mt19937_64 generator_;
+  /**
+   * @brief Distribution of the horizontal coordinates.
+   */
+  std::uniform_int_distribution<uint16_t> x_distribution_;
+  /**
+   * @brief Distribution of the vertical coordinates.
+   */
+  std::uniform_int_distribution<uint16_t> y_distribution_;
+  /**
+   * @brief Distribution of the polarities.
+   */
+  std::uniform_int_distribution<uint16_t> p_distribution_;
+  /**
+   * @brief Pixels of the hot pixels.
+   */
+  StdVector<Event> hot_pixels_;
+  /**
+   * @brief Time of the next activity event \f$[\text{microseconds}]\f$.
+   */
+  double t_activity_;
+  /**
+   * @brief Time of the next hot pixel event \f$[\text{microseconds}]\f$.
+   */
+  double t_hot_pixel_;
+  /**
+   * @brief Number of events generated so far.
+   */
+  uint64_t number_events_;
+};
+
+/**
+ * @brief Generates a synthetic event stream in memory.
+ *
+ * @param parameters Parameters of the stream.
+ * @param number_events Number of events.
+ *
+ * @return Events sorted by timestamp.
+ */
+inline StdVector<Event>
+make_synthetic_stream(const SyntheticStreamParameters& parameters,
+                      const std::size_t number_events)
+{
+  SyntheticStreamGenerator generator(parameters);
+  StdVector<Event> events(number_events);
+  generator(events.data(), events.data() + events.size());
+  return events;
+}
+
+/**
+ * @brief Generates a synthetic event stream in memory with a mean rate.
+ *
+ * The bursty profile has bursts at ten times the mean rate, separated by
+ * silences, every thousand events on average.
+ * The step and sinusoid profiles vary between half and one and a half times
+ * the mean rate, with the same period.
+ *
+ * @param profile Activity profile.
+ * @param rate Mean event rate \f$[\text{events}/\text{seconds}]\f$.
+ * @param number_events Number of events.
+ * @param width Width of the sensor.
+ * @param height Height of the sensor.
+ * @param seed Seed of the random generator.
+ *
+ * @return Events sorted by timestamp.
+ */
+inline StdVector<Event>
+make_synthetic_stream(const StreamProfile profile, const double rate,
+                      const std::size_t number_events,
+                      const uint16_t width = 320, const uint16_t height = 240,
+                      const uint64_t seed = 0)
+{
+  SyntheticStreamParameters parameters;
+  parameters.profile = profile;
+  parameters.period = 1000 * 1e6 / rate;
+  parameters.width = width;
+  parameters.height = height;
+  parameters.seed = seed;
+  if (profile == StreamProfile::bursty)
+  {
+    parameters.rate = 0;
+    parameters.rate_peak = rate / parameters.duty_cycle;
+  }
+  else
+  {
+    parameters.rate = (profile == StreamProfile::constant ||
+                       profile == StreamProfile::poisson)
+                          ? rate
+                          : rate / 2;
+    parameters.rate_peak = 3 * rate / 2;
+  }
+  return make_synthetic_stream(parameters, number_events);
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_SYNTHETIC_STREAM_HPP
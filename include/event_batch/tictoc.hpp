@@ -1,12 +1,22 @@
 /**
  * @file
- * @brief Clock utility to estimate runtime.
+ * @brief Clock and hardware counter utilities to estimate runtime.
  */
 
 #ifndef EVENT_BATCH_TICTOC_HPP
 #define EVENT_BATCH_TICTOC_HPP
 
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <type_traits>
 
 namespace event_batch
@@ -95,6 +105,231 @@ class TicToc
    */
   Time t_;
 };
+
+/**
+ * @brief Hardware event counted by event_batch::HardwareCounters.
+ */
+enum class HardwareEvent
+{
+  /**
+   * @brief CPU cycles.
+   */
+  cycles,
+  /**
+   * @brief Retired instructions.
+   */
+  instructions,
+  /**
+   * @brief Last-level cache misses.
+   */
+  cache_misses,
+  /**
+   * @brief Mispredicted branches.
+   */
+  branch_misses
+};
+
+/**
+ * @brief Number of hardware events counted by event_batch::HardwareCounters.
+ */
+constexpr std::size_t number_hardware_events = 4;
+
+/**
+ * @brief Hardware event counts of a piece of code.
+ */
+struct HardwareCounts
+{
+  /**
+   * @brief Count of each event, scaled up when the counter was multiplexed.
+   */
+  std::array<uint64_t, number_hardware_events> counts{};
+  /**
+   * @brief Whether each event could be counted.
+   */
+  std::array<bool, number_hardware_events> available{};
+
+  /**
+   * @brief Returns whether an event could be counted.
+   *
+   * @param event Hardware event.
+   *
+   * @return Whether \p event could be counted.
+   */
+  bool
+  has(const HardwareEvent event) const
+  {
+    return available[static_cast<std::size_t>(event)];
+  }
+
+  /**
+   * @brief Returns the count of an event.
+   *
+   * @param event Hardware event.
+   *
+   * @return Count of \p event, 0 if it could not be counted.
+   */
+  uint64_t
+  operator[](const HardwareEvent event) const
+  {
+    return counts[static_cast<std::size_t>(event)];
+  }
+};
+
+/**
+ * @brief Hardware counter utility to profile a piece of code.
+ *
+ * This class complements event_batch::TicToc with the Linux perf_event_open
+ * counters of the calling thread and of the threads it creates afterwards.
+ * First, call \ref tic to reset and start the counters.
+ * Then, call \ref toc after the piece of code to get the counts.
+ * Each event is counted by its own counter, so that the events the CPU or the
+ * kernel does not support (e.g. in a virtual machine) are simply reported as
+ * unavailable, and no counter is available on other systems.
+ */
+class HardwareCounters
+{
+ public:
+  /**
+   * @brief Opens the counters.
+   *
+   * @param enabled Whether to open the counters, otherwise no counter is
+   * available and \ref tic and \ref toc do nothing.
+   */
+  explicit HardwareCounters(const bool enabled = true)
+  {
+    file_descriptors_.fill(-1);
+#ifdef __linux__
+    if (!enabled)
+    {
+      return;
+    }
+    constexpr uint64_t configs[number_hardware_events] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (std::size_t i = 0; i < number_hardware_events; ++i)
+    {
+      perf_event_attr attributes{};
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.size = sizeof(attributes);
+      attributes.config = configs[i];
+      attributes.disabled = 1;
+      attributes.inherit = 1;
+      attributes.exclude_kernel = 1;
+      attributes.exclude_hv = 1;
+      attributes.read_format =
+          PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      file_descriptors_[i] = static_cast<int>(
+          ::syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+#else
+    static_cast<void>(enabled);
+#endif
+  }
+  /**
+   * @brief Deleted copy constructor.
+   */
+  HardwareCounters(const HardwareCounters&) = delete;
+  /**
+   * @brief Deleted copy assignment operator.
+   */
+  HardwareCounters&
+  operator=(const HardwareCounters&) = delete;
+  /**
+   * @brief Closes the counters.
+   */
+  ~HardwareCounters()
+  {
+#ifdef __linux__
+    for (const int file_descriptor : file_descriptors_)
+    {
+      if (file_descriptor >= 0)
+      {
+        ::close(file_descriptor);
+      }
+    }
+#endif
+  }
+
+  /**
+   * @brief Returns whether at least one event can be counted.
+   *
+   * @return Whether at least one counter is open.
+   */
+  bool
+  available() const
+  {
+    for (const int file_descriptor : file_descriptors_)
+    {
+      if (file_descriptor >= 0)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Resets and starts the counters.
+   */
+  inline void
+  tic()
+  {
+#ifdef __linux__
+    for (const int file_descriptor : file_descriptors_)
+    {
+      if (file_descriptor >= 0)
+      {
+        ::ioctl(file_descriptor, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(file_descriptor, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  /**
+   * @brief Stops the counters and reads the counts since the previous
+   * \ref tic call.
+   *
+   * The threads created after \ref tic are only accounted for once they have
+   * exited.
+   *
+   * @return Hardware event counts.
+   */
+  inline HardwareCounts
+  toc()
+  {
+    HardwareCounts counts;
+#ifdef __linux__
+    for (std::size_t i = 0; i < number_hardware_events; ++i)
+    {
+      if (file_descriptors_[i] < 0)
+      {
+        continue;
+      }
+      ::ioctl(file_descriptors_[i], PERF_EVENT_IOC_DISABLE, 0);
+      // Count, time enabled and time running
+      uint64_t values[3];
+      if (::read(file_descriptors_[i], values, sizeof(values)) !=
+              static_cast<ssize_t>(sizeof(values)) ||
+          values[2] == 0)
+      {
+        continue;
+      }
+      counts.counts[i] = static_cast<uint64_t>(
+          static_cast<double>(values[0]) * static_cast<double>(values[1]) /
+          static_cast<double>(values[2]));
+      counts.available[i] = true;
+    }
+#endif
+    return counts;
+  }
+
+ protected:
+  /**
+   * @brief File descriptor of each counter, -1 if unavailable.
+   */
+  std::array<int, number_hardware_events> file_descriptors_;
+};
 }  // namespace event_batch
 
 #endif  // EVENT_BATCH_TICTOC_HPP
@@ -0,0 +1,280 @@
+/**
+ * @file
+ * @brief Spatially tiled decay and batch estimator implementation.
+ */
+
+#ifndef EVENT_BATCH_TILED_DECAY_HPP
+#define EVENT_BATCH_TILED_DECAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "event_batch/assert.hpp"
+#include "event_batch/keyed_segmenter.hpp"
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Dispatcher of event_batch::TiledDecay, whose keys are the tiles of
+ * the sensor.
+ *
+ * The tile of an event is found with two lookup tables indexed by its
+ * coordinates, without division.
+ */
+class TileKeys
+{
+ public:
+  /**
+   * @brief Splits the sensor into tiles.
+   *
+   * @param width Width of the sensor.
+   * @param height Height of the sensor.
+   * @param tile_width Width of a tile.
+   * @param tile_height Height of a tile.
+   */
+  TileKeys(const uint16_t width, const uint16_t height,
+           const uint16_t tile_width, const uint16_t tile_height)
+      : tile_columns_(width), tile_rows_(height)
+  {
+    ASSERT(tile_width > 0 && tile_height > 0,
+           "The tile size must be positive, got " << tile_width << "x"
+                                                  << tile_height);
+
+    number_tiles_x_ = (width + tile_width - 1) / tile_width;
+    number_tiles_y_ = (height + tile_height - 1) / tile_height;
+    for (std::size_t x = 0; x < width; ++x)
+    {
+      tile_columns_[x] = static_cast<uint32_t>(x / tile_width);
+    }
+    for (std::size_t y = 0; y < height; ++y)
+    {
+      tile_rows_[y] =
+          static_cast<uint32_t>((y / tile_height) * number_tiles_x_);
+    }
+  }
+
+  /**
+   * @brief Returns the number of tiles along the horizontal axis.
+   *
+   * @return Number of tiles along the horizontal axis.
+   */
+  std::size_t
+  number_tiles_x() const
+  {
+    return number_tiles_x_;
+  }
+
+  /**
+   * @brief Returns the number of tiles along the vertical axis.
+   *
+   * @return Number of tiles along the vertical axis.
+   */
+  std::size_t
+  number_tiles_y() const
+  {
+    return number_tiles_y_;
+  }
+
+  /**
+   * @brief Returns the number of tiles.
+   *
+   * @return Number of tiles.
+   */
+  std::size_t
+  number_keys() const
+  {
+    return number_tiles_x_ * number_tiles_y_;
+  }
+
+  /**
+   * @brief Returns the index of the tile of a pixel.
+   *
+   * Tiles are indexed row by row. The pixel must be on the sensor.
+   *
+   * @param x Horizontal coordinate of the pixel.
+   * @param y Vertical coordinate of the pixel.
+   *
+   * @return Index of the tile.
+   */
+  std::size_t
+  tile(const uint16_t x, const uint16_t y) const
+  {
+    return tile_columns_[x] + tile_rows_[y];
+  }
+
+  /**
+   * @brief Passes the tile of an event to a push function.
+   *
+   * Events outside of the sensor are ignored.
+   *
+   * @tparam Event Type of event.
+   * @tparam Push Type of the push function.
+   *
+   * @param event Incoming event.
+   * @param push Push function, called with the tile index.
+   */
+  template <typename Event, typename Push>
+  void
+  operator()(const Event& event, Push&& push) const
+  {
+    const uint16_t x = event.x;
+    const uint16_t y = event.y;
+    if (x < tile_columns_.size() && y < tile_rows_.size())
+    {
+      push(tile(x, y));
+    }
+  }
+
+ protected:
+  /**
+   * @brief Number of tiles along the horizontal axis.
+   */
+  std::size_t number_tiles_x_;
+  /**
+   * @brief Number of tiles along the vertical axis.
+   */
+  std::size_t number_tiles_y_;
+  /**
+   * @brief Tile column of each horizontal coordinate.
+   */
+  StdVector<uint32_t> tile_columns_;
+  /**
+   * @brief Index of the first tile of the tile row of each vertical
+   * coordinate.
+   */
+  StdVector<uint32_t> tile_rows_;
+};
+
+/**
+ * @brief Spatially tiled decay and batch estimator.
+ *
+ * This class splits the sensor into tiles of \p tile_width x \p tile_height
+ * pixels (the last column and row of tiles may be smaller), and estimates an
+ * independent decay and ideal batch for each tile with
+ * event_batch::KeyedSegmenter.
+ * Hence, a busy region and a quiet region get their own rate, and all
+ * regions are processed in a single pass over the events.
+ * Tiles are indexed row by row.
+ *
+ * @tparam Event Type of event.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch of a tile, called with the tile index and a
+ * event_batch::Span<const Event>.
+ */
+template <typename Event, typename HandleBatch>
+class TiledDecay : public KeyedSegmenter<Event, TileKeys, HandleBatch>
+{
+ public:
+  /**
+   * @brief Constructs an instance to estimate the ideal batches of each tile
+   * of the sensor.
+   *
+   * @param width Width of the sensor.
+   * @param height Height of the sensor.
+   * @param tile_width Width of a tile.
+   * @param tile_height Height of a tile.
+   * @param t_decay_first Initial decay assumption to bootstrap the rate
+   * estimator of each tile \f$[\text{microseconds}]\f$.
+   * @param weight_thresh Weight threshold that splits the batches.
+   * @param handle_batch Handle to further process the estimated batch of a
+   * tile.
+   * @param limits Upper bounds on the batches of each tile.
+   */
+  TiledDecay(const uint16_t width, const uint16_t height,
+             const uint16_t tile_width, const uint16_t tile_height,
+             const uint64_t t_decay_first, const float weight_thresh,
+             HandleBatch&& handle_batch,
+             const BatchLimits& limits = BatchLimits())
+      : KeyedSegmenter<Event, TileKeys, HandleBatch>(
+            TileKeys(width, height, tile_width, tile_height), t_decay_first,
+            weight_thresh, std::forward<HandleBatch>(handle_batch), limits)
+  {
+  }
+
+  /**
+   * @brief Returns the number of tiles along the horizontal axis.
+   *
+   * @return Number of tiles along the horizontal axis.
+   */
+  std::size_t
+  number_tiles_x() const
+  {
+    return this->dispatch_.number_tiles_x();
+  }
+
+  /**
+   * @brief Returns the number of tiles along the vertical axis.
+   *
+   * @return Number of tiles along the vertical axis.
+   */
+  std::size_t
+  number_tiles_y() const
+  {
+    return this->dispatch_.number_tiles_y();
+  }
+
+  /**
+   * @brief Returns the number of tiles.
+   *
+   * @return Number of tiles.
+   */
+  std::size_t
+  number_tiles() const
+  {
+    return this->number_keys();
+  }
+
+  /**
+   * @brief Returns the index of the tile of a pixel.
+   *
+   * The pixel must be on the sensor.
+   *
+   * @param x Horizontal coordinate of the pixel.
+   * @param y Vertical coordinate of the pixel.
+   *
+   * @return Index of the tile.
+   */
+  std::size_t
+  tile(const uint16_t x, const uint16_t y) const
+  {
+    return this->dispatch_.tile(x, y);
+  }
+};
+
+/**
+ * @brief Make function that creates an instance of event_batch::TiledDecay.
+ *
+ * @tparam Event Type of event.
+ * @tparam HandleBatch Type of the handle to further process the estimated
+ * batch of a tile.
+ *
+ * @param width Width of the sensor.
+ * @param height Height of the sensor.
+ * @param tile_width Width of a tile.
+ * @param tile_height Height of a tile.
+ * @param t_decay_first Initial decay assumption to bootstrap the rate
+ * estimator of each tile \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ * @param handle_batch Handle to further process the estimated batch of a
+ * tile.
+ * @param limits Upper bounds on the batches of each tile.
+ *
+ * @return Instance of event_batch::TiledDecay.
+ */
+template <typename Event, typename HandleBatch>
+inline TiledDecay<Event, HandleBatch>
+make_tiled_decay(const uint16_t width, const uint16_t height,
+                 const uint16_t tile_width, const uint16_t tile_height,
+                 const uint64_t t_decay_first, const float weight_thresh,
+                 HandleBatch&& handle_batch,
+                 const BatchLimits& limits = BatchLimits())
+{
+  return TiledDecay<Event, HandleBatch>(
+      width, height, tile_width, tile_height, t_decay_first, weight_thresh,
+      std::forward<HandleBatch>(handle_batch), limits);
+}
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_TILED_DECAY_HPP
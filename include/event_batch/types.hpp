@@ -6,9 +6,16 @@
 #ifndef EVENT_BATCH_TYPES_HPP
 #define EVENT_BATCH_TYPES_HPP
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <new>
+#include <type_traits>
 #include <vector>
 
+#include "event_batch/fixed_point.hpp"
+
 namespace event_batch
 {
 /**
@@ -18,6 +25,239 @@ namespace event_batch
 template <typename T, typename Allocator = std::allocator<T>>
 using StdVector = typename std::vector<T, Allocator>;
 
+/**
+ * @brief Allocator that aligns its storage on a given boundary.
+ *
+ * @tparam T Type of element.
+ * @tparam Alignment Alignment of the storage in bytes.
+ */
+template <typename T, std::size_t Alignment = 64>
+class AlignedAllocator
+{
+ public:
+  /**
+   * @brief Type of element.
+   */
+  typedef T value_type;
+
+  /**
+   * @brief Rebinds the allocator to another type of element.
+   *
+   * @tparam U Other type of element.
+   */
+  template <typename U>
+  struct rebind
+  {
+    /**
+     * @brief Rebound allocator.
+     */
+    typedef AlignedAllocator<U, Alignment> other;
+  };
+
+  /**
+   * @brief Constructs an allocator.
+   */
+  AlignedAllocator() = default;
+  /**
+   * @brief Constructs an allocator from an allocator of another type.
+   */
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+  {
+  }
+
+  /**
+   * @brief Allocates aligned storage for \p size elements.
+   *
+   * @param size Number of elements.
+   *
+   * @return Pointer to the storage.
+   */
+  T*
+  allocate(const std::size_t size)
+  {
+    return static_cast<T*>(
+        ::operator new(size * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  /**
+   * @brief Deallocates storage obtained from \ref allocate.
+   *
+   * @param data Pointer to the storage.
+   */
+  void
+  deallocate(T* data, std::size_t)
+  {
+    ::operator delete(data, std::align_val_t(Alignment));
+  }
+
+  /**
+   * @brief Compares two allocators, which are all interchangeable.
+   *
+   * @return True.
+   */
+  template <typename U>
+  bool
+  operator==(const AlignedAllocator<U, Alignment>&) const
+  {
+    return true;
+  }
+
+  /**
+   * @brief Compares two allocators, which are all interchangeable.
+   *
+   * @return False.
+   */
+  template <typename U>
+  bool
+  operator!=(const AlignedAllocator<U, Alignment>&) const
+  {
+    return false;
+  }
+};
+
+/**
+ * @brief Alias type for a vector whose storage is aligned on a cache line.
+ */
+template <typename T>
+using AlignedVector = StdVector<T, AlignedAllocator<T>>;
+
+/**
+ * @brief Non-owning view over a contiguous sequence of elements.
+ *
+ * This class is a minimal replacement for C++20 <a
+ * href="https://en.cppreference.com/w/cpp/container/span">std::span</a>.
+ * It does not manage the lifetime of the viewed elements.
+ *
+ * @tparam T Type of element.
+ */
+template <typename T>
+class Span
+{
+ public:
+  /**
+   * @brief Constructs an empty view.
+   */
+  Span() : data_(nullptr), size_(0) {}
+  /**
+   * @brief Constructs a view over \p size elements starting at \p data.
+   *
+   * @param data @copybrief data_
+   * @param size @copybrief size_
+   */
+  Span(T* data, const std::size_t size) : data_(data), size_(size) {}
+  /**
+   * @brief Constructs a view over the range [\p first, \p last).
+   *
+   * @param first Pointer to the first element.
+   * @param last Pointer to one past the last element.
+   */
+  Span(T* first, T* last)
+      : data_(first), size_(static_cast<std::size_t>(last - first))
+  {
+  }
+
+  /**
+   * @brief Returns a pointer to the first element.
+   *
+   * @return Pointer to the first element.
+   */
+  T*
+  data() const
+  {
+    return data_;
+  }
+
+  /**
+   * @brief Returns the number of elements.
+   *
+   * @return Number of elements.
+   */
+  std::size_t
+  size() const
+  {
+    return size_;
+  }
+
+  /**
+   * @brief Checks whether the view is empty.
+   *
+   * @return True if the view has no elements, false otherwise.
+   */
+  bool
+  empty() const
+  {
+    return size_ == 0;
+  }
+
+  /**
+   * @brief Returns a pointer to the first element.
+   *
+   * @return Pointer to the first element.
+   */
+  T*
+  begin() const
+  {
+    return data_;
+  }
+
+  /**
+   * @brief Returns a pointer to one past the last element.
+   *
+   * @return Pointer to one past the last element.
+   */
+  T*
+  end() const
+  {
+    return data_ + size_;
+  }
+
+  /**
+   * @brief Returns a reference to the first element.
+   *
+   * @return Reference to the first element.
+   */
+  T&
+  front() const
+  {
+    return data_[0];
+  }
+
+  /**
+   * @brief Returns a reference to the last element.
+   *
+   * @return Reference to the last element.
+   */
+  T&
+  back() const
+  {
+    return data_[size_ - 1];
+  }
+
+  /**
+   * @brief Returns a reference to the element at position \p i.
+   *
+   * @param i Position of the element.
+   *
+   * @return Reference to the element at position \p i.
+   */
+  T&
+  operator[](const std::size_t i) const
+  {
+    return data_[i];
+  }
+
+ protected:
+  /**
+   * @brief Pointer to the first element.
+   */
+  T* data_;
+  /**
+   * @brief Number of elements.
+   */
+  std::size_t size_;
+};
+
 /**
  * @brief Structure representing an event.
  *
@@ -43,10 +283,82 @@ struct __attribute__((__packed__)) Event
   uint16_t p;
 };
 
+/**
+ * @brief Timestamp accessor that reads the \p t member of an event.
+ */
+struct EventTimestamp
+{
+  /**
+   * @brief Returns the timestamp of an event.
+   *
+   * @tparam Event Type of event.
+   *
+   * @param event Event.
+   *
+   * @return Timestamp of the event \f$[\text{microseconds}]\f$.
+   */
+  template <typename Event>
+  uint64_t
+  operator()(const Event& event) const
+  {
+    return event.t;
+  }
+};
+
+/**
+ * @brief Timestamp accessor for streams of bare timestamps.
+ *
+ * Estimators using this accessor take \p uint64_t as event type, and consume
+ * timestamp columns in place.
+ */
+struct RawTimestamp
+{
+  /**
+   * @brief Returns the timestamp itself.
+   *
+   * @param t Timestamp \f$[\text{microseconds}]\f$.
+   *
+   * @return Timestamp \f$[\text{microseconds}]\f$.
+   */
+  uint64_t
+  operator()(const uint64_t t) const
+  {
+    return t;
+  }
+};
+
+/**
+ * @brief Returns the decay of the event count over a time difference,
+ * \f$1/(10^{-6}\Delta t\,n_\text{decay}+1)\f$.
+ *
+ * @tparam Scalar Floating-point type of the decay arithmetic.
+ *
+ * @param t_diff Time difference \f$[\text{microseconds}]\f$.
+ * @param n_decay Count of the incoming number of events.
+ *
+ * @return Decay in \f$[0,1]\f$.
+ */
+template <typename Scalar, typename = typename std::enable_if<
+                               std::is_floating_point<Scalar>::value>::type>
+inline Scalar
+decay_factor(const Scalar t_diff, const Scalar n_decay)
+{
+  const Scalar one = static_cast<Scalar>(1);
+  return one / (static_cast<Scalar>(1e-6) * t_diff * n_decay + one);
+}
+
 /**
  * @brief Event decay structure.
+ *
+ * The arithmetic of the decay runs on \p Scalar: single-precision floats,
+ * which the vectorized kernels use, double-precision floats, which do not
+ * drift on long recordings, or event_batch::FixedPoint, whose resolution does
+ * not degrade as the time decay grows.
+ *
+ * @tparam Scalar Type of the decay arithmetic.
  */
-struct Decay
+template <typename Scalar>
+struct BasicDecay
 {
   /**
    * @brief Previous timestamp \f$[\text{microseconds}]\f$.
@@ -55,20 +367,20 @@ struct Decay
   /**
    * @brief Event decay in \f$[0,1]\f$.
    */
-  float decay;
+  Scalar decay;
   /**
    * @brief Auxiliary variable that counts the incoming number of events.
    */
-  float n_decay;
+  Scalar n_decay;
   /**
    * @brief Auxiliary variable that estimates the event time decay
    * \f$[\text{microseconds}]\f$.
    */
-  float t_decay;
+  Scalar t_decay;
   /**
    * @brief Estimated event rate \f$[\text{events}/\text{microseconds}]\f$.
    */
-  float rate;
+  Scalar rate;
 
   /**
    * @brief Resets the context.
@@ -80,10 +392,204 @@ struct Decay
   reset(const uint64_t t_decay_first)
   {
     t = 0;
-    decay = 1;
-    n_decay = 0;
-    t_decay = t_decay_first;
-    rate = 0;
+    decay = static_cast<Scalar>(1);
+    n_decay = static_cast<Scalar>(0);
+    t_decay = static_cast<Scalar>(t_decay_first);
+    rate = static_cast<Scalar>(0);
+  }
+
+  /**
+   * @brief Updates the context with an incoming timestamp.
+   *
+   * @param t_event Incoming timestamp \f$[\text{microseconds}]\f$.
+   */
+  void
+  update(const uint64_t t_event)
+  {
+    decay = static_cast<Scalar>(1);
+    if (t_event > t)
+    {
+      const Scalar t_diff = static_cast<Scalar>(t_event - t);
+      decay = decay_factor(t_diff, n_decay);
+
+      n_decay *= decay;
+      t_decay = decay * t_decay + t_diff;
+
+      t = t_event;
+    }
+    ++n_decay;
+
+    rate = n_decay / t_decay;
+  }
+
+  /**
+   * @brief Predicts the count of the incoming number of events at a later
+   * time, assuming no event arrives in between.
+   *
+   * This is the value \p n_decay would decay to before counting an event at
+   * \p t_now.
+   *
+   * @param t_now Time of the prediction \f$[\text{microseconds}]\f$.
+   *
+   * @return Predicted count of the incoming number of events.
+   */
+  Scalar
+  n_decay_at(const uint64_t t_now) const
+  {
+    if (t_now <= t)
+    {
+      return n_decay;
+    }
+    const Scalar t_diff = static_cast<Scalar>(t_now - t);
+    if constexpr (std::is_floating_point<Scalar>::value)
+    {
+      return n_decay / (static_cast<Scalar>(1e-6) * t_diff * n_decay +
+                        static_cast<Scalar>(1));
+    }
+    else
+    {
+      return n_decay * decay_factor(t_diff, n_decay);
+    }
+  }
+};
+
+/**
+ * @brief Event decay structure with single-precision arithmetic, which the
+ * batch estimators consume.
+ */
+typedef BasicDecay<float> Decay;
+
+/**
+ * @brief Returns the earliest time at which an incoming event would close a
+ * batch.
+ *
+ * An event arriving after a silence \f$D\f$ since the last event raises the
+ * count to \f$n_\text{decay}(D)+1\f$, with event_batch::Decay::n_decay_at,
+ * so that the weight \f$w=1/(10^{-6}\Delta t\,n_\text{decay}+1)\f$ it
+ * gives the batch follows in closed form: with \f$a=10^{-6}\f$, \f$n\f$ the
+ * current count, \f$B\f$ the span of the batch and \f$m=1/\epsilon-1\f$,
+ * the event closes the batch once
+ * \f$a^2nD^2+a(n+1+anB-mn)D+a(n+1)B-m>0\f$.
+ * The quadratic opens upwards, so that every pending batch closes after a
+ * finite silence, at its non-negative root.
+ * The root is then settled on the single-precision test of the estimators.
+ * From then on, the pending batch is complete whether or not an event
+ * arrives.
+ *
+ * @tparam Scalar Type of the decay arithmetic.
+ *
+ * @param decay Current decay, updated with the last event of the batch.
+ * @param t_first Timestamp of the first event of the batch
+ * \f$[\text{microseconds}]\f$.
+ * @param weight_thresh Weight threshold that splits the batches.
+ *
+ * @return Earliest time at which an incoming event closes the batch
+ * \f$[\text{microseconds}]\f$, or the largest timestamp if it overflows.
+ */
+template <typename Scalar>
+inline uint64_t
+batch_closing_time(const BasicDecay<Scalar>& decay, const uint64_t t_first,
+                   const float weight_thresh)
+{
+  const uint64_t never = ~static_cast<uint64_t>(0);
+  const double a = 1e-6;
+  const double n = static_cast<double>(decay.n_decay);
+  const double m = 1 / static_cast<double>(weight_thresh) - 1;
+  const double span =
+      (decay.t > t_first) ? static_cast<double>(decay.t - t_first) : 0;
+  const double c = a * (n + 1) * span - m;
+  if (c > 0)
+  {
+    return decay.t;
+  }
+  const double q = a * a * n;
+  const double b = a * (n + 1 + a * n * span - m * n);
+  const double root = std::sqrt(b * b - 4 * q * c);
+  // Avoids the cancellation of -b + root when b is positive
+  const double t_diff = (b > 0) ? -2 * c / (b + root) : (root - b) / (2 * q);
+  if (!(t_diff < static_cast<double>(never - decay.t) - 1))
+  {
+    return never;
+  }
+  // Settles the rounding of the estimators on the first whole microsecond
+  // at which an event closes the batch in single precision
+  const float inverse_weight_thresh = 1 / weight_thresh;
+  const auto closes = [&](const uint64_t t_now) {
+    BasicDecay<Scalar> next = decay;
+    next.update(t_now);
+    return static_cast<float>(1e-6) *
+                   static_cast<float>(t_now - std::min(t_now, t_first)) *
+                   static_cast<float>(next.n_decay) +
+               static_cast<float>(1) >
+           inverse_weight_thresh;
+  };
+  uint64_t t_close = decay.t + static_cast<uint64_t>(t_diff) + 1;
+  for (unsigned i = 0; i < 1024 && !closes(t_close); ++i)
+  {
+    ++t_close;
+  }
+  for (unsigned i = 0; i < 1024 && t_close > decay.t && closes(t_close - 1);
+       ++i)
+  {
+    --t_close;
+  }
+  return t_close;
+}
+
+/**
+ * @brief Upper bounds on the batches of a batch estimator, on top of the
+ * weight threshold.
+ *
+ * A zero bound is disabled.
+ */
+struct BatchLimits
+{
+  /**
+   * @brief Maximum number of events of a batch.
+   */
+  std::size_t max_events = 0;
+  /**
+   * @brief Maximum time elapsed between the first and the last events of a
+   * batch \f$[\text{microseconds}]\f$.
+   */
+  uint64_t max_duration = 0;
+};
+
+/**
+ * @brief Rectangular region of the sensor [\p left, \p right) x [\p bottom,
+ * \p top), with the same convention as the crop options of the executables.
+ */
+struct Region
+{
+  /**
+   * @brief Left side coordinate.
+   */
+  uint16_t left;
+  /**
+   * @brief Bottom side coordinate.
+   */
+  uint16_t bottom;
+  /**
+   * @brief Right side coordinate, excluded.
+   */
+  uint16_t right;
+  /**
+   * @brief Top side coordinate, excluded.
+   */
+  uint16_t top;
+
+  /**
+   * @brief Checks whether a pixel lies in the region.
+   *
+   * @param x Horizontal coordinate of the pixel.
+   * @param y Vertical coordinate of the pixel.
+   *
+   * @return True if the pixel lies in the region, false otherwise.
+   */
+  bool
+  contains(const uint16_t x, const uint16_t y) const
+  {
+    return x >= left && x < right && y >= bottom && y < top;
   }
 };
 }  // namespace event_batch
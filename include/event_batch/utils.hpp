@@ -7,8 +7,10 @@
 #define EVENT_BATCH_UTILS_HPP
 
 #include <sstream>
+#include <stdexcept>
 #include <string>
 
+#include "event_batch/types.hpp"
 #include "pontella.hpp"
 
 namespace event_batch
@@ -44,6 +46,55 @@ extract_argument(pontella::command command, const std::string& name,
   }
   return default_argument;
 }
+
+/**
+ * @brief Parses a list of regions.
+ *
+ * The regions are separated by semicolons, and each region is given by its
+ * left, bottom, right and top side coordinates separated by commas, e.g.
+ * "0,0,32,32;32,0,64,32".
+ *
+ * @param regions_string List of regions.
+ *
+ * @return Parsed regions.
+ */
+inline StdVector<Region>
+parse_regions(const std::string& regions_string)
+{
+  StdVector<Region> regions;
+  std::stringstream regions_stream(regions_string);
+  std::string region_string;
+  while (std::getline(regions_stream, region_string, ';'))
+  {
+    if (region_string.empty())
+    {
+      continue;
+    }
+    std::stringstream region_stream(region_string);
+    uint16_t sides[4];
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+      char separator = ',';
+      if ((i > 0 && !(region_stream >> separator)) || separator != ',' ||
+          !(region_stream >> sides[i]))
+      {
+        throw std::runtime_error("malformed region '" + region_string +
+                                 "', expected left,bottom,right,top");
+      }
+    }
+    if (!(region_stream >> std::ws).eof())
+    {
+      throw std::runtime_error("malformed region '" + region_string +
+                               "', expected left,bottom,right,top");
+    }
+    if (sides[0] > sides[2] || sides[1] > sides[3])
+    {
+      throw std::runtime_error("inverted region '" + region_string + "'");
+    }
+    regions.push_back({sides[0], sides[1], sides[2], sides[3]});
+  }
+  return regions;
+}
 }  // namespace event_batch
 
 #endif  // EVENT_BATCH_UTILS_HPP
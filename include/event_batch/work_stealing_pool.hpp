@@ -0,0 +1,187 @@
+/**
+ * @file
+ * @brief Work-stealing thread pool implementation.
+ */
+
+#ifndef EVENT_BATCH_WORK_STEALING_POOL_HPP
+#define EVENT_BATCH_WORK_STEALING_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "event_batch/types.hpp"
+
+namespace event_batch
+{
+/**
+ * @brief Work-stealing thread pool.
+ *
+ * This class runs a set of independent tasks on a fixed number of threads.
+ * Tasks are dealt to the workers in the given order, so that sorting them by
+ * decreasing cost schedules the largest ones first.
+ * Each worker takes tasks from the front of its own queue and, once empty,
+ * steals from the back of the other queues, where the cheapest tasks are.
+ */
+class WorkStealingPool
+{
+ public:
+  /**
+   * @brief Alias for a task.
+   */
+  typedef std::function<void()> Task;
+
+  /**
+   * @brief Constructs a pool of threads.
+   *
+   * @param number_threads @copybrief number_threads_
+   * If 0, the number of concurrent threads supported by the machine is used.
+   */
+  explicit WorkStealingPool(const std::size_t number_threads = 0)
+      : number_threads_(number_threads > 0
+                            ? number_threads
+                            : std::max(std::thread::hardware_concurrency(),
+                                       static_cast<unsigned>(1)))
+  {
+  }
+
+  /**
+   * @brief Returns the number of threads.
+   *
+   * @return Number of threads.
+   */
+  std::size_t
+  number_threads() const
+  {
+    return number_threads_;
+  }
+
+  /**
+   * @brief Runs all tasks until completion.
+   *
+   * If a task throws, the remaining tasks are still run and the first
+   * exception is rethrown once all threads are joined.
+   *
+   * @param tasks Tasks to run, ideally sorted by decreasing cost.
+   */
+  void
+  run(StdVector<Task> tasks)
+  {
+    const std::size_t number_workers =
+        std::min(number_threads_, std::max(tasks.size(), std::size_t(1)));
+
+    StdVector<std::unique_ptr<Queue>> queues;
+    for (std::size_t i = 0; i < number_workers; ++i)
+    {
+      queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < tasks.size(); ++i)
+    {
+      queues[i % number_workers]->tasks.push_back(std::move(tasks[i]));
+    }
+
+    std::mutex exception_mutex;
+    std::exception_ptr exception;
+    auto work = [&](const std::size_t worker) {
+      Task task;
+      while (pop(queues, worker, task))
+      {
+        try
+        {
+          task();
+        }
+        catch (...)
+        {
+          const std::lock_guard<std::mutex> lock(exception_mutex);
+          if (!exception)
+          {
+            exception = std::current_exception();
+          }
+        }
+      }
+    };
+
+    StdVector<std::thread> threads;
+    for (std::size_t i = 1; i < number_workers; ++i)
+    {
+      threads.emplace_back(work, i);
+    }
+    work(0);
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+
+    if (exception)
+    {
+      std::rethrow_exception(exception);
+    }
+  }
+
+ protected:
+  /**
+   * @brief Queue of tasks owned by a worker.
+   */
+  struct Queue
+  {
+    /**
+     * @brief Mutex guarding the tasks.
+     */
+    std::mutex mutex;
+    /**
+     * @brief Pending tasks.
+     */
+    std::deque<Task> tasks;
+  };
+
+  /**
+   * @brief Takes the next task of a worker, stealing if its queue is empty.
+   *
+   * @param queues Queues of all workers.
+   * @param worker Index of the worker.
+   * @param task Taken task.
+   *
+   * @return True if a task was taken, false if all queues are empty.
+   */
+  static bool
+  pop(StdVector<std::unique_ptr<Queue>>& queues, const std::size_t worker,
+      Task& task)
+  {
+    {
+      Queue& queue = *queues[worker];
+      const std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.tasks.empty())
+      {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+      }
+    }
+    for (std::size_t i = 1; i < queues.size(); ++i)
+    {
+      Queue& queue = *queues[(worker + i) % queues.size()];
+      const std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.tasks.empty())
+      {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Number of threads.
+   */
+  std::size_t number_threads_;
+};
+}  // namespace event_batch
+
+#endif  // EVENT_BATCH_WORK_STEALING_POOL_HPP
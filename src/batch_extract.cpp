@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include "event_batch.hpp"
+#include "pontella.hpp"
+
+int
+main(int argc, char* argv[])
+{
+  using namespace event_batch;
+
+  struct Arguments
+  {
+    uint64_t t_decay_first;
+    float weight_thresh;
+    BatchLimits limits;
+    std::string output_directory;
+    std::size_t number_threads;
+    std::size_t number_chunks;
+    uint64_t t_warmup;
+  };
+
+  return pontella::main(
+      {"batch_extract is an executable that estimates the batches of events "
+       "from several Event Stream files in parallel",
+       "Usage: ./batch_extract [options] /path/to/input",
+       "    The input is either an Event Stream file, a directory of Event "
+       "Stream files, or a text file listing one Event Stream file per line",
+       "    For each input file, a file with the same name and a .csv "
+       "extension is written to the output directory, whose lines are the "
+       "size and end timestamp [microseconds] of each batch",
+       "Available options:",
+       "    -t t, --time-decay-first t      sets the initial time decay",
+       "                                        defaults to 10000",
+       "    -e e, --weight-threshold e      sets the weight threshold",
+       "                                        defaults to 0.1",
+       "    -n n, --max-events n            sets the maximum number of events "
+       "of a batch, 0 is unbounded",
+       "                                        defaults to 0",
+       "    -d d, --max-duration d          sets the maximum time between the "
+       "first and last events of a batch [microseconds], 0 is unbounded",
+       "                                        defaults to 0",
+       "    -o o, --output-directory o      sets the output directory",
+       "                                        defaults to the current "
+       "directory",
+       "    -j j, --jobs j                  sets the number of threads, shared "
+       "between the files and their chunks",
+       "                                        defaults to the number of "
+       "cores",
+       "    -c c, --chunks c                sets the number of chunks each "
+       "file is split into and processed in parallel (loads the whole file "
+       "into memory)",
+       "                                        defaults to 1",
+       "    -w w, --warm-up w               sets the duration of the decay "
+       "warm-up before each chunk [microseconds]",
+       "                                        defaults to 1000000",
+       "    -h, --help                      shows this help message"},
+      argc, argv, 1,
+      {{"time-decay-first", {"t"}},
+       {"weight-threshold", {"e"}},
+       {"max-events", {"n"}},
+       {"max-duration", {"d"}},
+       {"output-directory", {"o"}},
+       {"jobs", {"j"}},
+       {"chunks", {"c"}},
+       {"warm-up", {"w"}}},
+      {}, [&](pontella::command command) {
+        namespace fs = std::filesystem;
+
+        Arguments arguments;
+        arguments.t_decay_first =
+            extract_argument(command, "time-decay-first", 10000);
+        arguments.weight_thresh =
+            extract_argument(command, "weight-threshold", 0.1);
+        arguments.limits.max_events =
+            extract_argument(command, "max-events", std::size_t(0));
+        arguments.limits.max_duration =
+            extract_argument(command, "max-duration", uint64_t(0));
+        arguments.output_directory = extract_argument(
+            command, "output-directory", std::string("."));
+        arguments.number_threads = extract_argument(command, "jobs", 0);
+        arguments.number_chunks = extract_argument(command, "chunks", 1);
+        arguments.t_warmup = extract_argument(command, "warm-up", 1000000);
+
+        const fs::path input(command.arguments[0]);
+        StdVector<fs::path> filenames;
+        if (fs::is_directory(input))
+        {
+          for (const fs::directory_entry& entry :
+               fs::directory_iterator(input))
+          {
+            if (entry.is_regular_file() && entry.path().extension() == ".es")
+            {
+              filenames.push_back(entry.path());
+            }
+          }
+        }
+        else if (input.extension() == ".es")
+        {
+          filenames.push_back(input);
+        }
+        else
+        {
+          std::ifstream list(input);
+          if (!list)
+          {
+            throw std::runtime_error("unreadable file '" + input.string() +
+                                     "'");
+          }
+          std::string line;
+          while (std::getline(list, line))
+          {
+            if (!line.empty())
+            {
+              filenames.push_back(line);
+            }
+          }
+        }
+
+        // The outputs are named after the inputs, so two inputs with the
+        // same base name would be written concurrently to the same file
+        std::set<fs::path> output_names;
+        for (const fs::path& filename : filenames)
+        {
+          const fs::path output_name =
+              fs::path(filename.filename()).replace_extension(".csv");
+          if (!output_names.insert(output_name).second)
+          {
+            throw std::runtime_error("several input files are written to '" +
+                                     output_name.string() + "'");
+          }
+        }
+
+        // Largest files first
+        StdVector<std::pair<uintmax_t, fs::path>> sized_filenames;
+        for (const fs::path& filename : filenames)
+        {
+          sized_filenames.emplace_back(fs::file_size(filename), filename);
+        }
+        std::sort(sized_filenames.begin(), sized_filenames.end(),
+                  [](const auto& sized_filename_a,
+                     const auto& sized_filename_b) {
+                    return sized_filename_a.first > sized_filename_b.first;
+                  });
+
+        fs::create_directories(arguments.output_directory);
+
+        // The threads of the chunks of a file are taken from the budget of
+        // the file tasks, so that at most the given number of threads run
+        const std::size_t number_threads =
+            WorkStealingPool(arguments.number_threads).number_threads();
+        const std::size_t number_chunk_threads =
+            std::min(std::max(arguments.number_chunks, std::size_t(1)),
+                     number_threads);
+        const std::size_t number_file_threads =
+            number_threads / number_chunk_threads;
+
+        std::mutex output_mutex;
+        StdVector<WorkStealingPool::Task> tasks;
+        for (const auto& sized_filename : sized_filenames)
+        {
+          const fs::path filename = sized_filename.second;
+          tasks.push_back([&, filename]() {
+            const fs::path output_filename =
+                fs::path(arguments.output_directory) /
+                filename.filename().replace_extension(".csv");
+            std::ofstream output(output_filename);
+            if (!output)
+            {
+              throw std::runtime_error("unwritable file '" +
+                                       output_filename.string() + "'");
+            }
+
+            std::size_t number_batches = 0;
+            auto handle_batch = [&](Span<const Event> batch) {
+              output << batch.size() << ',' << batch.back().t << '\n';
+              ++number_batches;
+            };
+
+            const MappedEventStream event_stream(filename.string());
+            if (arguments.number_chunks > 1)
+            {
+              StdVector<Event> events;
+              for_each_block(event_stream,
+                             [&](const Event* first, const Event* last) {
+                               events.insert(events.end(), first, last);
+                             });
+              const StdVector<std::size_t> ends = segment_parallel(
+                  events.data(), events.data() + events.size(),
+                  arguments.t_decay_first, arguments.weight_thresh,
+                  arguments.number_chunks, arguments.t_warmup,
+                  arguments.limits, number_chunk_threads);
+              std::size_t batch_first = 0;
+              for (const std::size_t batch_last : ends)
+              {
+                handle_batch({events.data() + batch_first,
+                              events.data() + batch_last});
+                batch_first = batch_last;
+              }
+              if (batch_first < events.size())
+              {
+                handle_batch({events.data() + batch_first,
+                              events.data() + events.size()});
+              }
+            }
+            else
+            {
+              auto segmenter = make_adaptive_segmenter<Event>(
+                  arguments.t_decay_first, arguments.weight_thresh,
+                  handle_batch, 0, arguments.limits);
+              for_each_block(event_stream, segmenter);
+              segmenter.flush();
+            }
+
+            const std::lock_guard<std::mutex> lock(output_mutex);
+            std::cout << filename.string() << ": " << number_batches
+                      << " batches\n";
+          });
+        }
+
+        WorkStealingPool(number_file_threads).run(std::move(tasks));
+      });
+}
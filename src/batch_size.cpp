@@ -1,26 +1,27 @@
+#include <memory>
+#include <stdexcept>
 #include <string>
 
 #include "event_batch.hpp"
 #include "pontella.hpp"
 #include "select_rectangle.hpp"
-#include "sepia.hpp"
 
 int
 main(int argc, char* argv[])
 {
   using namespace event_batch;
 
-  typedef sepia::dvs_event Event;
-  constexpr sepia::type Type = sepia::type::dvs;
-
   struct Arguments
   {
     uint64_t t_decay_first;
     float weight_thresh;
+    BatchLimits limits;
     uint16_t left;
     uint16_t right;
     uint16_t bottom;
     uint16_t top;
+    std::string regions;
+    std::string output;
   };
 
   return pontella::main(
@@ -31,6 +32,12 @@ main(int argc, char* argv[])
        "                                        defaults to 10000",
        "    -e e, --weight-threshold e      sets the weight threshold",
        "                                        defaults to 0.1",
+       "    -n n, --max-events n            sets the maximum number of events "
+       "of a batch, 0 is unbounded",
+       "                                        defaults to 0",
+       "    -d d, --max-duration d          sets the maximum time between the "
+       "first and last events of a batch [microseconds], 0 is unbounded",
+       "                                        defaults to 0",
        "    -cl cl, --crop-left cl          sets the crop's left side "
        "coordinate",
        "                                        defaults to 0",
@@ -43,60 +50,122 @@ main(int argc, char* argv[])
        "    -ct ct, --crop-top ct           sets the crop's top side "
        "coordinate",
        "                                        defaults to context height",
+       "    -r r, --regions r               estimates the batches of several "
+       "regions in a single pass instead of the crop, given as "
+       "'left,bottom,right,top;...', each output line is then the region "
+       "index and the size of one of its batches, cannot be used with the "
+       "crop options",
+       "    -o o, --output o                writes a binary batch index to the "
+       "given file instead of the batch sizes, with the event indices, first "
+       "and last timestamps, and decay of each batch, cannot be used with "
+       "the crop options",
        "    -h, --help                      shows this help message"},
       argc, argv, 1,
       {{"time-decay-first", {"t"}},
        {"weight-threshold", {"e"}},
+       {"max-events", {"n"}},
+       {"max-duration", {"d"}},
        {"crop-left", {"cl"}},
        {"crop-right", {"cr"}},
        {"crop-bottom", {"cb"}},
-       {"crop-top", {"ct"}}},
+       {"crop-top", {"ct"}},
+       {"regions", {"r"}},
+       {"output", {"o"}}},
       {}, [&](pontella::command command) {
         const std::string& filename = command.arguments[0];
-        const auto header =
-            sepia::read_header(sepia::filename_to_ifstream(filename));
+        const MappedEventStream event_stream(filename);
+        const auto& header = event_stream.header();
 
         Arguments arguments;
         arguments.t_decay_first =
             extract_argument(command, "time-decay-first", 10000);
         arguments.weight_thresh =
             extract_argument(command, "weight-threshold", 0.1);
+        arguments.limits.max_events =
+            extract_argument(command, "max-events", std::size_t(0));
+        arguments.limits.max_duration =
+            extract_argument(command, "max-duration", uint64_t(0));
         arguments.left = extract_argument(command, "crop-left", 0);
         arguments.right = extract_argument(command, "crop-right", header.width);
         arguments.bottom = extract_argument(command, "crop-bottom", 0);
         arguments.top = extract_argument(command, "crop-top", header.height);
+        arguments.regions =
+            extract_argument(command, "regions", std::string());
+        arguments.output = extract_argument(command, "output", std::string());
+        const bool cropped = command.options.count("crop-left") > 0 ||
+                             command.options.count("crop-right") > 0 ||
+                             command.options.count("crop-bottom") > 0 ||
+                             command.options.count("crop-top") > 0;
 
-        Decay event_decay;
-        auto handle_decay = [&](Decay decay) { event_decay = decay; };
-
-        auto global_decay = make_global_decay<Event>(
-            arguments.t_decay_first,
-            [](Event event, float decay, float n_decay, float t_decay,
-               float rate) -> Decay {
-              return {event.t, decay, n_decay, t_decay, rate};
-            },
-            handle_decay);
+        if (!arguments.regions.empty())
+        {
+          if (!arguments.output.empty())
+          {
+            throw std::runtime_error(
+                "--regions and --output cannot be used together");
+          }
+          if (cropped)
+          {
+            throw std::runtime_error(
+                "--regions and the crop options cannot be used together");
+          }
+          auto region_segmenter = make_region_segmenter<Event>(
+              header.height, parse_regions(arguments.regions),
+              arguments.t_decay_first, arguments.weight_thresh,
+              [](std::size_t region, Span<const Event> batch) {
+                std::cout << region << ',' << batch.size() << '\n';
+              },
+              arguments.limits);
+          for_each_block(event_stream, region_segmenter);
+          region_segmenter.flush();
+          return;
+        }
 
-        auto handle_batch = [](StdVector<Event> batch) {
-          std::cout << batch.size() << '\n';
+        // The index stores the positions of the events in the segmented
+        // stream, which are not the ones of the file once cropped
+        if (cropped && !arguments.output.empty())
+        {
+          throw std::runtime_error(
+              "--output cannot be used with the crop options");
+        }
+        std::unique_ptr<BatchIndexWriter> index;
+        if (!arguments.output.empty())
+        {
+          index = std::make_unique<BatchIndexWriter>(arguments.output);
+        }
+        const Decay* decay = nullptr;
+        auto handle_batch = [&](Span<const Event> batch) {
+          if (index)
+          {
+            (*index)(batch, *decay);
+          }
+          else
+          {
+            std::cout << batch.size() << '\n';
+          }
         };
 
-        auto batch = make_batch<Event>(arguments.weight_thresh, event_decay,
-                                       handle_batch);
+        auto segmenter = make_adaptive_segmenter<Event>(
+            arguments.t_decay_first, arguments.weight_thresh, handle_batch, 0,
+            arguments.limits);
+        decay = &segmenter.batch_decay();
 
         auto crop = tarsier::make_select_rectangle<Event>(
             arguments.left, arguments.bottom, arguments.right - arguments.left,
-            arguments.top - arguments.bottom, [&](Event event) {
-              global_decay(event);
-              batch(event);
-            });
+            arguments.top - arguments.bottom, segmenter);
 
-        sepia::join_observable<Type>(sepia::filename_to_ifstream(filename),
-                                     crop);
+        for_each_block(event_stream, [&](const Event* first,
+                                         const Event* last) {
+          for (; first != last; ++first)
+          {
+            crop(*first);
+          }
+        });
 
-        if (batch.batch().size() > 0)
+        segmenter.flush();
+        if (index)
         {
-          std::cout << batch.batch().size() << '\n';
+          index->close();
         }
       });
 }
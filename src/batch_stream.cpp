@@ -0,0 +1,155 @@
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "event_batch.hpp"
+#include "pontella.hpp"
+
+int
+main(int argc, char* argv[])
+{
+  using namespace event_batch;
+
+  struct Arguments
+  {
+    uint64_t t_decay_first;
+    float weight_thresh;
+    BatchLimits limits;
+    double speed;
+    uint64_t read_timeout;
+    double profile_period;
+  };
+
+  return pontella::main(
+      {"batch_stream is an executable that estimates the size of batches of "
+       "events from a live source, and measures the latency of each batch",
+       "Usage: ./batch_stream [options] /path/to/input",
+       "    The input is either an Event Stream file replayed at the recorded "
+       "speed, or unix:/path/to/socket to read packed events from a UNIX "
+       "stream socket",
+       "    The latency statistics, from the arrival of the last event of a "
+       "batch to the completion of its handling, and the percentiles of the "
+       "close time, handle time, size and rate of the batches are sent to "
+       "the standard error",
+       "Available options:",
+       "    -t t, --time-decay-first t      sets the initial time decay",
+       "                                        defaults to 10000",
+       "    -e e, --weight-threshold e      sets the weight threshold",
+       "                                        defaults to 0.1",
+       "    -n n, --max-events n            sets the maximum number of events "
+       "of a batch, 0 is unbounded",
+       "                                        defaults to 0",
+       "    -d d, --max-duration d          sets the maximum time between the "
+       "first and last events of a batch [microseconds], 0 is unbounded",
+       "                                        defaults to 0",
+       "    -s s, --speed s                 sets the replay speed of an Event "
+       "Stream file, 0 replays as fast as possible",
+       "                                        defaults to 1",
+       "    -r r, --read-timeout r          sets the longest wait for events "
+       "[milliseconds], after which a silent stream closes the pending batch "
+       "on time, 0 waits indefinitely",
+       "                                        defaults to 1",
+       "    -p p, --profile-period p        also sends the percentiles of the "
+       "batches to the standard error every p seconds, 0 disables",
+       "                                        defaults to 0",
+       "    -h, --help                      shows this help message"},
+      argc, argv, 1,
+      {{"time-decay-first", {"t"}},
+       {"weight-threshold", {"e"}},
+       {"max-events", {"n"}},
+       {"max-duration", {"d"}},
+       {"speed", {"s"}},
+       {"read-timeout", {"r"}},
+       {"profile-period", {"p"}}},
+      {}, [&](pontella::command command) {
+        const std::string& input = command.arguments[0];
+
+        Arguments arguments;
+        arguments.t_decay_first =
+            extract_argument(command, "time-decay-first", 10000);
+        arguments.weight_thresh =
+            extract_argument(command, "weight-threshold", 0.1);
+        arguments.limits.max_events =
+            extract_argument(command, "max-events", std::size_t(0));
+        arguments.limits.max_duration =
+            extract_argument(command, "max-duration", uint64_t(0));
+        arguments.speed = extract_argument(command, "speed", 1.0);
+        arguments.read_timeout =
+            extract_argument(command, "read-timeout", uint64_t(1));
+        arguments.profile_period =
+            extract_argument(command, "profile-period", 0.0);
+
+        auto handle_batch = [](Span<const Event> batch) {
+          std::cout << batch.size() << '\n';
+        };
+
+        LatencyStatistics latency_statistics;
+        BatchProfile batch_profile;
+
+        // The histograms are lock-free, so they are displayed while batches
+        // are recorded
+        std::mutex mutex;
+        std::condition_variable stop_condition;
+        bool stop = false;
+        std::thread reporter;
+        if (arguments.profile_period > 0)
+        {
+          reporter = std::thread([&]() {
+            const auto period =
+                std::chrono::duration<double>(arguments.profile_period);
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stop_condition.wait_for(lock, period, [&] { return stop; }))
+            {
+              display_batch_profile(batch_profile, std::cerr);
+            }
+          });
+        }
+
+        auto stop_reporter = [&]() {
+          if (reporter.joinable())
+          {
+            {
+              std::lock_guard<std::mutex> lock(mutex);
+              stop = true;
+            }
+            stop_condition.notify_one();
+            reporter.join();
+          }
+        };
+
+        const std::chrono::milliseconds read_timeout(arguments.read_timeout);
+        try
+        {
+          const std::string socket_prefix = "unix:";
+          if (input.compare(0, socket_prefix.size(), socket_prefix) == 0)
+          {
+            SocketEventSource source(input.substr(socket_prefix.size()),
+                                     read_timeout);
+            stream_batches(source, arguments.t_decay_first,
+                           arguments.weight_thresh, handle_batch,
+                           latency_statistics, batch_profile, 4096,
+                           arguments.limits);
+          }
+          else
+          {
+            ReplayEventSource source(input, arguments.speed, read_timeout);
+            stream_batches(source, arguments.t_decay_first,
+                           arguments.weight_thresh, handle_batch,
+                           latency_statistics, batch_profile, 4096,
+                           arguments.limits);
+          }
+        }
+        catch (...)
+        {
+          stop_reporter();
+          throw;
+        }
+        stop_reporter();
+        std::cout.flush();
+        display_latency_statistics(latency_statistics, std::cerr);
+        display_batch_profile(batch_profile, std::cerr);
+      });
+}
@@ -0,0 +1,83 @@
+#include <stdexcept>
+#include <string>
+
+#include "event_batch.hpp"
+#include "pontella.hpp"
+
+int
+main(int argc, char* argv[])
+{
+  using namespace event_batch;
+
+  struct Arguments
+  {
+    uint64_t t_decay_first;
+    float weight_thresh;
+    BatchLimits limits;
+    uint16_t tile_width;
+    uint16_t tile_height;
+  };
+
+  return pontella::main(
+      {"batch_tiles is an executable that estimates the size of batches of "
+       "events of each tile of the sensor from an Event Stream file",
+       "Usage: ./batch_tiles [options] /path/to/input.es",
+       "    Each line of the output is the index of a tile, row by row from "
+       "the bottom-left corner, and the size of one of its batches",
+       "Available options:",
+       "    -t t, --time-decay-first t      sets the initial time decay",
+       "                                        defaults to 10000",
+       "    -e e, --weight-threshold e      sets the weight threshold",
+       "                                        defaults to 0.1",
+       "    -n n, --max-events n            sets the maximum number of events "
+       "of a batch, 0 is unbounded",
+       "                                        defaults to 0",
+       "    -d d, --max-duration d          sets the maximum time between the "
+       "first and last events of a batch [microseconds], 0 is unbounded",
+       "                                        defaults to 0",
+       "    -tw tw, --tile-width tw         sets the width of the tiles",
+       "                                        defaults to 32",
+       "    -th th, --tile-height th        sets the height of the tiles",
+       "                                        defaults to 32",
+       "    -h, --help                      shows this help message"},
+      argc, argv, 1,
+      {{"time-decay-first", {"t"}},
+       {"weight-threshold", {"e"}},
+       {"max-events", {"n"}},
+       {"max-duration", {"d"}},
+       {"tile-width", {"tw"}},
+       {"tile-height", {"th"}}},
+      {}, [&](pontella::command command) {
+        const std::string& filename = command.arguments[0];
+        const MappedEventStream event_stream(filename);
+        const auto& header = event_stream.header();
+
+        Arguments arguments;
+        arguments.t_decay_first =
+            extract_argument(command, "time-decay-first", 10000);
+        arguments.weight_thresh =
+            extract_argument(command, "weight-threshold", 0.1);
+        arguments.limits.max_events =
+            extract_argument(command, "max-events", std::size_t(0));
+        arguments.limits.max_duration =
+            extract_argument(command, "max-duration", uint64_t(0));
+        arguments.tile_width = extract_argument(command, "tile-width", 32);
+        arguments.tile_height = extract_argument(command, "tile-height", 32);
+        if (arguments.tile_width == 0 || arguments.tile_height == 0)
+        {
+          throw std::runtime_error("the tile size must be positive");
+        }
+
+        auto tiled_decay = make_tiled_decay<Event>(
+            header.width, header.height, arguments.tile_width,
+            arguments.tile_height, arguments.t_decay_first,
+            arguments.weight_thresh,
+            [](std::size_t tile, Span<const Event> batch) {
+              std::cout << tile << ',' << batch.size() << '\n';
+            },
+            arguments.limits);
+
+        for_each_block(event_stream, tiled_decay);
+        tiled_decay.flush();
+      });
+}
@@ -2,16 +2,12 @@
 
 #include "event_batch.hpp"
 #include "pontella.hpp"
-#include "sepia.hpp"
 
 int
 main(int argc, char* argv[])
 {
   using namespace event_batch;
 
-  typedef sepia::dvs_event Event;
-  constexpr sepia::type Type = sepia::type::dvs;
-
   struct Arguments
   {
     uint64_t t_decay_first;
@@ -27,12 +23,15 @@ main(int argc, char* argv[])
        "                                        defaults to 10000",
        "    -e e, --weight-threshold e      sets the weight threshold",
        "                                        defaults to 0.1",
+       "    -p, --batch-profile             also displays the percentiles of "
+       "the close time, handle time, size and rate of the batches",
+       "    -c, --hardware-counters         reports the hardware counters per "
+       "event, where available",
        "    -h, --help                      shows this help message"},
       argc, argv, 1, {{"time-decay-first", {"t"}}, {"weight-threshold", {"e"}}},
-      {}, [&](pontella::command command) {
+      {{"batch-profile", {"p"}}, {"hardware-counters", {"c"}}},
+      [&](pontella::command command) {
         const std::string& filename = command.arguments[0];
-        const StreamStatistics stream_statistics =
-            stream_statistics_from_file<Type, Event>(filename);
 
         Arguments arguments;
         arguments.t_decay_first =
@@ -41,37 +40,57 @@ main(int argc, char* argv[])
             extract_argument(command, "weight-threshold", 0.1);
 
         TicToc t;
+        HardwareCounters counters(command.flags.find("hardware-counters") !=
+                                  command.flags.end());
 
-        Decay event_decay;
-        auto handle_decay = [&](Decay decay) { event_decay = decay; };
-
-        auto global_decay = make_global_decay<Event>(
-            arguments.t_decay_first,
-            [](Event event, float decay, float n_decay, float t_decay,
-               float rate) -> Decay {
-              return {event.t, decay, n_decay, t_decay, rate};
-            },
-            handle_decay);
-
-        StdVector<Event> event_batch;
-        auto handle_batch = [&](StdVector<Event> batch) {
-          event_batch = batch;
+        uint64_t t_first = 0;
+        uint64_t t_last = 0;
+        std::size_t batch_size = 0;
+        auto handle_batch = [&](Span<const Event> batch) {
+          t_first = batch.front().t;
+          t_last = batch.back().t;
+          batch_size = batch.size();
         };
 
-        auto batch = make_batch<Event>(arguments.weight_thresh, event_decay,
-                                       handle_batch);
+        const bool profile =
+            command.flags.find("batch-profile") != command.flags.end();
+        BatchProfile batch_profile;
+        const Decay* decay = nullptr;
+        auto segmenter = make_adaptive_segmenter<Event>(
+            arguments.t_decay_first, arguments.weight_thresh,
+            [&](Span<const Event> batch) {
+              if (profile)
+              {
+                batch_profile.record(batch, *decay, handle_batch);
+              }
+              else
+              {
+                handle_batch(batch);
+              }
+            });
+        decay = &segmenter.batch_decay();
+
+        StreamStatistics stream_statistics;
+        auto event_stream_statistics =
+            make_stream_statistics_tap<Event>(stream_statistics);
 
+        counters.tic();
         t.tic();
-        sepia::join_observable<Type>(sepia::filename_to_ifstream(filename),
-                                     [&](Event event) {
-                                       global_decay(event);
-                                       batch(event);
-                                     });
+        const MappedEventStream event_stream(filename);
+        for_each_block(event_stream,
+                       [&](const Event* first, const Event* last) {
+                         event_stream_statistics(first, last);
+                         segmenter(first, last);
+                       });
         const double t_diff = t.toc<TicToc::MicroSeconds>();
+        const HardwareCounts counts = counters.toc();
 
-        std::cout << "t first: " << event_batch.front().t
-                  << ", t last: " << event_batch.back().t
-                  << ", size: " << event_batch.size() << '\n';
-        display_runtime_statistics(t_diff, stream_statistics);
+        std::cout << "t first: " << t_first << ", t last: " << t_last
+                  << ", size: " << batch_size << '\n';
+        display_runtime_statistics(t_diff, stream_statistics, counts);
+        if (profile)
+        {
+          display_batch_profile(batch_profile);
+        }
       });
 }
@@ -16,19 +16,26 @@ main(int argc, char* argv[])
        "the number of events and duration from an Event Stream file",
        "Usage: ./runtime_event_stream_statistics [options] /path/to/input.es",
        "Available options:",
+       "    -c, --hardware-counters    reports the hardware counters per "
+       "event, where available",
        "    -h, --help                 shows this help message"},
-      argc, argv, 1, {}, {}, [](pontella::command command) {
+      argc, argv, 1, {}, {{"hardware-counters", {"c"}}},
+      [](pontella::command command) {
         const std::string& filename = command.arguments[0];
 
         TicToc t;
+        HardwareCounters counters(command.flags.find("hardware-counters") !=
+                                  command.flags.end());
 
+        counters.tic();
         t.tic();
         const StreamStatistics stream_statistics =
             stream_statistics_from_file<sepia::type::dvs, Event>(filename);
         const double t_diff = t.toc<TicToc::MicroSeconds>();
+        const HardwareCounts counts = counters.toc();
 
         std::cout << "t: " << stream_statistics.t
                   << ", t first: " << stream_statistics.t_first << '\n';
-        display_runtime_statistics(t_diff, stream_statistics);
+        display_runtime_statistics(t_diff, stream_statistics, counts);
       });
 }
@@ -2,16 +2,12 @@
 
 #include "event_batch.hpp"
 #include "pontella.hpp"
-#include "sepia.hpp"
 
 int
 main(int argc, char* argv[])
 {
   using namespace event_batch;
 
-  typedef sepia::dvs_event Event;
-  constexpr sepia::type Type = sepia::type::dvs;
-
   struct Arguments
   {
     uint64_t t_decay_first;
@@ -24,18 +20,23 @@ main(int argc, char* argv[])
        "Available options:",
        "    -t t, --time-decay-first t      sets the initial time decay",
        "                                        defaults to 10000",
+       "    -s, --structure-of-arrays       decodes the events into "
+       "structure-of-arrays blocks, so that only the timestamps are read",
+       "    -c, --hardware-counters         reports the hardware counters per "
+       "event, where available",
        "    -h, --help                      shows this help message"},
-      argc, argv, 1, {{"time-decay-first", {"t"}}}, {},
+      argc, argv, 1, {{"time-decay-first", {"t"}}},
+      {{"structure-of-arrays", {"s"}}, {"hardware-counters", {"c"}}},
       [](pontella::command command) {
         const std::string& filename = command.arguments[0];
-        const StreamStatistics stream_statistics =
-            stream_statistics_from_file<Type, Event>(filename);
 
         Arguments arguments;
         arguments.t_decay_first =
             extract_argument(command, "time-decay-first", 10000);
 
         TicToc t;
+        HardwareCounters counters(command.flags.find("hardware-counters") !=
+                                  command.flags.end());
 
         Decay event_decay;
         auto handle_decay = [&](Decay decay) { event_decay = decay; };
@@ -48,15 +49,35 @@ main(int argc, char* argv[])
             },
             handle_decay);
 
+        StreamStatistics stream_statistics;
+        auto event_stream_statistics =
+            make_stream_statistics_tap<Event>(stream_statistics);
+
+        counters.tic();
         t.tic();
-        sepia::join_observable<Type>(sepia::filename_to_ifstream(filename),
-                                     global_decay);
+        const MappedEventStream event_stream(filename);
+        if (command.flags.find("structure-of-arrays") != command.flags.end())
+        {
+          for_each_event_block(event_stream, [&](const EventBlock& block) {
+            event_stream_statistics(block);
+            global_decay(block);
+          });
+        }
+        else
+        {
+          for_each_block(event_stream,
+                         [&](const Event* first, const Event* last) {
+                           event_stream_statistics(first, last);
+                           global_decay(first, last);
+                         });
+        }
         const double t_diff = t.toc<TicToc::MicroSeconds>();
+        const HardwareCounts counts = counters.toc();
 
         std::cout << "t: " << event_decay.t << ", decay: " << event_decay.decay
                   << ", n decay: " << event_decay.n_decay
                   << ", t decay: " << event_decay.t_decay
                   << ", rate: " << event_decay.rate << '\n';
-        display_runtime_statistics(t_diff, stream_statistics);
+        display_runtime_statistics(t_diff, stream_statistics, counts);
       });
 }
@@ -0,0 +1,272 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+#include "event_batch.hpp"
+
+namespace
+{
+using namespace event_batch;
+
+/**
+ * @brief Number of events of each synthetic stream.
+ */
+constexpr std::size_t number_events = 1 << 18;
+
+/**
+ * @brief Returns the synthetic stream of a benchmark, generated once.
+ *
+ * @param state Benchmark state, whose first two arguments are the profile and
+ * the rate [events/second] of the stream.
+ *
+ * @return Events of the stream.
+ */
+const StdVector<Event>&
+synthetic_stream(const benchmark::State& state)
+{
+  static std::map<std::pair<int64_t, int64_t>, StdVector<Event>> streams;
+  const std::pair<int64_t, int64_t> key(state.range(0), state.range(1));
+  auto stream = streams.find(key);
+  if (stream == streams.end())
+  {
+    stream = streams
+                 .emplace(key, make_synthetic_stream(
+                                   static_cast<StreamProfile>(key.first),
+                                   static_cast<double>(key.second),
+                                   number_events))
+                 .first;
+  }
+  return stream->second;
+}
+
+/**
+ * @brief Reports the time per event and labels the benchmark with the
+ * profile of its stream.
+ *
+ * @param state Benchmark state.
+ * @param size Number of events processed per iteration.
+ */
+void
+report_per_event(benchmark::State& state, const std::size_t size)
+{
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(size));
+  state.counters["per_event"] = benchmark::Counter(
+      static_cast<double>(size), benchmark::Counter::kIsIterationInvariantRate |
+                                     benchmark::Counter::kInvert);
+  state.SetLabel(
+      stream_profile_name(static_cast<StreamProfile>(state.range(0))));
+}
+
+/**
+ * @brief Returns the decay of an event.
+ */
+const auto event_to_decay = [](Event event, float decay, float n_decay,
+                               float t_decay, float rate) -> Decay {
+  return {event.t, decay, n_decay, t_decay, rate};
+};
+
+void
+global_decay_event(benchmark::State& state)
+{
+  const StdVector<Event>& events = synthetic_stream(state);
+  Decay event_decay;
+  auto global_decay = make_global_decay<Event>(
+      10000, event_to_decay, [&](Decay decay) { event_decay = decay; });
+  for (auto _ : state)
+  {
+    global_decay.reset();
+    for (const Event& event : events)
+    {
+      global_decay(event);
+    }
+    benchmark::DoNotOptimize(event_decay);
+  }
+  report_per_event(state, events.size());
+}
+
+void
+global_decay_block(benchmark::State& state)
+{
+  const StdVector<Event>& events = synthetic_stream(state);
+  Decay event_decay;
+  auto global_decay = make_global_decay<Event>(
+      10000, event_to_decay, [&](Decay decay) { event_decay = decay; });
+  StdVector<Decay> decays(events.size());
+  for (auto _ : state)
+  {
+    global_decay.reset();
+    global_decay(events.data(), events.data() + events.size(), decays.data());
+    benchmark::DoNotOptimize(decays.data());
+  }
+  report_per_event(state, events.size());
+}
+
+void
+batch_block(benchmark::State& state)
+{
+  const StdVector<Event>& events = synthetic_stream(state);
+  const float weight_thresh = 1e-3f * static_cast<float>(state.range(2));
+  Decay event_decay;
+  auto global_decay = make_global_decay<Event>(
+      10000, event_to_decay, [&](Decay decay) { event_decay = decay; });
+  StdVector<Decay> decays(events.size());
+  global_decay(events.data(), events.data() + events.size(), decays.data());
+
+  std::size_t number_batches = 0;
+  auto batch =
+      make_batch<Event>(weight_thresh, event_decay,
+                        [&](Span<const Event>) { ++number_batches; });
+  for (auto _ : state)
+  {
+    batch.reset();
+    batch(events.data(), events.data() + events.size(), decays.data());
+  }
+  report_per_event(state, events.size());
+  state.counters["batches"] = benchmark::Counter(
+      static_cast<double>(number_batches), benchmark::Counter::kAvgIterations);
+}
+
+void
+adaptive_segmenter_block(benchmark::State& state)
+{
+  const StdVector<Event>& events = synthetic_stream(state);
+  const float weight_thresh = 1e-3f * static_cast<float>(state.range(2));
+  std::size_t number_batches = 0;
+  auto segmenter = make_adaptive_segmenter<Event>(
+      10000, weight_thresh, [&](Span<const Event>) { ++number_batches; });
+  for (auto _ : state)
+  {
+    segmenter.reset();
+    segmenter(events.data(), events.data() + events.size());
+  }
+  report_per_event(state, events.size());
+  state.counters["batches"] = benchmark::Counter(
+      static_cast<double>(number_batches), benchmark::Counter::kAvgIterations);
+}
+
+/**
+ * @brief Measures the time per event of the decay arithmetic, and its largest
+ * relative drift from extended precision over the stream.
+ *
+ * @tparam Scalar Type of the decay arithmetic.
+ *
+ * @param state Benchmark state.
+ */
+template <typename Scalar>
+void
+decay_arithmetic(benchmark::State& state)
+{
+  const StdVector<Event>& events = synthetic_stream(state);
+  BasicDecay<long double> reference;
+  reference.reset(10000);
+  BasicDecay<Scalar> decay;
+  decay.reset(10000);
+  double drift = 0;
+  for (const Event& event : events)
+  {
+    reference.update(event.t);
+    decay.update(event.t);
+    const long double rate = static_cast<long double>(decay.rate);
+    drift = std::max(
+        drift, static_cast<double>(std::fabs(rate - reference.rate) /
+                                   reference.rate));
+  }
+
+  for (auto _ : state)
+  {
+    decay.reset(10000);
+    for (const Event& event : events)
+    {
+      decay.update(event.t);
+    }
+    benchmark::DoNotOptimize(decay);
+  }
+  report_per_event(state, events.size());
+  state.counters["drift"] = drift;
+}
+
+void
+event_stream_statistics_event(benchmark::State& state)
+{
+  const StdVector<Event>& events = synthetic_stream(state);
+  StreamStatistics stream_statistics;
+  for (auto _ : state)
+  {
+    auto event_stream_statistics =
+        make_stream_statistics_tap<Event>(stream_statistics);
+    for (const Event& event : events)
+    {
+      event_stream_statistics(event);
+    }
+    benchmark::DoNotOptimize(stream_statistics);
+  }
+  report_per_event(state, events.size());
+}
+
+void
+decode_block(benchmark::State& state)
+{
+  const StdVector<Event>& events = synthetic_stream(state);
+  StdVector<uint8_t> bytes;
+  encode_dvs_events(events.data(), events.data() + events.size(), bytes);
+  StdVector<Event> block(4096);
+  for (auto _ : state)
+  {
+    DvsDecoder decoder(320, 240);
+    const uint8_t* byte = bytes.data();
+    while (byte != bytes.data() + bytes.size())
+    {
+      decoder(byte, bytes.data() + bytes.size(), block.data(),
+              block.data() + block.size());
+      benchmark::DoNotOptimize(block.data());
+    }
+  }
+  report_per_event(state, events.size());
+}
+
+/**
+ * @brief Arguments of the benchmarks: stream profile and rate
+ * [events/second].
+ */
+void
+stream_arguments(benchmark::internal::Benchmark* benchmark)
+{
+  benchmark->ArgNames({"profile", "rate"});
+  benchmark->ArgsProduct({{static_cast<int64_t>(StreamProfile::constant),
+                           static_cast<int64_t>(StreamProfile::poisson),
+                           static_cast<int64_t>(StreamProfile::bursty)},
+                          {100000, 1000000, 10000000}});
+}
+
+/**
+ * @brief Arguments of the batch benchmarks: stream profile, rate
+ * [events/second] and weight threshold [thousandths].
+ */
+void
+batch_arguments(benchmark::internal::Benchmark* benchmark)
+{
+  benchmark->ArgNames({"profile", "rate", "weight_thresh_1e-3"});
+  benchmark->ArgsProduct({{static_cast<int64_t>(StreamProfile::constant),
+                           static_cast<int64_t>(StreamProfile::poisson),
+                           static_cast<int64_t>(StreamProfile::bursty)},
+                          {100000, 1000000, 10000000},
+                          {50, 100, 200, 500}});
+}
+}  // namespace
+
+BENCHMARK(global_decay_event)->Apply(stream_arguments);
+BENCHMARK(global_decay_block)->Apply(stream_arguments);
+BENCHMARK(batch_block)->Apply(batch_arguments);
+BENCHMARK(adaptive_segmenter_block)->Apply(batch_arguments);
+BENCHMARK_TEMPLATE(decay_arithmetic, float)->Apply(stream_arguments);
+BENCHMARK_TEMPLATE(decay_arithmetic, double)->Apply(stream_arguments);
+BENCHMARK_TEMPLATE(decay_arithmetic, FixedPoint<>)->Apply(stream_arguments);
+BENCHMARK(event_stream_statistics_event)->Apply(stream_arguments);
+BENCHMARK(decode_block)->Apply(stream_arguments);
+
+BENCHMARK_MAIN();
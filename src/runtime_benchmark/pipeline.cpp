@@ -0,0 +1,104 @@
+#include <chrono>
+#include <string>
+
+#include "event_batch.hpp"
+#include "pontella.hpp"
+
+int
+main(int argc, char* argv[])
+{
+  using namespace event_batch;
+
+  struct Arguments
+  {
+    uint64_t t_decay_first;
+    float weight_thresh;
+    uint64_t t_handle;
+  };
+
+  return pontella::main(
+      {"runtime_pipeline is a runtime benchmark that estimates batches of "
+       "events from an Event Stream file with a slow batch handle, first "
+       "synchronously and then with decoding, estimation and batch handling "
+       "on separate threads",
+       "Usage: ./runtime_pipeline [options] /path/to/input.es",
+       "Available options:",
+       "    -t t, --time-decay-first t      sets the initial time decay",
+       "                                        defaults to 10000",
+       "    -e e, --weight-threshold e      sets the weight threshold",
+       "                                        defaults to 0.1",
+       "    -d d, --handle-duration d       sets the time spent by the batch "
+       "handle on each batch [microseconds]",
+       "                                        defaults to 100",
+       "    -c, --hardware-counters         reports the hardware counters per "
+       "event, where available",
+       "    -h, --help                      shows this help message"},
+      argc, argv, 1,
+      {{"time-decay-first", {"t"}},
+       {"weight-threshold", {"e"}},
+       {"handle-duration", {"d"}}},
+      {{"hardware-counters", {"c"}}}, [&](pontella::command command) {
+        const std::string& filename = command.arguments[0];
+
+        Arguments arguments;
+        arguments.t_decay_first =
+            extract_argument(command, "time-decay-first", 10000);
+        arguments.weight_thresh =
+            extract_argument(command, "weight-threshold", 0.1);
+        arguments.t_handle = extract_argument(command, "handle-duration", 100);
+
+        // Stands for a feature extractor that busies its core
+        std::size_t number_batches = 0;
+        auto handle_batch = [&](Span<const Event>) {
+          const auto t_end = std::chrono::steady_clock::now() +
+                             std::chrono::microseconds(arguments.t_handle);
+          while (std::chrono::steady_clock::now() < t_end)
+          {
+          }
+          ++number_batches;
+        };
+
+        TicToc t;
+        HardwareCounters counters(command.flags.find("hardware-counters") !=
+                                  command.flags.end());
+        StreamStatistics stream_statistics;
+        auto event_stream_statistics =
+            make_stream_statistics_tap<Event>(stream_statistics);
+
+        counters.tic();
+        t.tic();
+        {
+          const MappedEventStream event_stream(filename);
+          auto segmenter = make_adaptive_segmenter<Event>(
+              arguments.t_decay_first, arguments.weight_thresh, handle_batch);
+          for_each_block(event_stream,
+                         [&](const Event* first, const Event* last) {
+                           event_stream_statistics(first, last);
+                           segmenter(first, last);
+                         });
+          segmenter.flush();
+        }
+        const double t_synchronous = t.toc<TicToc::MicroSeconds>();
+        const HardwareCounts counts_synchronous = counters.toc();
+        std::cout << "synchronous, batches: " << number_batches << '\n';
+        display_runtime_statistics(t_synchronous, stream_statistics,
+                                   counts_synchronous);
+
+        number_batches = 0;
+        counters.tic();
+        t.tic();
+        {
+          const MappedEventStream event_stream(filename);
+          run_pipeline<Event>(
+              [&](auto&& handle_block) {
+                for_each_block(event_stream, handle_block);
+              },
+              arguments.t_decay_first, arguments.weight_thresh, handle_batch);
+        }
+        const double t_pipeline = t.toc<TicToc::MicroSeconds>();
+        const HardwareCounts counts_pipeline = counters.toc();
+        std::cout << "pipeline, batches: " << number_batches << '\n';
+        display_runtime_statistics(t_pipeline, stream_statistics,
+                                   counts_pipeline);
+      });
+}
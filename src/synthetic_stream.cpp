@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "event_batch.hpp"
+#include "pontella.hpp"
+
+int
+main(int argc, char* argv[])
+{
+  using namespace event_batch;
+
+  return pontella::main(
+      {"synthetic_stream is an executable that writes a synthetic DVS Event "
+       "Stream file with a known rate",
+       "Usage: ./synthetic_stream [options] /path/to/output.es",
+       "    The output is the number of events, the duration [microseconds] "
+       "and the mean ground-truth rate [events/second] of the stream",
+       "Available options:",
+       "    -pr pr, --profile pr            sets the activity profile, one of "
+       "constant, poisson, bursty, step or sinusoid",
+       "                                        defaults to poisson",
+       "    -r r, --rate r                  sets the base rate "
+       "[events/second]",
+       "                                        defaults to 1000000",
+       "    -rp rp, --rate-peak rp          sets the peak rate of the bursty, "
+       "step and sinusoid profiles [events/second]",
+       "                                        defaults to 10000000",
+       "    -pe pe, --period pe             sets the period of the bursty, "
+       "step and sinusoid profiles [microseconds]",
+       "                                        defaults to 100000",
+       "    -d d, --duty-cycle d            sets the fraction of the period "
+       "spent in a burst",
+       "                                        defaults to 0.1",
+       "    -hp hp, --hot-pixels hp         sets the number of hot pixels",
+       "                                        defaults to 0",
+       "    -hr hr, --hot-pixel-rate hr     sets the rate of each hot pixel "
+       "[events/second]",
+       "                                        defaults to 0",
+       "    -n n, --number-events n         sets the number of events",
+       "                                        defaults to 10000000",
+       "    -wi wi, --width wi              sets the width of the sensor",
+       "                                        defaults to 320",
+       "    -he he, --height he             sets the height of the sensor",
+       "                                        defaults to 240",
+       "    -s s, --seed s                  sets the seed of the random "
+       "generator",
+       "                                        defaults to 0",
+       "    -h, --help                      shows this help message"},
+      argc, argv, 1,
+      {{"profile", {"pr"}},
+       {"rate", {"r"}},
+       {"rate-peak", {"rp"}},
+       {"period", {"pe"}},
+       {"duty-cycle", {"d"}},
+       {"hot-pixels", {"hp"}},
+       {"hot-pixel-rate", {"hr"}},
+       {"number-events", {"n"}},
+       {"width", {"wi"}},
+       {"height", {"he"}},
+       {"seed", {"s"}}},
+      {}, [&](pontella::command command) {
+        const std::string& filename = command.arguments[0];
+
+        SyntheticStreamParameters parameters;
+        parameters.profile = parse_stream_profile(
+            extract_argument(command, "profile", std::string("poisson")));
+        parameters.rate = extract_argument(command, "rate", parameters.rate);
+        parameters.rate_peak =
+            extract_argument(command, "rate-peak", parameters.rate_peak);
+        parameters.period =
+            extract_argument(command, "period", parameters.period);
+        parameters.duty_cycle =
+            extract_argument(command, "duty-cycle", parameters.duty_cycle);
+        parameters.hot_pixels =
+            extract_argument(command, "hot-pixels", parameters.hot_pixels);
+        parameters.hot_pixel_rate = extract_argument(
+            command, "hot-pixel-rate", parameters.hot_pixel_rate);
+        parameters.width = extract_argument(command, "width", parameters.width);
+        parameters.height =
+            extract_argument(command, "height", parameters.height);
+        parameters.seed = extract_argument(command, "seed", parameters.seed);
+        const uint64_t number_events =
+            extract_argument(command, "number-events", uint64_t(10000000));
+
+        SyntheticStreamGenerator generator(parameters);
+        EventStreamWriter writer(filename, parameters.width,
+                                 parameters.height);
+        StdVector<Event> block(65536);
+        uint64_t t_last = 0;
+        for (uint64_t i = 0; i < number_events; i += block.size())
+        {
+          const std::size_t size = static_cast<std::size_t>(
+              std::min<uint64_t>(block.size(), number_events - i));
+          generator(block.data(), block.data() + size);
+          writer(block.data(), block.data() + size);
+          t_last = block[size - 1].t;
+        }
+        writer.close();
+
+        std::cout << number_events << ',' << t_last << ','
+                  << generator.mean_rate() << '\n';
+      });
+}
@@ -0,0 +1,242 @@
+#include "event_batch/adaptive_segmenter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <utility>
+
+#include "event_batch/batch.hpp"
+#include "event_batch/global_decay.hpp"
+#include "event_batch/synthetic_stream.hpp"
+#include "event_batch/types.hpp"
+
+TEST(event_batch, AdaptiveSegmenter)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.1;
+
+  StdVector<Event> events;
+  uint64_t t = 0;
+  for (uint64_t i = 0; i < 50000; ++i)
+  {
+    // Alternate between fast and slow motions
+    t += ((i / 5000) % 2 == 0) ? 1 + i % 3 : 40 + i % 17;
+    events.push_back({t, static_cast<uint16_t>(i % 320),
+                      static_cast<uint16_t>(i % 240),
+                      static_cast<uint16_t>(i % 2)});
+  }
+
+  Decay event_decay;
+  auto global_decay = make_global_decay<Event>(
+      t_decay_first,
+      [](Event event, float decay, float n_decay, float t_decay,
+         float rate) -> Decay {
+        return {event.t, decay, n_decay, t_decay, rate};
+      },
+      [&](Decay decay) { event_decay = decay; });
+  StdVector<uint64_t> batch_ts;
+  auto batch = make_batch<Event>(
+      weight_thresh, event_decay,
+      [&](Span<const Event> batch) { batch_ts.push_back(batch.back().t); });
+  for (const Event& event : events)
+  {
+    global_decay(event);
+    batch(event);
+  }
+
+  StdVector<uint64_t> segmenter_ts;
+  auto segmenter = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh,
+      [&](Span<const Event> batch) { segmenter_ts.push_back(batch.back().t); });
+  for (const Event& event : events)
+  {
+    segmenter(event);
+  }
+
+  EXPECT_GT(batch_ts.size(), 1);
+  EXPECT_EQ(segmenter_ts, batch_ts);
+  EXPECT_EQ(segmenter.batch().size(), batch.batch().size());
+  EXPECT_EQ(segmenter.decay().n_decay, event_decay.n_decay);
+  EXPECT_EQ(segmenter.decay().t_decay, event_decay.t_decay);
+  EXPECT_EQ(segmenter.decay().rate, event_decay.rate);
+
+  StdVector<uint64_t> block_ts;
+  auto segmenter_block = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh,
+      [&](Span<const Event> batch) { block_ts.push_back(batch.back().t); });
+  segmenter_block(events.data(), events.data() + events.size() / 3);
+  segmenter_block(events.data() + events.size() / 3,
+                  events.data() + events.size());
+  EXPECT_EQ(block_ts, batch_ts);
+  // The vectorized decay kernel rounds differently
+  EXPECT_NEAR(segmenter_block.decay().rate, event_decay.rate,
+              1e-5 * event_decay.rate);
+
+  // Moving the segmenter keeps its decay state valid
+  const float rate = segmenter_block.decay().rate;
+  auto moved_segmenter = std::move(segmenter_block);
+  EXPECT_EQ(moved_segmenter.decay().rate, rate);
+}
+
+TEST(event_batch, AdaptiveSegmenterFlushUntil)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.9;
+
+  StdVector<std::size_t> batch_sizes;
+  auto segmenter = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh,
+      [&](Span<const Event> batch) { batch_sizes.push_back(batch.size()); });
+  EXPECT_EQ(segmenter.closing_time(), ~static_cast<uint64_t>(0));
+
+  segmenter(Event{0, 120, 90, 0});
+  segmenter(Event{10, 240, 180, 1});
+  EXPECT_EQ(batch_sizes.size(), 0);
+
+  const uint64_t t_close = segmenter.closing_time();
+  EXPECT_GT(t_close, 10);
+  EXPECT_FALSE(segmenter.flush_until(t_close - 1));
+  EXPECT_EQ(batch_sizes.size(), 0);
+  EXPECT_TRUE(segmenter.flush_until(t_close));
+  EXPECT_EQ(batch_sizes, StdVector<std::size_t>({2}));
+  EXPECT_TRUE(segmenter.batch().empty());
+  EXPECT_FALSE(segmenter.flush_until(t_close));
+
+  // An event pushed at the closing time closes the batch, one pushed a
+  // microsecond earlier does not, whatever the threshold
+  for (const float thresh : {0.9f, 0.5f, 0.1f, 0.01f})
+  {
+    for (const uint64_t t_last : {10, 1000, 100000})
+    {
+      const auto push_at = [&](const uint64_t t_now) {
+        StdVector<std::size_t> sizes;
+        auto pushed = make_adaptive_segmenter<Event>(
+            t_decay_first, thresh,
+            [&](Span<const Event> batch) { sizes.push_back(batch.size()); });
+        pushed(Event{0, 120, 90, 0});
+        pushed(Event{t_last, 240, 180, 1});
+        const uint64_t t_predicted = pushed.closing_time();
+        if (t_now > t_last)
+        {
+          pushed(Event{t_now, 0, 0, 0});
+        }
+        return std::make_pair(t_predicted, sizes);
+      };
+      const auto [t_predicted, sizes] = push_at(0);
+      if (!sizes.empty())
+      {
+        continue;
+      }
+      EXPECT_GT(t_predicted, t_last);
+      EXPECT_LT(t_predicted, ~static_cast<uint64_t>(0));
+      EXPECT_EQ(push_at(t_predicted).second,
+                StdVector<std::size_t>({3}));
+      if (t_predicted - 1 > t_last)
+      {
+        EXPECT_TRUE(push_at(t_predicted - 1).second.empty());
+      }
+    }
+  }
+}
+
+TEST(event_batch, AdaptiveSegmenterLimits)
+{
+  using namespace event_batch;
+
+  BatchLimits limits;
+  limits.max_events = 4;
+  limits.max_duration = 25;
+
+  // A zero weight threshold never closes a batch on its own
+  const StdVector<Event> events{{0, 0, 0, 0},  {1, 0, 0, 0},  {2, 0, 0, 0},
+                                {3, 0, 0, 0},  {4, 0, 0, 0},  {5, 0, 0, 0},
+                                {10, 0, 0, 0}, {40, 0, 0, 0}, {50, 0, 0, 0},
+                                {60, 0, 0, 0}, {70, 0, 0, 0}};
+  for (const bool blocks : {false, true})
+  {
+    StdVector<std::size_t> batch_sizes;
+    const Decay* batch_decay = nullptr;
+    auto segmenter = make_adaptive_segmenter<Event>(
+        10000, 0.0f,
+        [&](Span<const Event> batch) {
+          batch_sizes.push_back(batch.size());
+          EXPECT_LE(batch.back().t - batch.front().t, limits.max_duration);
+          // The decay of a batch closed by the next event excludes that event
+          EXPECT_EQ(batch_decay->t, batch.back().t);
+        },
+        0, limits);
+    batch_decay = &segmenter.batch_decay();
+    EXPECT_GE(segmenter.batch().capacity(), 4);
+    if (blocks)
+    {
+      segmenter(events.data(), events.data() + events.size());
+    }
+    else
+    {
+      for (const Event& event : events)
+      {
+        segmenter(event);
+      }
+    }
+    EXPECT_EQ(batch_sizes, StdVector<std::size_t>({4, 3, 3}));
+    EXPECT_EQ(segmenter.batch().size(), 1);
+
+    // The maximum duration bounds the closing time of the pending batch
+    EXPECT_EQ(segmenter.closing_time(), 96);
+    EXPECT_FALSE(segmenter.flush_until(95));
+    EXPECT_TRUE(segmenter.flush_until(96));
+    EXPECT_EQ(batch_sizes.back(), 1);
+  }
+}
+
+TEST(event_batch, AdaptiveSegmenterScalar)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.1;
+  const StdVector<Event> events = make_synthetic_stream(
+      StreamProfile::step, 1e6, 100000, 320, 240, 3);
+
+  // Every arithmetic splits the stream alike, one event at a time or by
+  // blocks, up to the rounding of the boundaries
+  auto batch_sizes = [&](auto scalar, const bool blocks) {
+    typedef decltype(scalar) Scalar;
+    StdVector<std::size_t> sizes;
+    auto segmenter = make_basic_adaptive_segmenter<Scalar, Event>(
+        t_decay_first, weight_thresh,
+        [&](Span<const Event> batch) { sizes.push_back(batch.size()); });
+    if (blocks)
+    {
+      segmenter(events.data(), events.data() + events.size());
+    }
+    else
+    {
+      for (const Event& event : events)
+      {
+        segmenter(event);
+      }
+    }
+    EXPECT_EQ(segmenter.decay().t, events.back().t);
+    EXPECT_LT(segmenter.closing_time(), ~static_cast<uint64_t>(0));
+    return sizes;
+  };
+  const StdVector<std::size_t> reference = batch_sizes(0.0, false);
+  EXPECT_GT(reference.size(), 10);
+  EXPECT_EQ(batch_sizes(0.0, true), reference);
+  for (const auto& sizes : {batch_sizes(0.0f, true),
+                            batch_sizes(FixedPoint<>(), true),
+                            batch_sizes(FixedPoint<>(), false)})
+  {
+    ASSERT_EQ(sizes.size(), reference.size());
+    for (std::size_t i = 0; i < sizes.size(); ++i)
+    {
+      EXPECT_NEAR(static_cast<double>(sizes[i]),
+                  static_cast<double>(reference[i]),
+                  2 + 1e-3 * static_cast<double>(reference[i]));
+    }
+  }
+}
@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 #include "event_batch/global_decay.hpp"
 #include "event_batch/types.hpp"
 
@@ -24,7 +26,9 @@ TEST(event_batch, Batch)
       handle_decay);
 
   StdVector<Event> event_batch;
-  auto handle_batch = [&](StdVector<Event> batch) { event_batch = batch; };
+  auto handle_batch = [&](Span<const Event> batch) {
+    event_batch.assign(batch.begin(), batch.end());
+  };
 
   auto batch = make_batch<Event>(weight_thresh, event_decay, handle_batch);
 
@@ -49,3 +53,173 @@ TEST(event_batch, Batch)
     EXPECT_EQ(event_batch.back().p, 1);
   }
 }
+
+TEST(event_batch, BatchRelease)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 1.0;
+
+  Decay event_decay;
+  auto handle_decay = [&](Decay decay) { event_decay = decay; };
+
+  auto global_decay = make_global_decay<Event>(
+      t_decay_first,
+      [](Event event, float decay, float n_decay, float t_decay,
+         float rate) -> Decay {
+        return {event.t, decay, n_decay, t_decay, rate};
+      },
+      handle_decay);
+
+  StdVector<Span<const Event>> event_batches;
+  auto handle_batch = [&](Span<const Event> batch) -> bool {
+    event_batches.push_back(batch);
+    return true;
+  };
+
+  auto batch = make_batch<Event>(weight_thresh, event_decay, handle_batch, 4);
+
+  for (const Event event : {Event{0, 120, 90, 0}, Event{10, 240, 180, 1},
+                            Event{20, 60, 45, 0}})
+  {
+    global_decay(event);
+    batch(event);
+  }
+  ASSERT_EQ(event_batches.size(), 1);
+  EXPECT_EQ(event_batches[0].size(), 2);
+  EXPECT_EQ(event_batches[0].front().t, 0);
+  EXPECT_EQ(event_batches[0].back().t, 10);
+
+  // The batch following the release reuses the released buffer
+  const Event* const data = event_batches[0].data();
+  batch.release(event_batches[0]);
+  for (const Event event : {Event{30, 10, 10, 1}, Event{40, 20, 20, 0},
+                            Event{50, 30, 30, 1}})
+  {
+    global_decay(event);
+    batch(event);
+  }
+  ASSERT_EQ(event_batches.size(), 3);
+  EXPECT_EQ(event_batches[1].size(), 2);
+  EXPECT_EQ(event_batches[1].front().t, 20);
+  EXPECT_EQ(event_batches[1].back().t, 30);
+  EXPECT_EQ(event_batches[2].data(), data);
+  EXPECT_EQ(event_batches[2].front().t, 40);
+  EXPECT_EQ(event_batches[2].back().t, 50);
+}
+
+TEST(event_batch, BatchBlock)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.5;
+  auto event_to_decay = [](Event event, float decay, float n_decay,
+                           float t_decay, float rate) -> Decay {
+    return {event.t, decay, n_decay, t_decay, rate};
+  };
+
+  StdVector<Event> events;
+  for (uint64_t t = 0; t < 100000; t += 7)
+  {
+    events.push_back({t, static_cast<uint16_t>(t % 320),
+                      static_cast<uint16_t>(t % 240),
+                      static_cast<uint16_t>(t % 2)});
+  }
+
+  Decay event_decay;
+  auto global_decay = make_global_decay<Event>(
+      t_decay_first, event_to_decay, [&](Decay decay) { event_decay = decay; });
+  StdVector<std::size_t> batch_sizes;
+  auto batch = make_batch<Event>(
+      weight_thresh, event_decay,
+      [&](Span<const Event> batch) { batch_sizes.push_back(batch.size()); });
+  for (const Event& event : events)
+  {
+    global_decay(event);
+    batch(event);
+  }
+
+  Decay block_decay;
+  auto global_decay_block = make_global_decay<Event>(
+      t_decay_first, event_to_decay, [&](Decay decay) { block_decay = decay; });
+  StdVector<std::size_t> block_batch_sizes;
+  auto batch_block = make_batch<Event>(weight_thresh, block_decay,
+                                       [&](Span<const Event> batch) {
+                                         block_batch_sizes.push_back(
+                                             batch.size());
+                                       });
+  const std::size_t block_size = 1000;
+  StdVector<Decay> decays(block_size);
+  for (std::size_t i = 0; i < events.size(); i += block_size)
+  {
+    const Event* first = events.data() + i;
+    const Event* last = events.data() + std::min(i + block_size, events.size());
+    decay_and_batch(global_decay_block, batch_block, first, last,
+                    decays.data());
+  }
+
+  EXPECT_GT(batch_sizes.size(), 1);
+  EXPECT_EQ(block_batch_sizes, batch_sizes);
+  EXPECT_EQ(batch_block.batch().size(), batch.batch().size());
+}
+
+TEST(event_batch, BatchLimits)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.0;
+
+  Decay event_decay;
+  auto global_decay = make_global_decay<Event>(
+      t_decay_first,
+      [](Event event, float decay, float n_decay, float t_decay,
+         float rate) -> Decay {
+        return {event.t, decay, n_decay, t_decay, rate};
+      },
+      [&](Decay decay) { event_decay = decay; });
+
+  StdVector<std::size_t> batch_sizes;
+  StdVector<const Event*> batch_data;
+  StdVector<uint64_t> batch_durations;
+  BatchLimits limits;
+  limits.max_events = 4;
+  limits.max_duration = 25;
+  auto batch = make_batch<Event>(weight_thresh, event_decay,
+                                 [&](Span<const Event> batch) {
+                                   batch_sizes.push_back(batch.size());
+                                   batch_data.push_back(batch.data());
+                                   batch_durations.push_back(
+                                       batch.back().t - batch.front().t);
+                                 },
+                                 0, limits);
+  EXPECT_GE(batch.batch().capacity(), 4);
+
+  // A zero weight threshold never closes a batch on its own
+  for (uint64_t t : {0, 1, 2, 3, 4, 5, 10, 40, 50, 60, 70})
+  {
+    const Event event{t, 0, 0, 0};
+    global_decay(event);
+    batch(event);
+  }
+
+  EXPECT_EQ(batch_sizes, StdVector<std::size_t>({4, 3, 3}));
+  for (uint64_t duration : batch_durations)
+  {
+    EXPECT_LE(duration, limits.max_duration);
+  }
+  // The buffer is reused without reallocating
+  for (const Event* data : batch_data)
+  {
+    EXPECT_EQ(data, batch_data.front());
+  }
+  EXPECT_EQ(batch.batch().size(), 1);
+
+  // The maximum duration bounds the closing time of the pending batch
+  EXPECT_EQ(batch.closing_time(), 96);
+  EXPECT_FALSE(batch.flush_until(95));
+  EXPECT_TRUE(batch.flush_until(96));
+  EXPECT_EQ(batch_sizes.back(), 1);
+}
@@ -0,0 +1,83 @@
+#include "event_batch/batch_index.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/types.hpp"
+
+TEST(event_batch, BatchIndex)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.1;
+
+  StdVector<Event> events;
+  uint64_t t = 0;
+  for (uint64_t i = 0; i < 20000; ++i)
+  {
+    t += ((i / 2000) % 2 == 0) ? 1 + i % 3 : 40 + i % 17;
+    events.push_back({t, static_cast<uint16_t>(i % 320),
+                      static_cast<uint16_t>(i % 240),
+                      static_cast<uint16_t>(i % 2)});
+  }
+
+  const std::string filename = testing::TempDir() + "batch_index.ebi";
+  StdVector<BatchRecord> records;
+  {
+    // A small buffer exercises the intermediate writes
+    BatchIndexWriter writer(filename, 3);
+    const Decay* decay = nullptr;
+    auto segmenter = make_adaptive_segmenter<Event>(
+        t_decay_first, weight_thresh, [&](Span<const Event> batch) {
+          const uint64_t first =
+              records.empty() ? 0 : records.back().last;
+          records.push_back({first, first + batch.size(), batch.front().t,
+                             batch.back().t, *decay});
+          writer(batch, *decay);
+        });
+    decay = &segmenter.decay();
+    for (const Event& event : events)
+    {
+      segmenter(event);
+    }
+    segmenter.flush();
+    writer.close();
+  }
+
+  const MappedBatchIndex index(filename);
+  ASSERT_GT(records.size(), 3);
+  ASSERT_EQ(index.size(), records.size());
+  for (std::size_t i = 0; i < index.size(); ++i)
+  {
+    const BatchRecord record = index[i];
+    EXPECT_EQ(record.first, records[i].first);
+    EXPECT_EQ(record.last, records[i].last);
+    EXPECT_EQ(record.t_first, records[i].t_first);
+    EXPECT_EQ(record.t_last, records[i].t_last);
+    EXPECT_EQ(record.decay.t, records[i].decay.t);
+    EXPECT_EQ(record.decay.decay, records[i].decay.decay);
+    EXPECT_EQ(record.decay.n_decay, records[i].decay.n_decay);
+    EXPECT_EQ(record.decay.t_decay, records[i].decay.t_decay);
+    EXPECT_EQ(record.decay.rate, records[i].decay.rate);
+    EXPECT_EQ(events[record.first].t, record.t_first);
+    EXPECT_EQ(events[record.last - 1].t, record.t_last);
+  }
+  EXPECT_EQ(index[index.size() - 1].last, events.size());
+
+  EXPECT_EQ(index.find(0), 0);
+  EXPECT_EQ(index.find(records[2].t_last), 2);
+  EXPECT_EQ(index.find(records[2].t_last + 1), 3);
+  EXPECT_EQ(index.find(events.back().t + 1), index.size());
+
+  {
+    std::ofstream file(filename, std::ios::binary | std::ios::app);
+    file.put(0);
+  }
+  EXPECT_THROW(MappedBatchIndex{filename}, std::runtime_error);
+}
@@ -0,0 +1,95 @@
+#include "event_batch/batch_profile.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <sstream>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/types.hpp"
+
+TEST(event_batch, BatchProfile)
+{
+  using namespace event_batch;
+
+  const StdVector<Event> events{
+      {10, 1, 1, 0}, {20, 2, 2, 1}, {110, 3, 3, 0}, {1000, 4, 4, 1}};
+  Decay decay;
+  decay.rate = 2.5004e-3f;
+
+  BatchProfile batch_profile;
+  std::size_t number_batches = 0;
+  auto handle_batch = [&](Span<const Event>) { ++number_batches; };
+  batch_profile.record(Span<const Event>(events.data(), 3), decay,
+                       handle_batch);
+  batch_profile.record(Span<const Event>(events.data() + 3, 1), decay,
+                       handle_batch);
+  EXPECT_EQ(number_batches, 2);
+  EXPECT_EQ(batch_profile.close_time.size(), 2);
+  EXPECT_EQ(batch_profile.close_time.max(), 100);
+  EXPECT_EQ(batch_profile.close_time.min(), 0);
+  EXPECT_EQ(batch_profile.size.max(), 3);
+  EXPECT_EQ(batch_profile.size.min(), 1);
+  EXPECT_EQ(batch_profile.rate.max(), 2500);
+  EXPECT_EQ(batch_profile.handle_time.size(), 2);
+
+  std::ostringstream stream;
+  display_batch_profile(batch_profile, stream);
+  EXPECT_NE(stream.str().find("batch size: count 2"), std::string::npos);
+
+  batch_profile.clear();
+  EXPECT_EQ(batch_profile.size.size(), 0);
+}
+
+TEST(event_batch, BatchProfileBlock)
+{
+  using namespace event_batch;
+
+  // The rate changes within the blocks of the decay kernel
+  StdVector<Event> events;
+  uint64_t t = 0;
+  for (uint64_t i = 0; i < 100000; ++i)
+  {
+    t += ((i / 100) % 2 == 0) ? 1 : 40;
+    events.push_back({t, 0, 0, 0});
+  }
+
+  // A block-fed segmenter records the rate at the close of each batch, as a
+  // segmenter fed one event at a time
+  BatchProfile profiles[2];
+  StdVector<float> rates[2];
+  for (const bool blocks : {false, true})
+  {
+    BatchProfile& batch_profile = profiles[blocks];
+    const Decay* decay = nullptr;
+    auto segmenter = make_adaptive_segmenter<Event>(
+        10000, 0.1f, [&](Span<const Event> batch) {
+          batch_profile.record(batch, *decay, [](Span<const Event>) {});
+          rates[blocks].push_back(decay->rate);
+        });
+    decay = &segmenter.batch_decay();
+    if (blocks)
+    {
+      segmenter(events.data(), events.data() + events.size());
+    }
+    else
+    {
+      for (const Event& event : events)
+      {
+        segmenter(event);
+      }
+    }
+  }
+  ASSERT_GT(rates[0].size(), 10);
+  ASSERT_EQ(rates[1].size(), rates[0].size());
+  for (std::size_t i = 0; i < rates[0].size(); ++i)
+  {
+    EXPECT_NEAR(rates[1][i], rates[0][i], 1e-4 * rates[0][i]);
+  }
+  for (const double percentage : {10.0, 50.0, 90.0})
+  {
+    EXPECT_NEAR(profiles[1].rate.percentile(percentage),
+                profiles[0].rate.percentile(percentage),
+                1e-4 * profiles[0].rate.percentile(percentage) + 1);
+  }
+}
@@ -0,0 +1,215 @@
+#include "event_batch/checkpoint.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/batch.hpp"
+#include "event_batch/fixed_point.hpp"
+#include "event_batch/global_decay.hpp"
+#include "event_batch/types.hpp"
+
+TEST(event_batch, Checkpoint)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.1;
+
+  StdVector<Event> events;
+  uint64_t t = 0;
+  for (uint64_t i = 0; i < 20000; ++i)
+  {
+    t += ((i / 2000) % 2 == 0) ? 1 + i % 3 : 40 + i % 17;
+    events.push_back({t, static_cast<uint16_t>(i % 320),
+                      static_cast<uint16_t>(i % 240),
+                      static_cast<uint16_t>(i % 2)});
+  }
+  const std::size_t middle = 9000;
+
+  // Uninterrupted estimation
+  StdVector<std::size_t> batch_sizes;
+  auto segmenter = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh,
+      [&](Span<const Event> batch) { batch_sizes.push_back(batch.size()); });
+  for (const Event& event : events)
+  {
+    segmenter(event);
+  }
+
+  // Estimation stopped and restored in another instance
+  StdVector<std::size_t> restored_sizes;
+  StdVector<uint8_t> bytes;
+  {
+    auto segmenter_first = make_adaptive_segmenter<Event>(
+        t_decay_first, weight_thresh, [&](Span<const Event> batch) {
+          restored_sizes.push_back(batch.size());
+        });
+    for (std::size_t i = 0; i < middle; ++i)
+    {
+      segmenter_first(events[i]);
+    }
+    EXPECT_GT(segmenter_first.batch().size(), 0);
+    bytes = segmenter_first.checkpoint();
+  }
+  auto segmenter_second = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh, [&](Span<const Event> batch) {
+        restored_sizes.push_back(batch.size());
+      });
+  segmenter_second.restore(bytes);
+  for (std::size_t i = middle; i < events.size(); ++i)
+  {
+    segmenter_second(events[i]);
+  }
+  EXPECT_EQ(restored_sizes, batch_sizes);
+  EXPECT_EQ(segmenter_second.batch().size(), segmenter.batch().size());
+  EXPECT_EQ(segmenter_second.decay().rate, segmenter.decay().rate);
+
+  // A single checkpoint restores a global decay and batch pair
+  const auto event_to_decay = [](Event event, float decay, float n_decay,
+                                 float t_decay, float rate) -> Decay {
+    return {event.t, decay, n_decay, t_decay, rate};
+  };
+  Decay event_decay;
+  auto global_decay = make_global_decay<Event>(
+      t_decay_first, event_to_decay, [&](Decay decay) { event_decay = decay; });
+  StdVector<std::size_t> pair_sizes;
+  auto batch = make_batch<Event>(
+      weight_thresh, event_decay,
+      [&](Span<const Event> batch) { pair_sizes.push_back(batch.size()); });
+  for (std::size_t i = 0; i < middle; ++i)
+  {
+    global_decay(events[i]);
+    batch(events[i]);
+  }
+  bytes = batch.checkpoint();
+
+  Decay restored_decay;
+  auto global_decay_restored = make_global_decay<Event>(
+      t_decay_first, event_to_decay,
+      [&](Decay decay) { restored_decay = decay; });
+  auto batch_restored = make_batch<Event>(
+      weight_thresh, restored_decay,
+      [&](Span<const Event> batch) { pair_sizes.push_back(batch.size()); });
+  global_decay_restored.restore(bytes);
+  batch_restored.restore(bytes);
+  EXPECT_EQ(global_decay_restored.rate(), event_decay.rate);
+  EXPECT_EQ(batch_restored.batch().size(), batch.batch().size());
+  for (std::size_t i = middle; i < events.size(); ++i)
+  {
+    global_decay_restored(events[i]);
+    batch_restored(events[i]);
+  }
+  EXPECT_EQ(pair_sizes, batch_sizes);
+
+  // Invalid checkpoints
+  StdVector<uint64_t> timestamps;
+  EXPECT_THROW(read_checkpoint(bytes, timestamps), std::runtime_error);
+  bytes.pop_back();
+  EXPECT_THROW(segmenter_second.restore(bytes), std::runtime_error);
+  bytes[0] = 0;
+  EXPECT_THROW(global_decay_restored.restore(bytes), std::runtime_error);
+}
+
+TEST(event_batch, CheckpointLayout)
+{
+  using namespace event_batch;
+
+  // The decay and the events are stored in little endian whatever the host
+  Decay decay;
+  decay.reset(10000);
+  decay.update(0x0102);
+  const StdVector<Event> events = {{0x0102030405060708, 0x090a, 0x0b0c, 1}};
+  const StdVector<uint8_t> bytes =
+      write_checkpoint(decay, Span<const Event>(events.data(), events.size()));
+  ASSERT_EQ(bytes.size(), 75);
+  EXPECT_EQ(bytes[22], 2);
+  EXPECT_EQ(bytes[25], 0);
+  EXPECT_EQ(bytes[26], 0);
+  EXPECT_EQ(bytes[27], 14);
+  EXPECT_EQ(bytes[29], 0x02);
+  EXPECT_EQ(bytes[30], 0x01);
+  const StdVector<uint8_t> event_bytes(bytes.end() - 14, bytes.end());
+  EXPECT_EQ(event_bytes,
+            StdVector<uint8_t>({0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,
+                                0x0a, 0x09, 0x0c, 0x0b, 0x01, 0x00}));
+  StdVector<Event> restored_events;
+  const Decay restored_decay = read_checkpoint(bytes, restored_events);
+  EXPECT_EQ(restored_decay.t, decay.t);
+  EXPECT_EQ(restored_decay.rate, decay.rate);
+  ASSERT_EQ(restored_events.size(), 1);
+  EXPECT_EQ(restored_events[0].t, events[0].t);
+  EXPECT_EQ(restored_events[0].x, events[0].x);
+  EXPECT_EQ(restored_events[0].y, events[0].y);
+  EXPECT_EQ(restored_events[0].p, events[0].p);
+}
+
+TEST(event_batch, CheckpointScalar)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.1;
+
+  StdVector<Event> events;
+  uint64_t t = 0;
+  for (uint64_t i = 0; i < 20000; ++i)
+  {
+    t += ((i / 2000) % 2 == 0) ? 1 + i % 3 : 40 + i % 17;
+    events.push_back({t, 0, 0, 0});
+  }
+  const std::size_t middle = 9000;
+
+  // Every arithmetic resumes exactly where it stopped
+  auto restored = [&](auto scalar) {
+    typedef decltype(scalar) Scalar;
+    StdVector<std::size_t> batch_sizes;
+    auto handle_batch = [&](Span<const Event> batch) {
+      batch_sizes.push_back(batch.size());
+    };
+    auto segmenter = make_basic_adaptive_segmenter<Scalar, Event>(
+        t_decay_first, weight_thresh, handle_batch);
+    for (const Event& event : events)
+    {
+      segmenter(event);
+    }
+    const StdVector<std::size_t> expected_sizes = batch_sizes;
+    batch_sizes.clear();
+
+    auto segmenter_first = make_basic_adaptive_segmenter<Scalar, Event>(
+        t_decay_first, weight_thresh, handle_batch);
+    for (std::size_t i = 0; i < middle; ++i)
+    {
+      segmenter_first(events[i]);
+    }
+    const StdVector<uint8_t> bytes = segmenter_first.checkpoint();
+    auto segmenter_second = make_basic_adaptive_segmenter<Scalar, Event>(
+        t_decay_first, weight_thresh, handle_batch);
+    segmenter_second.restore(bytes);
+    EXPECT_EQ(segmenter_second.decay().t_decay,
+              segmenter_first.decay().t_decay);
+    for (std::size_t i = middle; i < events.size(); ++i)
+    {
+      segmenter_second(events[i]);
+    }
+    EXPECT_EQ(batch_sizes, expected_sizes);
+    return bytes;
+  };
+  const StdVector<uint8_t> float_bytes = restored(0.0f);
+  const StdVector<uint8_t> double_bytes = restored(0.0);
+  const StdVector<uint8_t> fixed_bytes = restored(FixedPoint<>());
+  EXPECT_EQ(double_bytes.size(), float_bytes.size() + 16);
+  EXPECT_EQ(fixed_bytes.size(), double_bytes.size());
+
+  // A checkpoint is only restored with the arithmetic it was written with
+  StdVector<Event> batch;
+  EXPECT_THROW(read_checkpoint<double>(float_bytes, batch),
+               std::runtime_error);
+  EXPECT_THROW(read_checkpoint<FixedPoint<>>(double_bytes, batch),
+               std::runtime_error);
+  EXPECT_THROW(read_checkpoint<FixedPoint<16>>(fixed_bytes, batch),
+               std::runtime_error);
+  EXPECT_NO_THROW(read_checkpoint<FixedPoint<>>(fixed_bytes, batch));
+}
@@ -0,0 +1,93 @@
+#include "event_batch/decay_kernel.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "event_batch/types.hpp"
+
+TEST(event_batch, DecayKernel)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+
+  StdVector<uint64_t> t;
+  uint64_t t_event = 0;
+  for (std::size_t i = 0; i < 4000; ++i)
+  {
+    // Repeated timestamps, small gaps, gaps above 2^31 microseconds, a run of
+    // gaps of about a day, whose composed transforms overflow, and a run at
+    // one event per microsecond, where rounding accumulates the most
+    t_event += (i >= 1000)             ? 1
+               : (i >= 490 && i < 530) ? uint64_t(100000000000)
+               : (i % 7 == 0)          ? 0
+               : (i % 97 == 0)         ? (uint64_t(1) << 32)
+                                       : i % 13;
+    t.push_back(t_event);
+  }
+
+  StdVector<DecayKernel> kernels{DecayKernel::generic};
+  if (best_decay_kernel() != DecayKernel::generic)
+  {
+    kernels.push_back(DecayKernel::avx2);
+  }
+  if (best_decay_kernel() == DecayKernel::avx512)
+  {
+    kernels.push_back(DecayKernel::avx512);
+  }
+
+  for (const DecayKernel kernel : kernels)
+  {
+    // The generic kernel is exact, the vector kernels round differently
+    // within the bound documented by decay_timestamps
+    const float tolerance =
+        (kernel == DecayKernel::generic) ? 0 : static_cast<float>(1e-4);
+    auto expect_near = [&](const float value, const float expected) {
+      EXPECT_NEAR(value, expected, tolerance * expected);
+    };
+
+    Decay decay;
+    decay.reset(t_decay_first);
+    Decay decay_block;
+    decay_block.reset(t_decay_first);
+
+    DecayLanes lanes;
+    for (std::size_t first = 0; first < t.size();
+         first += DecayLanes::capacity)
+    {
+      const std::size_t size =
+          std::min(t.size() - first, DecayLanes::capacity);
+      ASSERT_TRUE(
+          decay_timestamps(decay_block, t.data() + first, size, lanes, kernel));
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        decay.update(t[first + i]);
+        ASSERT_TRUE(std::isfinite(lanes.n_decay[i]));
+        ASSERT_TRUE(std::isfinite(lanes.rate[i]));
+        expect_near(lanes.decay[i], decay.decay);
+        expect_near(lanes.n_decay[i], decay.n_decay);
+        expect_near(lanes.t_decay[i], decay.t_decay);
+        expect_near(lanes.rate[i], decay.rate);
+      }
+      EXPECT_EQ(decay_block.t, decay.t);
+      expect_near(decay_block.decay, decay.decay);
+      expect_near(decay_block.n_decay, decay.n_decay);
+      expect_near(decay_block.t_decay, decay.t_decay);
+      expect_near(decay_block.rate, decay.rate);
+    }
+
+    // Unsorted timestamps leave the decay untouched
+    const Decay decay_unsorted = decay_block;
+    const StdVector<uint64_t> t_unsorted{t.back() + 1, t.back() + 3,
+                                         t.back() + 2, t.back() + 4,
+                                         t.back() + 5, t.back() + 6,
+                                         t.back() + 7, t.back() + 8,
+                                         t.back() + 9, t.back() + 10};
+    EXPECT_FALSE(decay_timestamps(decay_block, t_unsorted.data(),
+                                  t_unsorted.size(), lanes, kernel));
+    EXPECT_EQ(decay_block.t, decay_unsorted.t);
+    EXPECT_EQ(decay_block.n_decay, decay_unsorted.n_decay);
+    EXPECT_EQ(decay_block.t_decay, decay_unsorted.t_decay);
+  }
+}
@@ -0,0 +1,129 @@
+#include "event_batch/event_block.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/event_stream.hpp"
+#include "event_batch/global_decay.hpp"
+#include "event_batch/types.hpp"
+#include "sepia.hpp"
+
+TEST(event_batch, EventBlock)
+{
+  using namespace event_batch;
+
+  const StdVector<sepia::dvs_event> dvs_events{
+      {10, 120, 90, true}, {266, 240, 180, false}, {266, 319, 239, true}};
+  const EventBlock block =
+      make_event_block(dvs_events.data(), dvs_events.data() + 3);
+  ASSERT_EQ(block.size(), 3);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(block.t.data()) % 64, 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(block.x.data()) % 64, 0);
+  EXPECT_EQ(block.t[1], 266);
+  EXPECT_EQ(block.x[1], 240);
+  EXPECT_EQ(block.y[1], 180);
+  EXPECT_EQ(block.p[0], 1);
+  EXPECT_EQ(block.p[1], 0);
+
+  const StdVector<Event> events = to_events(block);
+  const EventBlock round_trip =
+      make_event_block(events.data(), events.data() + events.size());
+  EXPECT_EQ(round_trip.t, block.t);
+  EXPECT_EQ(round_trip.x, block.x);
+  EXPECT_EQ(round_trip.y, block.y);
+  EXPECT_EQ(round_trip.p, block.p);
+
+  // Decoding into a block matches decoding into events
+  const StdVector<uint8_t> bytes{// t += 10, p = 1
+                                 21, 120, 0, 90, 0,
+                                 // t += 2 * 127 + 2, p = 0
+                                 255, 255, 4, 240, 0, 180, 0,
+                                 // t += 0, p = 1
+                                 1, 63, 1, 239, 0,
+                                 // Truncated event
+                                 6, 1};
+  DvsDecoder event_decoder(320, 240);
+  StdVector<Event> decoded_events(8);
+  const uint8_t* byte = bytes.data();
+  decoded_events.resize(static_cast<std::size_t>(
+      event_decoder(byte, bytes.data() + bytes.size(), decoded_events.data(),
+                    decoded_events.data() + decoded_events.size()) -
+      decoded_events.data()));
+  DvsDecoder block_decoder(320, 240);
+  EventBlock decoded_block;
+  byte = bytes.data();
+  EXPECT_EQ(block_decoder(byte, bytes.data() + bytes.size(), decoded_block, 8),
+            3);
+  EXPECT_EQ(byte, bytes.data() + bytes.size() - 2);
+  EXPECT_EQ(decoded_block.t, block.t);
+  ASSERT_EQ(decoded_events.size(), 3);
+  EXPECT_EQ(decoded_events[2].x, decoded_block.x[2]);
+}
+
+TEST(event_batch, EventBlockEstimators)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.1;
+
+  StdVector<Event> events;
+  uint64_t t = 0;
+  for (uint64_t i = 0; i < 20000; ++i)
+  {
+    t += ((i / 5000) % 2 == 0) ? 1 + i % 3 : 40 + i % 17;
+    events.push_back({t, static_cast<uint16_t>(i % 320),
+                      static_cast<uint16_t>(i % 240),
+                      static_cast<uint16_t>(i % 2)});
+  }
+  const EventBlock block =
+      make_event_block(events.data(), events.data() + events.size());
+
+  auto event_to_decay = [](Event event, float decay, float n_decay,
+                           float t_decay, float rate) -> Decay {
+    return {event.t, decay, n_decay, t_decay, rate};
+  };
+  Decay last_decay;
+  auto global_decay = make_global_decay<Event>(
+      t_decay_first, event_to_decay, [](Decay) {});
+  auto global_decay_block = make_global_decay<Event>(
+      t_decay_first, event_to_decay, [&](Decay decay) { last_decay = decay; });
+  auto global_decay_column = make_global_decay<uint64_t>(
+      t_decay_first,
+      [](uint64_t t, float decay, float n_decay, float t_decay,
+         float rate) -> Decay { return {t, decay, n_decay, t_decay, rate}; },
+      [](Decay) {}, RawTimestamp());
+
+  StdVector<Decay> event_decays(events.size());
+  global_decay(events.data(), events.data() + events.size(),
+               event_decays.data());
+  global_decay_block(block);
+  StdVector<Decay> column_decays(events.size());
+  global_decay_column(block.t.data(), block.t.data() + block.size(),
+                      column_decays.data());
+
+  for (std::size_t i = 0; i < events.size(); ++i)
+  {
+    EXPECT_EQ(column_decays[i].t, event_decays[i].t);
+    EXPECT_EQ(column_decays[i].n_decay, event_decays[i].n_decay);
+    EXPECT_EQ(column_decays[i].rate, event_decays[i].rate);
+  }
+  EXPECT_EQ(last_decay.t, events.back().t);
+  EXPECT_EQ(last_decay.rate, event_decays.back().rate);
+
+  StdVector<uint64_t> event_ts;
+  auto segmenter = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh,
+      [&](Span<const Event> batch) { event_ts.push_back(batch.back().t); });
+  segmenter(events.data(), events.data() + events.size());
+  StdVector<uint64_t> block_ts;
+  auto segmenter_block = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh,
+      [&](Span<const Event> batch) { block_ts.push_back(batch.back().t); });
+  segmenter_block(block);
+  EXPECT_GT(event_ts.size(), 1);
+  EXPECT_EQ(block_ts, event_ts);
+  EXPECT_EQ(segmenter_block.batch().size(), segmenter.batch().size());
+}
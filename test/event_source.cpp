@@ -0,0 +1,231 @@
+#include "event_batch/event_source.hpp"
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/latency_statistics.hpp"
+#include "event_batch/types.hpp"
+
+TEST(event_batch, LatencyStatistics)
+{
+  using namespace event_batch;
+
+  LatencyStatistics latency_statistics;
+  EXPECT_EQ(latency_statistics.percentile(50), 0);
+  for (int i = 100; i >= 1; --i)
+  {
+    latency_statistics.add(i);
+  }
+  EXPECT_EQ(latency_statistics.size(), 100);
+  EXPECT_EQ(latency_statistics.mean(), 50.5);
+  EXPECT_EQ(latency_statistics.histogram().max(), 100000);
+
+  // The percentiles are bounded by the relative error of the histogram, and
+  // never below the exact ones
+  for (const auto& percentage_and_exact :
+       {std::make_pair(50.0, 50.0), std::make_pair(99.0, 99.0),
+        std::make_pair(0.0, 1.0)})
+  {
+    const double percentile =
+        latency_statistics.percentile(percentage_and_exact.first);
+    EXPECT_GE(percentile, percentage_and_exact.second);
+    EXPECT_LE(percentile, percentage_and_exact.second * (1 + 1.0 / 64));
+  }
+  EXPECT_EQ(latency_statistics.percentile(100), 100);
+
+  latency_statistics.clear();
+  EXPECT_EQ(latency_statistics.size(), 0);
+  EXPECT_EQ(latency_statistics.mean(), 0);
+}
+
+TEST(event_batch, SocketEventSource)
+{
+  using namespace event_batch;
+
+  StdVector<Event> events;
+  uint64_t t = 0;
+  for (uint64_t i = 0; i < 50000; ++i)
+  {
+    t += 1 + (i / 1000) % 7;
+    events.push_back({t, static_cast<uint16_t>(i % 100),
+                      static_cast<uint16_t>(i % 60), 0});
+  }
+
+  const std::string path = testing::TempDir() + "event_source.sock";
+  ::unlink(path.c_str());
+  const int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_GE(server, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  ASSERT_EQ(::bind(server, reinterpret_cast<const sockaddr*>(&address),
+                   sizeof(address)),
+            0);
+  ASSERT_EQ(::listen(server, 1), 0);
+
+  // Odd-sized writes split the records across reads
+  std::thread peer([&]() {
+    const int client = ::accept(server, nullptr, nullptr);
+    const char* bytes = reinterpret_cast<const char*>(events.data());
+    const std::size_t size = events.size() * sizeof(Event);
+    for (std::size_t offset = 0; offset < size;)
+    {
+      const std::size_t chunk = std::min<std::size_t>(1001, size - offset);
+      offset += static_cast<std::size_t>(::send(client, bytes + offset, chunk,
+                                                MSG_NOSIGNAL));
+    }
+    ::close(client);
+  });
+
+  SocketEventSource source(path);
+  StdVector<StdVector<Event>> batches;
+  LatencyStatistics latency_statistics;
+  stream_batches(source, 10000, 0.1,
+                 [&](Span<const Event> batch) {
+                   batches.emplace_back(batch.begin(), batch.end());
+                 },
+                 latency_statistics, 100);
+  peer.join();
+  ::close(server);
+  ::unlink(path.c_str());
+
+  // Each batch closes either on its last event or on a closing time reached
+  // after a read, and the last one at the end of the stream
+  StdVector<std::size_t> expected_sizes;
+  auto segmenter = make_adaptive_segmenter<Event>(
+      10000, 0.1,
+      [&](Span<const Event> batch) { expected_sizes.push_back(batch.size()); });
+  std::size_t number_events = 0;
+  for (std::size_t i = 0; i < batches.size(); ++i)
+  {
+    const StdVector<Event>& batch = batches[i];
+    segmenter(batch.data(), batch.data() + batch.size());
+    if (i + 1 < batches.size() && !segmenter.batch().empty())
+    {
+      EXPECT_TRUE(segmenter.flush_until(batch.back().t));
+    }
+    number_events += batch.size();
+  }
+  segmenter.flush();
+  ASSERT_EQ(batches.size(), expected_sizes.size());
+  for (std::size_t i = 0; i < batches.size(); ++i)
+  {
+    EXPECT_EQ(batches[i].size(), expected_sizes[i]);
+  }
+  EXPECT_EQ(number_events, events.size());
+  EXPECT_EQ(batches.back().back().t, events.back().t);
+  EXPECT_EQ(latency_statistics.size(), batches.size());
+  EXPECT_GE(latency_statistics.percentile(99),
+            latency_statistics.percentile(50));
+}
+
+TEST(event_batch, ReplayEventSource)
+{
+  using namespace event_batch;
+
+  const std::string filename = testing::TempDir() + "event_source.es";
+  {
+    const std::string signature = "Event Stream";
+    const StdVector<uint8_t> bytes{
+        // Version, type, width (320) and height (240)
+        2, 0, 0, 1, 64, 1, 240, 0,
+        // t += 10, p = 1
+        21, 120, 0, 90, 0,
+        // t += 2 * 127 + 2, p = 0
+        255, 255, 4, 240, 0, 180, 0};
+    std::ofstream file(filename, std::ios::binary);
+    file.write(signature.data(), signature.size());
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  }
+
+  // Events are released one by one at the recorded pace
+  ReplayEventSource source(filename);
+  EXPECT_EQ(source.header().width, 320);
+  StdVector<Event> events(16);
+  const auto t_start = std::chrono::steady_clock::now();
+  std::size_t number_events = 0;
+  StdVector<uint64_t> ts;
+  while (const std::size_t size = source.read(events.data(), events.size()))
+  {
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      ts.push_back(events[i].t);
+    }
+    number_events += size;
+  }
+  const double t_diff = std::chrono::duration<double, std::micro>(
+                            std::chrono::steady_clock::now() - t_start)
+                            .count();
+  ASSERT_EQ(number_events, 2);
+  EXPECT_GE(t_diff, static_cast<double>(ts[1] - ts[0]));
+}
+
+TEST(event_batch, SocketEventSourceTimeout)
+{
+  using namespace event_batch;
+
+  const std::string path = testing::TempDir() + "event_source_timeout.sock";
+  ::unlink(path.c_str());
+  const int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_GE(server, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  ASSERT_EQ(::bind(server, reinterpret_cast<const sockaddr*>(&address),
+                   sizeof(address)),
+            0);
+  ASSERT_EQ(::listen(server, 1), 0);
+
+  // The peer goes silent after a few events and a partial record, and only
+  // closes the connection once the pending batch was handled
+  std::atomic<bool> handled(false);
+  std::thread peer([&]() {
+    const int client = ::accept(server, nullptr, nullptr);
+    const StdVector<Event> events{
+        {0, 1, 1, 0}, {10, 2, 2, 1}, {20, 3, 3, 0}, {30, 4, 4, 1}};
+    ::send(client, events.data(), 3 * sizeof(Event) + 3, MSG_NOSIGNAL);
+    const auto t_give_up =
+        std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!handled && std::chrono::steady_clock::now() < t_give_up)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ::send(client, reinterpret_cast<const char*>(events.data() + 3) + 3,
+           sizeof(Event) - 3, MSG_NOSIGNAL);
+    ::close(client);
+  });
+
+  SocketEventSource source(path, std::chrono::milliseconds(1));
+  StdVector<std::size_t> batch_sizes;
+  bool handled_before_end = false;
+  LatencyStatistics latency_statistics;
+  stream_batches(source, 10000, 0.9,
+                 [&](Span<const Event> batch) {
+                   batch_sizes.push_back(batch.size());
+                   if (!handled)
+                   {
+                     handled_before_end = !source.end_of_stream();
+                     handled = true;
+                   }
+                 },
+                 latency_statistics);
+  peer.join();
+  ::close(server);
+  ::unlink(path.c_str());
+
+  EXPECT_TRUE(source.end_of_stream());
+  EXPECT_TRUE(handled_before_end);
+  EXPECT_EQ(batch_sizes, StdVector<std::size_t>({3, 1}));
+}
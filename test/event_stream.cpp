@@ -0,0 +1,126 @@
+#include "event_batch/event_stream.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "event_batch/types.hpp"
+
+TEST(event_batch, EventStream)
+{
+  using namespace event_batch;
+
+  const std::string filename = testing::TempDir() + "event_stream.es";
+  {
+    const std::string signature = "Event Stream";
+    const StdVector<uint8_t> bytes{
+        // Version, type, width (320) and height (240)
+        2, 0, 0, 1, 64, 1, 240, 0,
+        // t += 10, p = 1
+        21, 120, 0, 90, 0,
+        // t += 2 * 127 + 2, p = 0
+        255, 255, 4, 240, 0, 180, 0,
+        // t += 0, p = 1
+        1, 63, 1, 239, 0,
+        // Truncated event
+        6, 1, 0};
+    std::ofstream file(filename, std::ios::binary);
+    file.write(signature.data(), signature.size());
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  }
+
+  const MappedEventStream event_stream(filename);
+  EXPECT_EQ(event_stream.header().width, 320);
+  EXPECT_EQ(event_stream.header().height, 240);
+  EXPECT_EQ(event_stream.offset(), 20);
+
+  StdVector<Event> events;
+  for_each_block(
+      event_stream,
+      [&](const Event* first, const Event* last) {
+        EXPECT_LE(last - first, 2);
+        events.insert(events.end(), first, last);
+      },
+      2);
+
+  ASSERT_EQ(events.size(), 3);
+  EXPECT_EQ(events[0].t, 10);
+  EXPECT_EQ(events[0].x, 120);
+  EXPECT_EQ(events[0].y, 90);
+  EXPECT_EQ(events[0].p, 1);
+  EXPECT_EQ(events[1].t, 266);
+  EXPECT_EQ(events[1].x, 240);
+  EXPECT_EQ(events[1].y, 180);
+  EXPECT_EQ(events[1].p, 0);
+  EXPECT_EQ(events[2].t, 266);
+  EXPECT_EQ(events[2].x, 319);
+  EXPECT_EQ(events[2].y, 239);
+  EXPECT_EQ(events[2].p, 1);
+
+  EXPECT_THROW(MappedEventStream(filename + ".missing"), std::runtime_error);
+}
+
+TEST(event_batch, EncodeDvsEvents)
+{
+  using namespace event_batch;
+
+  const StdVector<Event> events{
+      {10, 120, 90, 1}, {266, 240, 180, 0}, {266, 319, 239, 1}};
+  StdVector<uint8_t> bytes;
+  EXPECT_EQ(encode_dvs_events(events.data(), events.data() + events.size(),
+                              bytes),
+            266);
+  // Same bytes as the stream decoded above
+  EXPECT_EQ(bytes, StdVector<uint8_t>({21, 120, 0, 90, 0, 255, 255, 4, 240,
+                                       0, 180, 0, 1, 63, 1, 239, 0}));
+
+  DvsDecoder decoder(320, 240);
+  StdVector<Event> decoded(events.size());
+  const uint8_t* byte = bytes.data();
+  EXPECT_EQ(decoder(byte, bytes.data() + bytes.size(), decoded.data(),
+                    decoded.data() + decoded.size()),
+            decoded.data() + decoded.size());
+  for (std::size_t i = 0; i < events.size(); ++i)
+  {
+    EXPECT_EQ(decoded[i].t, events[i].t);
+    EXPECT_EQ(decoded[i].x, events[i].x);
+    EXPECT_EQ(decoded[i].y, events[i].y);
+    EXPECT_EQ(decoded[i].p, events[i].p);
+  }
+}
+
+TEST(event_batch, EventStreamWriter)
+{
+  using namespace event_batch;
+
+  const std::string filename = testing::TempDir() + "event_stream_writer.es";
+  const StdVector<Event> events{
+      {10, 120, 90, 1}, {266, 240, 180, 0}, {266, 319, 239, 1}, {500, 0, 0, 0}};
+  {
+    EventStreamWriter writer(filename, 320, 240);
+    writer(events.data(), events.data() + 2);
+    writer(events.data() + 2, events.data() + events.size());
+    writer.close();
+  }
+
+  const MappedEventStream event_stream(filename);
+  EXPECT_EQ(event_stream.header().width, 320);
+  EXPECT_EQ(event_stream.header().height, 240);
+  StdVector<Event> decoded;
+  for_each_block(
+      event_stream,
+      [&](const Event* first, const Event* last) {
+        decoded.insert(decoded.end(), first, last);
+      },
+      3);
+  ASSERT_EQ(decoded.size(), events.size());
+  for (std::size_t i = 0; i < events.size(); ++i)
+  {
+    EXPECT_EQ(decoded[i].t, events[i].t);
+    EXPECT_EQ(decoded[i].x, events[i].x);
+    EXPECT_EQ(decoded[i].y, events[i].y);
+    EXPECT_EQ(decoded[i].p, events[i].p);
+  }
+}
@@ -41,3 +41,32 @@ TEST(event_batch, EventStreamStatistics)
   EXPECT_EQ(stream_statistics.number_events, 3);
   EXPECT_EQ(stream_statistics.duration, 40);
 }
+
+TEST(event_batch, EventStreamStatisticsBlock)
+{
+  using namespace event_batch;
+
+  StreamStatistics stream_statistics;
+  auto event_stream_statistics =
+      make_stream_statistics_tap<Event>(stream_statistics);
+
+  const StdVector<Event> events{{10, 120, 90, 0},
+                                {20, 120, 90, 0},
+                                {50, 120, 90, 0},
+                                {55, 120, 90, 1}};
+
+  event_stream_statistics(events.data(), events.data() + 3);
+  EXPECT_EQ(stream_statistics.t, 50);
+  EXPECT_EQ(stream_statistics.t_first, 10);
+  EXPECT_EQ(stream_statistics.number_events, 3);
+  EXPECT_EQ(stream_statistics.duration, 40);
+
+  event_stream_statistics(events.data() + 3, events.data() + 3);
+  EXPECT_EQ(stream_statistics.number_events, 3);
+
+  event_stream_statistics(events.data() + 3, events.data() + 4);
+  EXPECT_EQ(stream_statistics.t, 55);
+  EXPECT_EQ(stream_statistics.t_first, 10);
+  EXPECT_EQ(stream_statistics.number_events, 4);
+  EXPECT_EQ(stream_statistics.duration, 45);
+}
@@ -0,0 +1,53 @@
+#include "event_batch/fixed_point.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+
+TEST(event_batch, FixedPoint)
+{
+  using namespace event_batch;
+
+  typedef FixedPoint<24> Fixed;
+  EXPECT_EQ(Fixed(1).raw(), int64_t(1) << 24);
+  EXPECT_EQ(Fixed(0.5).raw(), int64_t(1) << 23);
+  EXPECT_EQ(Fixed::from_raw(3 << 22), Fixed(0.75));
+  EXPECT_EQ(static_cast<double>(Fixed(-2.25)), -2.25);
+
+  EXPECT_EQ(Fixed(1.5) + Fixed(2), Fixed(3.5));
+  EXPECT_EQ(Fixed(1.5) - Fixed(2), Fixed(-0.5));
+  EXPECT_EQ(Fixed(1.5) * Fixed(-2), Fixed(-3));
+  EXPECT_EQ(Fixed(3) / Fixed(4), Fixed(0.75));
+  Fixed count(2);
+  ++count;
+  EXPECT_EQ(count, Fixed(3));
+  EXPECT_TRUE(Fixed(1) < Fixed(2));
+  EXPECT_TRUE(Fixed(2) > Fixed(1));
+  EXPECT_TRUE(Fixed(2) != Fixed(1));
+
+  // Products and quotients do not overflow their intermediates
+  const Fixed large(3.6e9);
+  EXPECT_EQ(large * Fixed(0.5), Fixed(1.8e9));
+  EXPECT_EQ(large / Fixed(3.6e9), Fixed(1));
+  EXPECT_NEAR(static_cast<double>(Fixed(1) / Fixed(3)), 1.0 / 3, 1e-7);
+  EXPECT_EQ(Fixed(-3) / Fixed(4), Fixed(-0.75));
+  EXPECT_EQ(Fixed(3) / Fixed(-4), Fixed(-0.75));
+  EXPECT_EQ(Fixed(-3.6e9) / Fixed(-3.6e9), Fixed(1));
+
+  // Numbers out of range saturate instead of wrapping around
+  const int64_t max_raw = std::numeric_limits<int64_t>::max();
+  const int64_t min_raw = std::numeric_limits<int64_t>::min();
+  EXPECT_EQ(Fixed(int64_t(1) << 39).raw(), max_raw);
+  EXPECT_EQ(Fixed((int64_t(1) << 39) - 1).raw(),
+            ((int64_t(1) << 39) - 1) << 24);
+  EXPECT_EQ(Fixed(-(int64_t(1) << 39)).raw(), min_raw);
+  EXPECT_EQ(Fixed(-(int64_t(1) << 39) - 1).raw(), min_raw);
+  EXPECT_EQ(Fixed(std::numeric_limits<uint64_t>::max()).raw(), max_raw);
+  EXPECT_EQ(Fixed(1e12).raw(), max_raw);
+  EXPECT_EQ(Fixed(-1e12).raw(), min_raw);
+  EXPECT_EQ(Fixed(std::numeric_limits<double>::infinity()).raw(), max_raw);
+  EXPECT_EQ(Fixed(-std::numeric_limits<double>::infinity()).raw(), min_raw);
+  EXPECT_EQ(Fixed(std::numeric_limits<double>::quiet_NaN()).raw(), 0);
+  EXPECT_EQ(Fixed(5e11).raw(), int64_t(5e11) << 24);
+}
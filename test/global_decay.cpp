@@ -2,6 +2,7 @@
 
 #include <gtest/gtest.h>
 
+#include "event_batch/synthetic_stream.hpp"
 #include "event_batch/types.hpp"
 
 TEST(event_batch, GlobalDecay)
@@ -28,3 +29,97 @@ TEST(event_batch, GlobalDecay)
   EXPECT_EQ(event_decay.t_decay, static_cast<float>(t_decay_first));
   EXPECT_EQ(event_decay.rate, static_cast<float>(1) / t_decay_first);
 }
+
+TEST(event_batch, GlobalDecayBlock)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  auto event_to_decay = [](Event event, float decay, float n_decay,
+                           float t_decay, float rate) -> Decay {
+    return {event.t, decay, n_decay, t_decay, rate};
+  };
+
+  StdVector<Decay> event_decays;
+  auto handle_decay = [&](Decay decay) { event_decays.push_back(decay); };
+
+  auto global_decay =
+      make_global_decay<Event>(t_decay_first, event_to_decay, handle_decay);
+  auto global_decay_block =
+      make_global_decay<Event>(t_decay_first, event_to_decay, handle_decay);
+
+  const StdVector<Event> events{{0, 120, 90, 0},  {10, 240, 180, 1},
+                                {10, 60, 45, 0},  {25, 10, 10, 1},
+                                {400, 20, 20, 0}, {410, 30, 30, 1}};
+  for (const Event& event : events)
+  {
+    global_decay(event);
+  }
+
+  StdVector<Decay> block_decays(events.size());
+  global_decay_block(events.data(), events.data() + 2, block_decays.data());
+  global_decay_block(events.data() + 2, events.data() + events.size(),
+                     block_decays.data() + 2);
+
+  ASSERT_EQ(event_decays.size(), events.size());
+  for (std::size_t i = 0; i < events.size(); ++i)
+  {
+    EXPECT_EQ(block_decays[i].t, event_decays[i].t);
+    EXPECT_EQ(block_decays[i].decay, event_decays[i].decay);
+    EXPECT_EQ(block_decays[i].n_decay, event_decays[i].n_decay);
+    EXPECT_EQ(block_decays[i].t_decay, event_decays[i].t_decay);
+    EXPECT_EQ(block_decays[i].rate, event_decays[i].rate);
+  }
+
+  // Without output, the handle is only called with the last decay
+  global_decay_block.reset();
+  global_decay_block(events.data(), events.data() + events.size());
+  ASSERT_EQ(event_decays.size(), events.size() + 1);
+  const Decay last_decay = event_decays[events.size() - 1];
+  EXPECT_EQ(event_decays.back().n_decay, last_decay.n_decay);
+  EXPECT_EQ(event_decays.back().rate, last_decay.rate);
+}
+
+TEST(event_batch, GlobalDecayScalar)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const StdVector<Event> events = make_synthetic_stream(
+      StreamProfile::poisson, 1e6, 100000, 320, 240, 5);
+
+  // Every arithmetic follows the same recurrence
+  auto final_rate = [&](auto scalar) {
+    typedef decltype(scalar) Scalar;
+    BasicDecay<Scalar> event_decay;
+    auto global_decay = make_basic_global_decay<Scalar, Event>(
+        t_decay_first,
+        [](Event event, Scalar decay, Scalar n_decay, Scalar t_decay,
+           Scalar rate) -> BasicDecay<Scalar> {
+          return {event.t, decay, n_decay, t_decay, rate};
+        },
+        [&](BasicDecay<Scalar> decay) { event_decay = decay; });
+    global_decay(events.data(), events.data() + events.size());
+    EXPECT_EQ(event_decay.t, events.back().t);
+    EXPECT_EQ(global_decay.t(), events.back().t);
+    return static_cast<double>(event_decay.rate);
+  };
+  const double reference = final_rate(static_cast<long double>(0));
+  EXPECT_NEAR(reference, 1, 0.2);
+  EXPECT_NEAR(final_rate(static_cast<double>(0)), reference, 1e-9);
+  EXPECT_NEAR(final_rate(FixedPoint<>()), reference, 1e-4);
+  EXPECT_NEAR(final_rate(static_cast<float>(0)), reference, 1e-2);
+
+  // The fixed-point decay matches the floating-point one, including over
+  // silences whose product with the count exceeds its range
+  for (const double t_diff : {1.0, 1e3, 1e6, 3.6e9})
+  {
+    for (const double n_decay : {1.0, 100.0, 10000.0})
+    {
+      const double decay = decay_factor(t_diff, n_decay);
+      EXPECT_NEAR(static_cast<double>(decay_factor(FixedPoint<>(t_diff),
+                                                   FixedPoint<>(n_decay))),
+                  decay, 1e-7 + 1e-6 * decay);
+    }
+  }
+}
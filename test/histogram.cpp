@@ -0,0 +1,97 @@
+#include "event_batch/histogram.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+TEST(event_batch, Histogram)
+{
+  using namespace event_batch;
+
+  Histogram histogram;
+  EXPECT_EQ(histogram.size(), 0);
+  EXPECT_EQ(histogram.percentile(50), 0);
+  EXPECT_EQ(histogram.min(), 0);
+  EXPECT_EQ(histogram.max(), 0);
+
+  // Small values have their own bucket
+  for (uint64_t value = 1; value <= 100; ++value)
+  {
+    histogram.record(value);
+  }
+  EXPECT_EQ(histogram.size(), 100);
+  EXPECT_DOUBLE_EQ(histogram.mean(), 50.5);
+  EXPECT_EQ(histogram.min(), 1);
+  EXPECT_EQ(histogram.max(), 100);
+  EXPECT_EQ(histogram.percentile(0), 1);
+  EXPECT_EQ(histogram.percentile(50), 50);
+  EXPECT_EQ(histogram.percentile(99), 99);
+  EXPECT_EQ(histogram.percentile(100), 100);
+
+  // Large values are within the relative error, and never underestimated
+  histogram.clear();
+  EXPECT_EQ(histogram.size(), 0);
+  for (uint64_t value = 1; value <= 1000000; value += 7)
+  {
+    histogram.record(value * 1000);
+  }
+  for (const double percentage : {10.0, 50.0, 90.0, 99.0, 99.9})
+  {
+    const double exact = 1000.0 * (1 + 7 * std::ceil(percentage / 100 *
+                                                     histogram.size() - 1));
+    const double estimate =
+        static_cast<double>(histogram.percentile(percentage));
+    EXPECT_GE(estimate, exact);
+    EXPECT_LE(estimate, exact * (1 + 1.0 / 64));
+  }
+
+  // The whole 64-bit range is covered
+  Histogram extremes(2);
+  extremes.record(std::numeric_limits<uint64_t>::max());
+  extremes.record(0, 3);
+  EXPECT_EQ(extremes.size(), 4);
+  EXPECT_EQ(extremes.percentile(75), 0);
+  EXPECT_EQ(extremes.percentile(100), std::numeric_limits<uint64_t>::max());
+  EXPECT_THROW(Histogram(1), std::runtime_error);
+}
+
+TEST(event_batch, HistogramConcurrent)
+{
+  using namespace event_batch;
+
+  Histogram histogram;
+  std::vector<std::thread> threads;
+  for (uint64_t thread = 0; thread < 4; ++thread)
+  {
+    threads.emplace_back([&histogram, thread]() {
+      for (uint64_t value = 0; value < 100000; ++value)
+      {
+        histogram.record(thread * 100000 + value);
+      }
+    });
+  }
+  // Reads while values are recorded are allowed
+  while (histogram.size() < 400000)
+  {
+    EXPECT_LE(histogram.percentile(50), histogram.max());
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(histogram.size(), 400000);
+  EXPECT_EQ(histogram.min(), 0);
+  EXPECT_EQ(histogram.max(), 399999);
+
+  Histogram merged;
+  merged.record(1000000);
+  merged.merge(histogram);
+  EXPECT_EQ(merged.size(), 400001);
+  EXPECT_EQ(merged.max(), 1000000);
+  EXPECT_EQ(merged.percentile(50), histogram.percentile(50));
+  EXPECT_THROW(merged.merge(Histogram(3)), std::runtime_error);
+}
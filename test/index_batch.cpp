@@ -0,0 +1,141 @@
+#include "event_batch/index_batch.hpp"
+
+#include <gtest/gtest.h>
+
+#include "event_batch/batch.hpp"
+#include "event_batch/global_decay.hpp"
+#include "event_batch/types.hpp"
+
+TEST(event_batch, IndexBatch)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.1;
+
+  StdVector<Event> events;
+  StdVector<uint64_t> ts;
+  uint64_t t = 0;
+  for (uint64_t i = 0; i < 20000; ++i)
+  {
+    t += ((i / 5000) % 2 == 0) ? 1 + i % 3 : 40 + i % 17;
+    events.push_back({t, static_cast<uint16_t>(i % 320),
+                      static_cast<uint16_t>(i % 240),
+                      static_cast<uint16_t>(i % 2)});
+    ts.push_back(t);
+  }
+
+  // Reference batches of events, one event at a time
+  Decay event_decay;
+  auto global_decay = make_global_decay<Event>(
+      t_decay_first,
+      [](Event event, float decay, float n_decay, float t_decay,
+         float rate) -> Decay {
+        return {event.t, decay, n_decay, t_decay, rate};
+      },
+      [&](Decay decay) { event_decay = decay; });
+  StdVector<std::size_t> batch_sizes;
+  StdVector<uint64_t> batch_ts;
+  auto batch = make_batch<Event>(weight_thresh, event_decay,
+                                 [&](Span<const Event> batch) {
+                                   batch_sizes.push_back(batch.size());
+                                   batch_ts.push_back(batch.back().t);
+                                 });
+  for (const Event& event : events)
+  {
+    global_decay(event);
+    batch(event);
+  }
+
+  // Ranges over the events, one event at a time
+  Decay range_decay;
+  auto global_decay_range = make_global_decay<Event>(
+      t_decay_first,
+      [](Event event, float decay, float n_decay, float t_decay,
+         float rate) -> Decay {
+        return {event.t, decay, n_decay, t_decay, rate};
+      },
+      [&](Decay decay) { range_decay = decay; });
+  StdVector<IndexRange> ranges;
+  auto index_batch = make_index_batch<Event>(
+      weight_thresh, range_decay,
+      [&](IndexRange range) { ranges.push_back(range); });
+  for (const Event& event : events)
+  {
+    global_decay_range(event);
+    index_batch(event);
+  }
+
+  ASSERT_EQ(ranges.size(), batch_sizes.size());
+  EXPECT_GT(ranges.size(), 1);
+  std::size_t first = 0;
+  for (std::size_t i = 0; i < ranges.size(); ++i)
+  {
+    EXPECT_EQ(ranges[i].first, first);
+    EXPECT_EQ(ranges[i].size(), batch_sizes[i]);
+    EXPECT_EQ(events[ranges[i].last - 1].t, batch_ts[i]);
+    first = ranges[i].last;
+  }
+  EXPECT_EQ(index_batch.pending().first, first);
+  EXPECT_EQ(index_batch.pending().last, events.size());
+  EXPECT_EQ(index_batch.pending().size(), batch.batch().size());
+
+  // Ranges over a timestamp column, in blocks
+  Decay column_decay;
+  auto global_decay_column = make_global_decay<uint64_t>(
+      t_decay_first,
+      [](uint64_t t, float decay, float n_decay, float t_decay,
+         float rate) -> Decay { return {t, decay, n_decay, t_decay, rate}; },
+      [&](Decay decay) { column_decay = decay; }, RawTimestamp());
+  StdVector<IndexRange> column_ranges;
+  auto column_batch = make_index_batch<uint64_t>(
+      weight_thresh, column_decay,
+      [&](IndexRange range) { column_ranges.push_back(range); }, BatchLimits(),
+      RawTimestamp());
+  StdVector<Decay> decays(ts.size());
+  decay_and_batch(global_decay_column, column_batch, ts.data(),
+                  ts.data() + ts.size() / 3, decays.data());
+  decay_and_batch(global_decay_column, column_batch, ts.data() + ts.size() / 3,
+                  ts.data() + ts.size(), decays.data());
+
+  ASSERT_EQ(column_ranges.size(), ranges.size());
+  for (std::size_t i = 0; i < ranges.size(); ++i)
+  {
+    EXPECT_EQ(column_ranges[i].first, ranges[i].first);
+    EXPECT_EQ(column_ranges[i].last, ranges[i].last);
+  }
+
+  column_batch.reset();
+  EXPECT_EQ(column_batch.pending().size(), 0);
+
+  // The limits split the ranges as the batches
+  BatchLimits limits;
+  limits.max_events = 300;
+  limits.max_duration = 5000;
+  Decay limited_decay;
+  auto global_decay_limited = make_global_decay<Event>(
+      t_decay_first,
+      [](Event event, float decay, float n_decay, float t_decay,
+         float rate) -> Decay {
+        return {event.t, decay, n_decay, t_decay, rate};
+      },
+      [&](Decay decay) { limited_decay = decay; });
+  StdVector<std::size_t> limited_sizes;
+  auto limited_batch = make_batch<Event>(
+      weight_thresh, limited_decay,
+      [&](Span<const Event> batch) { limited_sizes.push_back(batch.size()); },
+      0, limits);
+  StdVector<std::size_t> limited_range_sizes;
+  auto limited_index_batch = make_index_batch<Event>(
+      weight_thresh, limited_decay,
+      [&](IndexRange range) { limited_range_sizes.push_back(range.size()); },
+      limits);
+  for (const Event& event : events)
+  {
+    global_decay_limited(event);
+    limited_batch(event);
+    limited_index_batch(event);
+  }
+  EXPECT_GT(limited_sizes.size(), batch_sizes.size());
+  EXPECT_EQ(limited_range_sizes, limited_sizes);
+}
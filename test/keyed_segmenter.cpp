@@ -0,0 +1,106 @@
+#include "event_batch/keyed_segmenter.hpp"
+
+#include <gtest/gtest.h>
+
+#include "event_batch/types.hpp"
+#include "keyed_segmenter_fixture.hpp"
+
+namespace
+{
+// Keys events by the parity of their horizontal coordinate, both keys for
+// the first column and no key for the last one
+struct ColumnParityKeys
+{
+  std::size_t
+  number_keys() const
+  {
+    return 2;
+  }
+
+  template <typename Event, typename Push>
+  void
+  operator()(const Event& event, Push&& push) const
+  {
+    if (event.x == 0)
+    {
+      push(0);
+      push(1);
+    }
+    else if (event.x < 99)
+    {
+      push(event.x % 2);
+    }
+  }
+};
+}  // namespace
+
+TEST(event_batch, KeyedSegmenter)
+{
+  using namespace event_batch;
+  using namespace keyed_segmenter_fixture;
+
+  const StdVector<Event> events = make_events([](uint64_t i, uint64_t t) {
+    return Event{t, static_cast<uint16_t>((i * 3) % 100),
+                 static_cast<uint16_t>(i % 60), 0};
+  });
+
+  KeyedBatches keyed_batches;
+  auto segmenter = make_keyed_segmenter<Event>(
+      ColumnParityKeys(), t_decay_first, weight_thresh,
+      [&](std::size_t key, Span<const Event> batch) {
+        for (const Event& event : batch)
+        {
+          EXPECT_TRUE(event.x == 0 || event.x % 2 == key);
+        }
+        keyed_batches.emplace_back(key, batch.back().t);
+      });
+  EXPECT_EQ(segmenter.number_keys(), 2);
+
+  // Single events and blocks are dispatched in the same way
+  segmenter(events[0]);
+  segmenter(events.data() + 1, events.data() + events.size());
+
+  expect_per_key_batches(segmenter, keyed_batches, events, {0, 1},
+                         [](std::size_t key, const Event& event) {
+                           return event.x == 0 ||
+                                  (event.x < 99 && event.x % 2 == key);
+                         });
+
+  // The reset clears the decays
+  segmenter.reset();
+  EXPECT_EQ(segmenter.decay(0).n_decay, 0);
+  EXPECT_EQ(segmenter.decay(1).rate, 0);
+}
+
+TEST(event_batch, KeyedSegmenterLimits)
+{
+  using namespace event_batch;
+  using keyed_segmenter_fixture::KeyedBatches;
+
+  BatchLimits limits;
+  limits.max_events = 3;
+  limits.max_duration = 25;
+
+  // A zero weight threshold never closes a batch on its own, so that each key
+  // is split by the limits only
+  const StdVector<Event> events{{0, 1, 0, 0},  {1, 2, 0, 0},  {2, 1, 0, 0},
+                                {3, 1, 0, 0},  {4, 2, 0, 0},  {10, 1, 0, 0},
+                                {40, 2, 0, 0}, {50, 1, 0, 0}, {60, 2, 0, 0}};
+  KeyedBatches keyed_batches;
+  auto segmenter = make_keyed_segmenter<Event>(
+      ColumnParityKeys(), 10000, 0.0f,
+      [&](std::size_t key, Span<const Event> batch) {
+        EXPECT_LE(batch.size(), limits.max_events);
+        EXPECT_LE(batch.back().t - batch.front().t, limits.max_duration);
+        keyed_batches.emplace_back(key, batch.back().t);
+      },
+      limits);
+  for (std::size_t key = 0; key < segmenter.number_keys(); ++key)
+  {
+    EXPECT_GE(segmenter.batch(key).capacity(), limits.max_events);
+  }
+  segmenter(events.data(), events.data() + events.size());
+  segmenter.flush();
+  EXPECT_EQ(keyed_batches,
+            KeyedBatches({{1, 3}, {0, 4}, {1, 10}, {0, 60}, {1, 50}}));
+}
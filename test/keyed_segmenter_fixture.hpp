@@ -0,0 +1,110 @@
+#ifndef EVENT_BATCH_TEST_KEYED_SEGMENTER_FIXTURE_HPP
+#define EVENT_BATCH_TEST_KEYED_SEGMENTER_FIXTURE_HPP
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/types.hpp"
+
+namespace keyed_segmenter_fixture
+{
+/**
+ * @brief Initial decay of the segmenters under test.
+ */
+constexpr uint64_t t_decay_first = 10000;
+/**
+ * @brief Weight threshold of the segmenters under test.
+ */
+constexpr float weight_thresh = 0.1f;
+
+/**
+ * @brief Key and timestamp of the last event of each batch of a keyed
+ * segmenter.
+ */
+typedef event_batch::StdVector<std::pair<std::size_t, uint64_t>> KeyedBatches;
+
+/**
+ * @brief Generates a stream of events with a slowly varying rate.
+ *
+ * @param make_event Function called with the event index and its timestamp,
+ * that returns the event.
+ *
+ * @return Events.
+ */
+template <typename MakeEvent>
+inline event_batch::StdVector<event_batch::Event>
+make_events(MakeEvent make_event)
+{
+  event_batch::StdVector<event_batch::Event> events;
+  uint64_t t = 0;
+  for (uint64_t i = 0; i < 200000; ++i)
+  {
+    t += 1 + i % 3;
+    events.push_back(make_event(i, t));
+  }
+  return events;
+}
+
+/**
+ * @brief Checks that each key of a keyed segmenter matches an adaptive
+ * segmenter fed with the events of that key only, then flushes it.
+ *
+ * @param segmenter Keyed segmenter, constructed with
+ * keyed_segmenter_fixture::t_decay_first and
+ * keyed_segmenter_fixture::weight_thresh, that already processed the events.
+ * @param keyed_batches Batches passed to the handle of the segmenter.
+ * @param events Events.
+ * @param keys Keys to check, each with more than one batch.
+ * @param in_key Function called with a key and an event, that returns
+ * whether the event belongs to the key.
+ */
+template <typename Segmenter, typename InKey>
+inline void
+expect_per_key_batches(Segmenter& segmenter, const KeyedBatches& keyed_batches,
+                       const event_batch::StdVector<event_batch::Event>& events,
+                       const event_batch::StdVector<std::size_t>& keys,
+                       InKey in_key)
+{
+  using namespace event_batch;
+
+  for (const std::size_t key : keys)
+  {
+    StdVector<uint64_t> batch_ts;
+    auto reference = make_adaptive_segmenter<Event>(
+        t_decay_first, weight_thresh,
+        [&](Span<const Event> batch) { batch_ts.push_back(batch.back().t); });
+    for (const Event& event : events)
+    {
+      if (in_key(key, event))
+      {
+        reference(event);
+      }
+    }
+
+    StdVector<uint64_t> key_ts;
+    for (const auto& keyed_batch : keyed_batches)
+    {
+      if (keyed_batch.first == key)
+      {
+        key_ts.push_back(keyed_batch.second);
+      }
+    }
+    EXPECT_GT(batch_ts.size(), 1);
+    EXPECT_EQ(key_ts, batch_ts);
+    EXPECT_EQ(segmenter.batch(key).size(), reference.batch().size());
+    EXPECT_EQ(segmenter.decay(key).rate, reference.decay().rate);
+  }
+
+  segmenter.flush();
+  for (std::size_t key = 0; key < segmenter.number_keys(); ++key)
+  {
+    EXPECT_TRUE(segmenter.batch(key).empty());
+  }
+}
+}  // namespace keyed_segmenter_fixture
+
+#endif  // EVENT_BATCH_TEST_KEYED_SEGMENTER_FIXTURE_HPP
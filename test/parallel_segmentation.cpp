@@ -0,0 +1,94 @@
+#include "event_batch/parallel_segmentation.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/types.hpp"
+
+TEST(event_batch, ParallelSegmentation)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.1;
+
+  StdVector<Event> events;
+  uint64_t t = 0;
+  for (uint64_t i = 0; i < 200000; ++i)
+  {
+    // Alternate between fast and slow motions
+    t += ((i / 7000) % 2 == 0) ? 1 + i % 3 : 30 + i % 23;
+    events.push_back({t, static_cast<uint16_t>(i % 320),
+                      static_cast<uint16_t>(i % 240),
+                      static_cast<uint16_t>(i % 2)});
+  }
+  const Event* first = events.data();
+  const Event* last = events.data() + events.size();
+
+  StdVector<std::size_t> segmenter_ends;
+  std::size_t number_events = 0;
+  auto segmenter = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh, [&](Span<const Event> batch) {
+        number_events += batch.size();
+        segmenter_ends.push_back(number_events);
+      });
+  // Fed one event at a time, as the vectorized block overload may move a
+  // boundary that ties with the threshold
+  for (const Event& event : events)
+  {
+    segmenter(event);
+  }
+
+  const StdVector<std::size_t> ends =
+      segment(first, last, t_decay_first, weight_thresh);
+  ASSERT_GT(ends.size(), 1);
+  EXPECT_EQ(ends, segmenter_ends);
+
+  // A warm-up covering the whole stream is exact
+  EXPECT_EQ(segment_parallel(first, last, t_decay_first, weight_thresh, 7,
+                             events.back().t),
+            ends);
+  EXPECT_EQ(segment_parallel(first, last, t_decay_first, weight_thresh, 1, 0),
+            ends);
+  // The number of threads does not change the boundaries
+  EXPECT_EQ(segment_parallel(first, last, t_decay_first, weight_thresh, 7,
+                             events.back().t, BatchLimits(), 1),
+            ends);
+
+  // A bounded warm-up only misplaces a few boundaries around the seams
+  const StdVector<std::size_t> parallel_ends =
+      segment_parallel(first, last, t_decay_first, weight_thresh, 8, 100000);
+  StdVector<std::size_t> common_ends;
+  std::set_intersection(ends.begin(), ends.end(), parallel_ends.begin(),
+                        parallel_ends.end(), std::back_inserter(common_ends));
+  EXPECT_GE(common_ends.size(), ends.size() * 95 / 100);
+  EXPECT_TRUE(std::is_sorted(parallel_ends.begin(), parallel_ends.end()));
+
+  // The limits split the batches in the same way as the segmenter
+  BatchLimits limits;
+  limits.max_events = 2000;
+  limits.max_duration = 30000;
+  StdVector<std::size_t> limited_segmenter_ends;
+  number_events = 0;
+  auto limited_segmenter = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh,
+      [&](Span<const Event> batch) {
+        number_events += batch.size();
+        limited_segmenter_ends.push_back(number_events);
+      },
+      0, limits);
+  for (const Event& event : events)
+  {
+    limited_segmenter(event);
+  }
+  const StdVector<std::size_t> limited_ends =
+      segment(first, last, t_decay_first, weight_thresh, limits);
+  EXPECT_GT(limited_ends.size(), ends.size());
+  EXPECT_EQ(limited_ends, limited_segmenter_ends);
+  EXPECT_EQ(segment_parallel(first, last, t_decay_first, weight_thresh, 7,
+                             events.back().t, limits),
+            limited_ends);
+}
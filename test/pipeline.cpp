@@ -0,0 +1,86 @@
+#include "event_batch/pipeline.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/types.hpp"
+
+TEST(event_batch, Pipeline)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.1;
+
+  StdVector<Event> events;
+  uint64_t t = 0;
+  for (uint64_t i = 0; i < 100000; ++i)
+  {
+    t += 1 + (i / 1000) % 7;
+    events.push_back({t, static_cast<uint16_t>(i % 100),
+                      static_cast<uint16_t>(i % 60), 0});
+  }
+  auto source = [&](auto&& handle_block) {
+    for (std::size_t first = 0; first < events.size(); first += 1000)
+    {
+      handle_block(events.data() + first,
+                   events.data() + std::min(first + 1000, events.size()));
+    }
+  };
+
+  // Small rings so that the buffers are recycled
+  PipelineOptions options;
+  options.number_blocks = 4;
+  options.number_batches = 4;
+
+  // The batches match a segmenter with the same limits
+  BatchLimits limits;
+  limits.max_events = 500;
+  limits.max_duration = 2000;
+  for (const BatchLimits& pipeline_limits : {BatchLimits(), limits})
+  {
+    StdVector<StdVector<Event>> expected_batches;
+    auto segmenter = make_adaptive_segmenter<Event>(
+        t_decay_first, weight_thresh,
+        [&](Span<const Event> batch) {
+          expected_batches.emplace_back(batch.begin(), batch.end());
+        },
+        0, pipeline_limits);
+    segmenter(events.data(), events.data() + events.size());
+    expected_batches.push_back(segmenter.batch());
+
+    options.limits = pipeline_limits;
+    StdVector<StdVector<Event>> batches;
+    run_pipeline<Event>(source, t_decay_first, weight_thresh,
+                        [&](Span<const Event> batch) {
+                          batches.emplace_back(batch.begin(), batch.end());
+                        },
+                        options);
+    ASSERT_EQ(batches.size(), expected_batches.size());
+    for (std::size_t i = 0; i < batches.size(); ++i)
+    {
+      ASSERT_EQ(batches[i].size(), expected_batches[i].size());
+      EXPECT_EQ(batches[i].back().t, expected_batches[i].back().t);
+      if (pipeline_limits.max_events > 0)
+      {
+        EXPECT_LE(batches[i].size(), pipeline_limits.max_events);
+      }
+    }
+  }
+
+  // An exception of the handle stops the pipeline
+  EXPECT_THROW(run_pipeline<Event>(
+                   source, t_decay_first, weight_thresh,
+                   [](Span<const Event>) { throw std::runtime_error("batch"); },
+                   options),
+               std::runtime_error);
+
+  // A core that cannot be used stops the pipeline instead of being ignored
+  options.cpus = {1 << 20};
+  EXPECT_THROW(run_pipeline<Event>(source, t_decay_first, weight_thresh,
+                                   [](Span<const Event>) {}, options),
+               std::runtime_error);
+}
@@ -0,0 +1,45 @@
+#include "event_batch/polarity_segmenter.hpp"
+
+#include <gtest/gtest.h>
+
+#include "event_batch/types.hpp"
+#include "keyed_segmenter_fixture.hpp"
+
+TEST(event_batch, PolaritySegmenter)
+{
+  using namespace event_batch;
+  using namespace keyed_segmenter_fixture;
+
+  const uint16_t number_polarities = 3;
+
+  // Polarity 0 is the busiest, and polarity 3 is out of range
+  const StdVector<Event> events = make_events([](uint64_t i, uint64_t t) {
+    const uint16_t p = static_cast<uint16_t>(
+        (i % 10 < 6) ? 0 : (i % 10 < 8) ? 1 : (i % 10 < 9) ? 2 : 3);
+    return Event{t, static_cast<uint16_t>(i % 100),
+                 static_cast<uint16_t>(i % 60), p};
+  });
+
+  KeyedBatches polarity_batches;
+  auto polarity_segmenter = make_polarity_segmenter<Event>(
+      number_polarities, t_decay_first, weight_thresh,
+      [&](std::size_t polarity, Span<const Event> batch) {
+        for (const Event& event : batch)
+        {
+          EXPECT_EQ(event.p, polarity);
+        }
+        polarity_batches.emplace_back(polarity, batch.back().t);
+      });
+  EXPECT_EQ(polarity_segmenter.number_polarities(), number_polarities);
+
+  polarity_segmenter(events.data(), events.data() + events.size());
+  EXPECT_LT(polarity_segmenter.decay(1).rate,
+            polarity_segmenter.decay(0).rate);
+
+  // Each polarity matches a segmenter fed with the events of that polarity
+  expect_per_key_batches(polarity_segmenter, polarity_batches, events,
+                         {0, 1, 2},
+                         [](std::size_t polarity, const Event& event) {
+                           return event.p == polarity;
+                         });
+}
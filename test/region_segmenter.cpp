@@ -0,0 +1,51 @@
+#include "event_batch/region_segmenter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "event_batch/types.hpp"
+#include "event_batch/utils.hpp"
+#include "keyed_segmenter_fixture.hpp"
+
+TEST(event_batch, RegionSegmenter)
+{
+  using namespace event_batch;
+  using namespace keyed_segmenter_fixture;
+
+  // Two overlapping regions and a disjoint one of a 100x60 sensor
+  const StdVector<Region> regions = parse_regions("0,0,40,40;20,20,60,60;"
+                                                  "80,0,100,10");
+  ASSERT_EQ(regions.size(), 3);
+  EXPECT_EQ(regions[1].left, 20);
+  EXPECT_EQ(regions[1].bottom, 20);
+  EXPECT_EQ(regions[1].right, 60);
+  EXPECT_EQ(regions[1].top, 60);
+  EXPECT_TRUE(regions[0].contains(39, 0));
+  EXPECT_FALSE(regions[0].contains(40, 0));
+  EXPECT_THROW(parse_regions("0,0,40"), std::runtime_error);
+  EXPECT_THROW(parse_regions("0,0,40,40,1"), std::runtime_error);
+  EXPECT_THROW(parse_regions("40,0,0,40"), std::runtime_error);
+
+  const StdVector<Event> events = make_events([](uint64_t i, uint64_t t) {
+    return Event{t, static_cast<uint16_t>((i * 7) % 100),
+                 static_cast<uint16_t>((i * 13) % 60),
+                 static_cast<uint16_t>(i % 2)};
+  });
+
+  KeyedBatches region_batches;
+  auto region_segmenter = make_region_segmenter<Event>(
+      60, regions, t_decay_first, weight_thresh,
+      [&](std::size_t region, Span<const Event> batch) {
+        region_batches.emplace_back(region, batch.back().t);
+      });
+  EXPECT_EQ(region_segmenter.number_regions(), 3);
+
+  region_segmenter(events.data(), events.data() + events.size());
+
+  // Each region matches a segmenter fed with the cropped events
+  expect_per_key_batches(region_segmenter, region_batches, events, {0, 1, 2},
+                         [&](std::size_t region, const Event& event) {
+                           return regions[region].contains(event.x, event.y);
+                         });
+}
@@ -0,0 +1,144 @@
+#include "event_batch/seek_index.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "event_batch/adaptive_segmenter.hpp"
+#include "event_batch/event_stream.hpp"
+#include "event_batch/types.hpp"
+
+TEST(event_batch, SeekIndex)
+{
+  using namespace event_batch;
+
+  const uint64_t t_decay_first = 10000;
+  const float weight_thresh = 0.9;
+
+  const std::string filename = testing::TempDir() + "seek_index.es";
+  {
+    const std::string signature = "Event Stream";
+    // Version, type, width (320) and height (240)
+    StdVector<uint8_t> bytes{2, 0, 0, 1, 64, 1, 240, 0};
+    for (uint64_t i = 0; i < 5000; ++i)
+    {
+      // Alternate between fast and slow motions, with timestamp overflows
+      uint64_t t_diff = ((i / 500) % 2 == 0) ? i % 3 : 100 + i % 97;
+      for (; t_diff >= 127; t_diff -= 127)
+      {
+        bytes.push_back(255);
+      }
+      const uint16_t x = static_cast<uint16_t>(i % 320);
+      const uint16_t y = static_cast<uint16_t>(i % 240);
+      bytes.insert(bytes.end(),
+                   {static_cast<uint8_t>((t_diff << 1) | (i % 2)),
+                    static_cast<uint8_t>(x & 0xff),
+                    static_cast<uint8_t>(x >> 8),
+                    static_cast<uint8_t>(y & 0xff),
+                    static_cast<uint8_t>(y >> 8)});
+    }
+    std::ofstream file(filename, std::ios::binary);
+    file.write(signature.data(), signature.size());
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  }
+
+  const MappedEventStream event_stream(filename);
+  StdVector<Event> events;
+  for_each_block(event_stream, [&](const Event* first, const Event* last) {
+    events.insert(events.end(), first, last);
+  });
+  ASSERT_EQ(events.size(), 5000);
+
+  const SeekIndex index = build_seek_index(event_stream, t_decay_first, 700);
+  ASSERT_EQ(index.points().size(), 8);
+  Decay decay;
+  decay.reset(t_decay_first);
+  for (std::size_t i = 0; i < events.size(); ++i)
+  {
+    const SeekPoint& point = index.find_index(i);
+    EXPECT_EQ(point.index, i - i % 700);
+    if (i == point.index)
+    {
+      EXPECT_EQ(point.t, (i > 0) ? events[i - 1].t : 0);
+      EXPECT_EQ(point.decay.t, decay.t);
+      // The vectorized decay kernel rounds differently
+      EXPECT_NEAR(point.decay.n_decay, decay.n_decay, 1e-5 * decay.n_decay);
+      EXPECT_NEAR(point.decay.rate, decay.rate, 1e-5 * decay.rate);
+    }
+    decay.update(events[i].t);
+  }
+  EXPECT_EQ(index.find_time(0).index, 0);
+  EXPECT_EQ(index.find_time(events[1400].t + 1).index, 1400);
+  EXPECT_EQ(index.find_time(events.back().t + 1).index, 4900);
+
+  // Round trip through the sidecar file
+  const std::string index_filename = testing::TempDir() + "seek_index.esi";
+  write_seek_index(index, index_filename);
+  const SeekIndex read_index = read_seek_index(index_filename);
+  EXPECT_EQ(read_index.t_decay_first(), t_decay_first);
+  ASSERT_EQ(read_index.points().size(), index.points().size());
+  for (std::size_t i = 0; i < index.points().size(); ++i)
+  {
+    const SeekPoint& point = index.points()[i];
+    const SeekPoint& read_point = read_index.points()[i];
+    EXPECT_EQ(read_point.index, point.index);
+    EXPECT_EQ(read_point.offset, point.offset);
+    EXPECT_EQ(read_point.t, point.t);
+    EXPECT_EQ(read_point.decay.t, point.decay.t);
+    EXPECT_EQ(read_point.decay.n_decay, point.decay.n_decay);
+    EXPECT_EQ(read_point.decay.t_decay, point.decay.t_decay);
+    EXPECT_EQ(read_point.decay.rate, point.decay.rate);
+  }
+
+  // Batches from the start of the stream
+  StdVector<uint64_t> batch_firsts;
+  StdVector<std::size_t> batch_sizes;
+  uint64_t next = 0;
+  auto segmenter = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh, [&](Span<const Event> batch) {
+        batch_firsts.push_back(next);
+        batch_sizes.push_back(batch.size());
+        next += batch.size();
+      });
+  for (const Event& event : events)
+  {
+    segmenter(event);
+  }
+  ASSERT_GT(batch_firsts.size(), 10);
+
+  // Replaying a batch from the nearest seek point
+  const std::size_t n = batch_firsts.size() - 3;
+  const SeekPoint& point = read_index.find_index(batch_firsts[n]);
+  EXPECT_GT(point.index, 0);
+  StdVector<std::size_t> replay_sizes;
+  auto replay = make_adaptive_segmenter<Event>(
+      t_decay_first, weight_thresh,
+      [&](Span<const Event> batch) { replay_sizes.push_back(batch.size()); });
+  decay = point.decay;
+  uint64_t i = point.index;
+  for_each_block_from(event_stream, point,
+                      [&](const Event* first, const Event* last) {
+                        for (; first != last; ++first, ++i)
+                        {
+                          EXPECT_EQ(first->t, events[i].t);
+                          EXPECT_EQ(first->x, events[i].x);
+                          if (i < batch_firsts[n])
+                          {
+                            decay.update(first->t);
+                          }
+                          else
+                          {
+                            if (i == batch_firsts[n])
+                            {
+                              replay.reset(decay);
+                            }
+                            replay(*first);
+                          }
+                        }
+                      });
+  EXPECT_EQ(i, events.size());
+  EXPECT_EQ(replay_sizes,
+            StdVector<std::size_t>(batch_sizes.begin() + n, batch_sizes.end()));
+}
@@ -0,0 +1,58 @@
+#include "event_batch/spsc_ring.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "event_batch/types.hpp"
+
+TEST(event_batch, SpscRing)
+{
+  using namespace event_batch;
+
+  SpscRing<int> ring(3);
+  EXPECT_EQ(ring.capacity(), 4);
+
+  int value = 0;
+  EXPECT_FALSE(ring.try_pop(value));
+  for (int i = 0; i < 4; ++i)
+  {
+    value = i;
+    EXPECT_TRUE(ring.try_push(value));
+  }
+  value = 4;
+  EXPECT_FALSE(ring.try_push(value));
+  EXPECT_TRUE(ring.try_pop(value));
+  EXPECT_EQ(value, 0);
+  value = 4;
+  EXPECT_TRUE(ring.try_push(value));
+
+  // Closing keeps the remaining elements
+  ring.close();
+  for (int i = 1; i <= 4; ++i)
+  {
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(ring.pop(value));
+
+  // Elements cross threads in order
+  const int number_values = 100000;
+  SpscRing<int> shared_ring(64);
+  std::thread producer([&]() {
+    for (int i = 0; i < number_values; ++i)
+    {
+      int pushed = i;
+      shared_ring.push(pushed);
+    }
+    shared_ring.close();
+  });
+  int expected = 0;
+  while (shared_ring.pop(value))
+  {
+    EXPECT_EQ(value, expected);
+    ++expected;
+  }
+  producer.join();
+  EXPECT_EQ(expected, number_values);
+}
@@ -0,0 +1,129 @@
+#include "event_batch/synthetic_stream.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "event_batch/types.hpp"
+
+TEST(event_batch, SyntheticStream)
+{
+  using namespace event_batch;
+
+  const double rate = 1e5;
+  const std::size_t number_events = 100000;
+  for (const StreamProfile profile :
+       {StreamProfile::constant, StreamProfile::poisson, StreamProfile::bursty,
+        StreamProfile::step, StreamProfile::sinusoid})
+  {
+    const StdVector<Event> events =
+        make_synthetic_stream(profile, rate, number_events, 64, 32, 7);
+    ASSERT_EQ(events.size(), number_events);
+    for (std::size_t i = 1; i < events.size(); ++i)
+    {
+      ASSERT_GE(events[i].t, events[i - 1].t);
+    }
+    for (const Event& event : events)
+    {
+      ASSERT_LT(event.x, 64);
+      ASSERT_LT(event.y, 32);
+      ASSERT_LE(event.p, 1);
+    }
+    // The mean rate holds for every profile
+    const double duration = 1e-6 * static_cast<double>(events.back().t);
+    EXPECT_NEAR(number_events / duration, rate, 0.05 * rate)
+        << stream_profile_name(profile);
+    EXPECT_EQ(parse_stream_profile(stream_profile_name(profile)), profile);
+
+    const StdVector<Event> replayed =
+        make_synthetic_stream(profile, rate, number_events, 64, 32, 7);
+    EXPECT_EQ(replayed.back().t, events.back().t);
+    EXPECT_EQ(replayed.back().x, events.back().x);
+  }
+  EXPECT_THROW(parse_stream_profile("square"), std::runtime_error);
+}
+
+TEST(event_batch, SyntheticStreamGenerator)
+{
+  using namespace event_batch;
+
+  // The windowed rate follows the ground truth of each profile
+  for (const StreamProfile profile : {StreamProfile::bursty,
+                                      StreamProfile::step,
+                                      StreamProfile::sinusoid})
+  {
+    SyntheticStreamParameters parameters;
+    parameters.profile = profile;
+    parameters.rate = 1e5;
+    parameters.rate_peak = 1e6;
+    parameters.period = 100000;
+    parameters.duty_cycle = 0.2;
+    parameters.seed = 3;
+    SyntheticStreamGenerator generator(parameters);
+    const uint64_t window = 10000;
+    const std::size_t number_windows = 200;
+    StdVector<std::size_t> counts(number_windows, 0);
+    for (;;)
+    {
+      const Event event = generator();
+      if (event.t >= window * number_windows)
+      {
+        break;
+      }
+      ++counts[event.t / window];
+    }
+    // Windows over one period position, averaged over the periods
+    const std::size_t windows_per_period = 10;
+    for (std::size_t w = 0; w < windows_per_period; ++w)
+    {
+      double count = 0;
+      double expected = 0;
+      for (std::size_t i = w; i < number_windows; i += windows_per_period)
+      {
+        count += static_cast<double>(counts[i]);
+        for (uint64_t t = i * window; t < (i + 1) * window; t += 100)
+        {
+          expected += 1e-6 * 100 * generator.rate(static_cast<double>(t));
+        }
+      }
+      EXPECT_NEAR(count, expected, 0.05 * expected + 50)
+          << stream_profile_name(profile) << ' ' << w;
+    }
+  }
+
+  // Hot pixels fire at their own rate at a fixed set of pixels
+  SyntheticStreamParameters parameters;
+  parameters.profile = StreamProfile::poisson;
+  parameters.rate = 1e6;
+  parameters.hot_pixels = 4;
+  parameters.hot_pixel_rate = 5e4;
+  parameters.width = 1024;
+  parameters.height = 1024;
+  SyntheticStreamGenerator generator(parameters);
+  EXPECT_DOUBLE_EQ(generator.rate(0), 1.2e6);
+  EXPECT_DOUBLE_EQ(generator.mean_rate(), 1.2e6);
+  StdVector<Event> events(200000);
+  generator(events.data(), events.data() + events.size());
+  EXPECT_EQ(generator.number_events(), events.size());
+  StdVector<std::size_t> counts(1024 * 1024, 0);
+  for (const Event& event : events)
+  {
+    ++counts[event.x + 1024 * static_cast<std::size_t>(event.y)];
+  }
+  std::size_t hot_events = 0;
+  std::size_t number_hot_pixels = 0;
+  for (const std::size_t count : counts)
+  {
+    if (count > 100)
+    {
+      hot_events += count;
+      ++number_hot_pixels;
+    }
+  }
+  EXPECT_EQ(number_hot_pixels, parameters.hot_pixels);
+  EXPECT_NEAR(static_cast<double>(hot_events) / events.size(), 1.0 / 6, 0.01);
+
+  parameters.rate = 0;
+  parameters.hot_pixels = 0;
+  EXPECT_THROW(SyntheticStreamGenerator{parameters}, std::runtime_error);
+}
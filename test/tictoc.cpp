@@ -0,0 +1,35 @@
+#include "event_batch/tictoc.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+TEST(event_batch, HardwareCounters)
+{
+  using namespace event_batch;
+
+  HardwareCounters disabled(false);
+  EXPECT_FALSE(disabled.available());
+  disabled.tic();
+  const HardwareCounts none = disabled.toc();
+  EXPECT_FALSE(none.has(HardwareEvent::cycles));
+  EXPECT_EQ(none[HardwareEvent::instructions], 0);
+
+  // The counters may be forbidden, e.g. in a container, which is not an error
+  HardwareCounters counters;
+  volatile uint64_t sum = 0;
+  counters.tic();
+  for (uint64_t i = 0; i < 1000000; ++i)
+  {
+    sum = sum + i;
+  }
+  const HardwareCounts counts = counters.toc();
+  if (counts.has(HardwareEvent::instructions))
+  {
+    EXPECT_GT(counts[HardwareEvent::instructions], 1000000);
+  }
+  if (!counters.available())
+  {
+    EXPECT_FALSE(counts.has(HardwareEvent::cycles));
+  }
+}
@@ -0,0 +1,88 @@
+#include "event_batch/tiled_decay.hpp"
+
+#include <gtest/gtest.h>
+
+#include "event_batch/types.hpp"
+#include "keyed_segmenter_fixture.hpp"
+
+TEST(event_batch, TiledDecay)
+{
+  using namespace event_batch;
+  using namespace keyed_segmenter_fixture;
+
+  // A busy tile (0) and a quiet tile (7) of a 100x60 sensor in 32x32 tiles
+  const StdVector<Event> events = make_events([](uint64_t i, uint64_t t) {
+    if (i % 10 == 0)
+    {
+      return Event{t, static_cast<uint16_t>(96 + i % 4),
+                   static_cast<uint16_t>(32 + i % 28), 0};
+    }
+    return Event{t, static_cast<uint16_t>(i % 32),
+                 static_cast<uint16_t>(i % 32), 1};
+  });
+
+  KeyedBatches tile_batches;
+  auto tiled_decay = make_tiled_decay<Event>(
+      100, 60, 32, 32, t_decay_first, weight_thresh,
+      [&](std::size_t tile, Span<const Event> batch) {
+        tile_batches.emplace_back(tile, batch.back().t);
+      });
+  EXPECT_EQ(tiled_decay.number_tiles_x(), 4);
+  EXPECT_EQ(tiled_decay.number_tiles_y(), 2);
+  EXPECT_EQ(tiled_decay.number_tiles(), 8);
+  EXPECT_EQ(tiled_decay.tile(31, 31), 0);
+  EXPECT_EQ(tiled_decay.tile(32, 0), 1);
+  EXPECT_EQ(tiled_decay.tile(99, 59), 7);
+  EXPECT_EQ(tiled_decay.tile(96, 32), 7);
+
+  tiled_decay(events.data(), events.data() + events.size());
+  EXPECT_LT(tiled_decay.decay(7).rate, tiled_decay.decay(0).rate);
+
+  // Each tile matches a segmenter fed with the events of that tile only, and
+  // the flush closes the pending batch of both tiles
+  const std::size_t number_batches = tile_batches.size();
+  expect_per_key_batches(tiled_decay, tile_batches, events, {0, 7},
+                         [&](std::size_t tile, const Event& event) {
+                           return tiled_decay.tile(event.x, event.y) == tile;
+                         });
+  EXPECT_EQ(tile_batches.size(), number_batches + 2);
+}
+
+TEST(event_batch, TiledDecayOutOfSensor)
+{
+  using namespace event_batch;
+  using namespace keyed_segmenter_fixture;
+
+  // Every third event is off a 100x60 sensor and must be ignored
+  const auto make_event = [](uint64_t i, uint64_t t) {
+    return Event{t, static_cast<uint16_t>(i % 100),
+                 static_cast<uint16_t>(i % 60), 0};
+  };
+  const StdVector<Event> events = make_events(make_event);
+  StdVector<Event> noisy_events;
+  for (std::size_t i = 0; i < events.size(); ++i)
+  {
+    noisy_events.push_back(events[i]);
+    if (i % 3 == 0)
+    {
+      const uint16_t x = static_cast<uint16_t>(i % 2 == 0 ? 100 : 0);
+      const uint16_t y = static_cast<uint16_t>(i % 2 == 0 ? 0 : 60 + i % 1000);
+      noisy_events.push_back(Event{events[i].t, x, y, 0});
+    }
+  }
+
+  const auto run = [](const StdVector<Event>& stream) {
+    KeyedBatches tile_batches;
+    auto tiled_decay = make_tiled_decay<Event>(
+        100, 60, 32, 32, t_decay_first, weight_thresh,
+        [&](std::size_t tile, Span<const Event> batch) {
+          tile_batches.emplace_back(tile, batch.back().t);
+        });
+    tiled_decay(stream.data(), stream.data() + stream.size());
+    tiled_decay.flush();
+    return tile_batches;
+  };
+  const KeyedBatches expected = run(events);
+  ASSERT_FALSE(expected.empty());
+  EXPECT_EQ(run(noisy_events), expected);
+}
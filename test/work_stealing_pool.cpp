@@ -0,0 +1,41 @@
+#include "event_batch/work_stealing_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+#include "event_batch/types.hpp"
+
+TEST(event_batch, WorkStealingPool)
+{
+  using namespace event_batch;
+
+  const std::size_t number_tasks = 100;
+  StdVector<std::atomic<int>> counts(number_tasks);
+  StdVector<WorkStealingPool::Task> tasks;
+  for (std::size_t i = 0; i < number_tasks; ++i)
+  {
+    tasks.push_back([&counts, i]() { ++counts[i]; });
+  }
+
+  WorkStealingPool pool(4);
+  EXPECT_EQ(pool.number_threads(), 4);
+  pool.run(std::move(tasks));
+  for (const std::atomic<int>& count : counts)
+  {
+    EXPECT_EQ(count, 1);
+  }
+
+  // The remaining tasks still run when one throws
+  std::atomic<int> count(0);
+  tasks.clear();
+  tasks.push_back([]() { throw std::runtime_error("task"); });
+  for (std::size_t i = 0; i < number_tasks; ++i)
+  {
+    tasks.push_back([&count]() { ++count; });
+  }
+  EXPECT_THROW(pool.run(std::move(tasks)), std::runtime_error);
+  EXPECT_EQ(count, number_tasks);
+}